@@ -0,0 +1,179 @@
+#pragma once
+
+#include "det_math.hpp"
+#include "rng.hpp"
+#include <nlohmann/json.hpp>
+#include <random>
+#include <memory>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <cstdint>
+
+namespace sim_core {
+
+// Decides when the next tick fires. Each call samples one inter-arrival gap
+// in O(1) (expected) time.
+class ArrivalProcess {
+public:
+    virtual ~ArrivalProcess() = default;
+
+    virtual double next_interval_ms() = 0;
+
+    // Generator and regime state, so a handoff resumes the same gaps
+    virtual nlohmann::json save() const = 0;
+    virtual void restore(const nlohmann::json& saved) = 0;
+};
+
+using ArrivalProcessPtr = std::unique_ptr<ArrivalProcess>;
+
+// Independent gaps drawn uniformly from [min_ms, max_ms]
+class UniformArrivals : public ArrivalProcess {
+private:
+    std::mt19937_64 rng_;
+    DetUniform gap_;
+
+public:
+    UniformArrivals(double min_ms, double max_ms, std::mt19937_64 rng)
+        : rng_(std::move(rng)),
+          gap_(min_ms, std::max(min_ms, max_ms))
+    {}
+
+    double next_interval_ms() override {
+        return gap_(rng_);
+    }
+
+    nlohmann::json save() const override {
+        return {{"rng", save_rng(rng_)}};
+    }
+
+    void restore(const nlohmann::json& saved) override {
+        restore_rng(rng_, saved.at("rng").get<std::string>());
+    }
+};
+
+// Two-state Markov-modulated Poisson process. Burst and quiet regimes each
+// have their own tick rate and exponentially distributed sojourn time, so
+// bursts are real windows rather than per-tick coin flips.
+class MmppArrivals : public ArrivalProcess {
+private:
+    double burst_interval_ms_;
+    double quiet_interval_ms_;
+    double burst_duration_ms_;
+    double quiet_duration_ms_;
+    bool bursting_;
+    double remaining_ms_;
+    std::mt19937_64 rng_;
+    DetUniform uniform_;
+
+    double exponential(double mean_ms) {
+        return -det_log(1.0 - uniform_(rng_)) * mean_ms;
+    }
+
+public:
+    MmppArrivals(
+        double burst_interval_ms,
+        double quiet_interval_ms,
+        double burst_duration_ms,
+        double quiet_duration_ms,
+        std::mt19937_64 rng
+    ) : burst_interval_ms_(burst_interval_ms),
+        quiet_interval_ms_(quiet_interval_ms),
+        burst_duration_ms_(burst_duration_ms),
+        quiet_duration_ms_(quiet_duration_ms),
+        bursting_(false),
+        rng_(std::move(rng)),
+        uniform_(0.0, 1.0)
+    {
+        remaining_ms_ = exponential(quiet_duration_ms_);
+    }
+
+    // Exponential gaps are memoryless, so a gap that overruns the current
+    // regime is discarded and redrawn at the new rate from the switch point.
+    double next_interval_ms() override {
+        double elapsed = 0.0;
+        while (true) {
+            double gap = exponential(bursting_ ? burst_interval_ms_ : quiet_interval_ms_);
+            if (gap < remaining_ms_) {
+                remaining_ms_ -= gap;
+                return elapsed + gap;
+            }
+
+            elapsed += remaining_ms_;
+            bursting_ = !bursting_;
+            remaining_ms_ = exponential(bursting_ ? burst_duration_ms_ : quiet_duration_ms_);
+        }
+    }
+
+    nlohmann::json save() const override {
+        return {{"rng", save_rng(rng_)}, {"bursting", bursting_}, {"remaining_ms", remaining_ms_}};
+    }
+
+    void restore(const nlohmann::json& saved) override {
+        restore_rng(rng_, saved.at("rng").get<std::string>());
+        bursting_ = saved.at("bursting").get<bool>();
+        remaining_ms_ = saved.at("remaining_ms").get<double>();
+    }
+
+    bool bursting() const { return bursting_; }
+};
+
+// Self-exciting Hawkes process with exponential kernel:
+//   lambda(t) = mu + sum alpha * exp(-beta * (t - t_i))
+// Sampled exactly with the Dassios-Zhao decomposition (two uniforms per event).
+class HawkesArrivals : public ArrivalProcess {
+private:
+    double mu_;
+    double alpha_;
+    double beta_;
+    double intensity_;
+    std::mt19937_64 rng_;
+    DetUniform uniform_;
+
+public:
+    // Rates are per second; alpha / beta must be < 1 for a stationary process
+    HawkesArrivals(double base_hz, double alpha_hz, double decay_hz, std::mt19937_64 rng)
+        : mu_(base_hz),
+          alpha_(alpha_hz),
+          beta_(decay_hz),
+          intensity_(base_hz),
+          rng_(std::move(rng)),
+          uniform_(0.0, 1.0)
+    {
+        if (mu_ <= 0.0 || beta_ <= 0.0 || alpha_ < 0.0 || alpha_ >= beta_) {
+            throw std::invalid_argument("Hawkes requires base_hz > 0 and 0 <= alpha_hz < decay_hz");
+        }
+    }
+
+    double next_interval_ms() override {
+        double excess = intensity_ - mu_;
+
+        double excited_gap = std::numeric_limits<double>::infinity();
+        if (excess > 0.0) {
+            double d = 1.0 + beta_ * det_log(1.0 - uniform_(rng_)) / excess;
+            if (d > 0.0) {
+                excited_gap = -det_log(d) / beta_;
+            }
+        }
+        double base_gap = -det_log(1.0 - uniform_(rng_)) / mu_;
+
+        double gap = std::min(excited_gap, base_gap);
+        intensity_ = mu_ + excess * det_exp(-beta_ * gap) + alpha_;
+
+        return gap * 1000.0;
+    }
+
+    nlohmann::json save() const override {
+        return {{"rng", save_rng(rng_)}, {"intensity_hz", intensity_}};
+    }
+
+    void restore(const nlohmann::json& saved) override {
+        restore_rng(rng_, saved.at("rng").get<std::string>());
+        intensity_ = saved.at("intensity_hz").get<double>();
+    }
+
+    double intensity_hz() const { return intensity_; }
+};
+
+}
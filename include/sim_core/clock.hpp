@@ -0,0 +1,237 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <ctime>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define SIM_CORE_HAS_TSC 1
+#else
+#define SIM_CORE_HAS_TSC 0
+#endif
+
+namespace sim_core {
+
+// Process-wide clock for hot-path timestamps. On x86 with an invariant TSC
+// it reads the TSC and scales it to CLOCK_MONOTONIC nanoseconds; elsewhere it
+// falls back to clock_gettime. Calibrated for a few ms on first use, then
+// re-anchored by whichever caller notices the interval has passed (50ms,
+// doubling up to 1s), slewing the rate (at most kMaxSlewPpm) so readings
+// stay monotonic while converging on CLOCK_MONOTONIC. An error above
+// kMaxSlewErrorNs (a TSC step from VM migration, suspend or a long stall)
+// would take minutes to slew away, so the clock is re-anchored to
+// CLOCK_MONOTONIC instead, which may step readings back. Wall time is the
+// monotonic reading plus the REALTIME offset sampled at the last calibration.
+class TscClock {
+private:
+    __extension__ typedef unsigned __int128 Wide;
+
+    static constexpr int64_t kInitialCalibrationNs = 5'000'000;
+    static constexpr int64_t kFirstRecalibrateNs = 50'000'000;
+    static constexpr int64_t kMaxRecalibrateNs = 1'000'000'000;
+    static constexpr double kMaxSlewPpm = 1000.0;
+    static constexpr int64_t kMaxSlewErrorNs = 1'000'000;
+
+    // Seqlock-protected conversion parameters: ns = base_ns + (tsc - base_tsc) * mult >> 32
+    std::atomic<uint32_t> seq_{0};
+    std::atomic<uint64_t> base_tsc_{0};
+    std::atomic<int64_t> base_ns_{0};
+    std::atomic<uint64_t> mult_{0};
+    std::atomic<int64_t> wall_offset_ns_{0};
+
+    // Last raw (tsc, CLOCK_MONOTONIC) pair, for measuring the rate
+    uint64_t ref_tsc_ = 0;
+    int64_t ref_mono_ns_ = 0;
+    int64_t interval_ns_ = kFirstRecalibrateNs;
+    std::atomic<uint64_t> next_calibration_tsc_{0};
+    std::atomic<bool> calibrating_{false};
+    bool tsc_ = false;
+
+    static int64_t read_ns(clockid_t id) {
+        timespec ts;
+        ::clock_gettime(id, &ts);
+        return static_cast<int64_t>(ts.tv_sec) * 1'000'000'000 + ts.tv_nsec;
+    }
+
+    static uint64_t read_tsc() {
+#if SIM_CORE_HAS_TSC
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    static bool invariant_tsc() {
+#if SIM_CORE_HAS_TSC
+        unsigned eax, ebx, ecx, edx;
+        if (__get_cpuid_max(0x80000000, nullptr) < 0x80000007) return false;
+        __cpuid(0x80000007, eax, ebx, ecx, edx);
+        return (edx & (1u << 8)) != 0;
+#else
+        return false;
+#endif
+    }
+
+    // Reads TSC and CLOCK_MONOTONIC as close together as possible: the
+    // tightest of a few attempts, since a VM exit or interrupt can land
+    // between the two reads
+    static void sample(uint64_t& tsc, int64_t& mono_ns) {
+        uint64_t best_window = UINT64_MAX;
+        for (int i = 0; i < 8; ++i) {
+            uint64_t before = read_tsc();
+            int64_t mono = read_ns(CLOCK_MONOTONIC);
+            uint64_t after = read_tsc();
+            if (after - before < best_window) {
+                best_window = after - before;
+                tsc = before + (after - before) / 2;
+                mono_ns = mono;
+            }
+        }
+    }
+
+    // wall_offset_ns, if given, receives the offset from the same calibration
+    int64_t convert(uint64_t tsc, int64_t* wall_offset_ns = nullptr) const {
+        while (true) {
+            uint32_t seq = seq_.load(std::memory_order_acquire);
+            uint64_t base_tsc = base_tsc_.load(std::memory_order_relaxed);
+            int64_t base_ns = base_ns_.load(std::memory_order_relaxed);
+            uint64_t mult = mult_.load(std::memory_order_relaxed);
+            int64_t wall_offset = wall_offset_ns_.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if ((seq & 1) == 0 && seq == seq_.load(std::memory_order_relaxed)) {
+                uint64_t delta = tsc > base_tsc ? tsc - base_tsc : 0;
+                if (wall_offset_ns != nullptr) *wall_offset_ns = wall_offset;
+                return base_ns + static_cast<int64_t>((static_cast<Wide>(delta) * mult) >> 32);
+            }
+        }
+    }
+
+    void publish(uint64_t base_tsc, int64_t base_ns, uint64_t mult, int64_t wall_offset_ns) {
+        seq_.fetch_add(1, std::memory_order_acq_rel);
+        base_tsc_.store(base_tsc, std::memory_order_relaxed);
+        base_ns_.store(base_ns, std::memory_order_relaxed);
+        mult_.store(mult, std::memory_order_relaxed);
+        wall_offset_ns_.store(wall_offset_ns, std::memory_order_relaxed);
+        seq_.fetch_add(1, std::memory_order_release);
+    }
+
+    static uint64_t ticks_for(int64_t ns, uint64_t mult) {
+        return static_cast<uint64_t>((static_cast<Wide>(ns) << 32) / mult);
+    }
+
+    void recalibrate(uint64_t tsc_now) {
+        uint64_t tsc = 0;
+        int64_t mono = 0;
+        sample(tsc, mono);
+        int64_t wall_offset = read_ns(CLOCK_REALTIME) - mono;
+
+        // Rate over the last interval, then nudged to absorb the current
+        // error over the next one
+        double ns_per_tick = static_cast<double>(mono - ref_mono_ns_) / static_cast<double>(tsc - ref_tsc_);
+        int64_t current = convert(tsc);
+        uint64_t mult;
+        if (std::abs(mono - current) > kMaxSlewErrorNs) {
+            // The rate measured across a step is meaningless; keep the last
+            // one, jump to CLOCK_MONOTONIC and check again soon
+            mult = mult_.load(std::memory_order_relaxed);
+            current = mono;
+            interval_ns_ = kFirstRecalibrateNs;
+        } else {
+            interval_ns_ = std::min(interval_ns_ * 2, kMaxRecalibrateNs);
+            double error = static_cast<double>(mono - current) / static_cast<double>(interval_ns_);
+            double slew = std::max(-kMaxSlewPpm, std::min(kMaxSlewPpm, error * 1e6)) * 1e-6;
+            mult = static_cast<uint64_t>(ns_per_tick * (1.0 + slew) * 4294967296.0);
+        }
+
+        publish(tsc, current, mult, wall_offset);
+        ref_tsc_ = tsc;
+        ref_mono_ns_ = mono;
+        next_calibration_tsc_.store(tsc_now + ticks_for(interval_ns_, mult), std::memory_order_relaxed);
+    }
+
+    // Reads the TSC, recalibrating first if the interval has passed
+    uint64_t read_calibrated_tsc() {
+        uint64_t tsc = read_tsc();
+        if (tsc >= next_calibration_tsc_.load(std::memory_order_relaxed) &&
+            !calibrating_.exchange(true, std::memory_order_acquire)) {
+            if (tsc >= next_calibration_tsc_.load(std::memory_order_relaxed)) {
+                recalibrate(tsc);
+            }
+            calibrating_.store(false, std::memory_order_release);
+        }
+        return tsc;
+    }
+
+public:
+    TscClock() {
+        tsc_ = invariant_tsc();
+        if (!tsc_) return;
+
+        uint64_t tsc0 = 0;
+        int64_t mono0 = 0;
+        sample(tsc0, mono0);
+        uint64_t tsc1 = 0;
+        int64_t mono1 = 0;
+        do {
+            sample(tsc1, mono1);
+        } while (mono1 - mono0 < kInitialCalibrationNs);
+
+        double ns_per_tick = static_cast<double>(mono1 - mono0) / static_cast<double>(tsc1 - tsc0);
+        auto mult = static_cast<uint64_t>(ns_per_tick * 4294967296.0);
+        publish(tsc1, mono1, mult, read_ns(CLOCK_REALTIME) - mono1);
+        ref_tsc_ = tsc1;
+        ref_mono_ns_ = mono1;
+        next_calibration_tsc_.store(tsc1 + ticks_for(interval_ns_, mult), std::memory_order_relaxed);
+    }
+
+    TscClock(const TscClock&) = delete;
+    TscClock& operator=(const TscClock&) = delete;
+
+    bool uses_tsc() const { return tsc_; }
+
+    // Shifts readings by ns until the next calibration, as a TSC step would.
+    // For tests.
+    void simulate_step(int64_t ns) {
+        publish(base_tsc_.load(std::memory_order_relaxed), base_ns_.load(std::memory_order_relaxed) + ns,
+                mult_.load(std::memory_order_relaxed), wall_offset_ns_.load(std::memory_order_relaxed));
+    }
+
+    // TSC frequency in GHz, 0 without a TSC
+    double tsc_ghz() const {
+        if (!tsc_) return 0.0;
+        return 4294967296.0 / static_cast<double>(mult_.load(std::memory_order_relaxed));
+    }
+
+    // Nanoseconds on the CLOCK_MONOTONIC (std::chrono::steady_clock) timeline
+    int64_t monotonic_ns() {
+        if (!tsc_) return read_ns(CLOCK_MONOTONIC);
+        return convert(read_calibrated_tsc());
+    }
+
+    // Nanoseconds since the Unix epoch
+    int64_t wall_ns() {
+        if (!tsc_) return read_ns(CLOCK_REALTIME);
+        int64_t wall_offset = 0;
+        int64_t mono = convert(read_calibrated_tsc(), &wall_offset);
+        return mono + wall_offset;
+    }
+};
+
+inline TscClock& fast_clock() {
+    static TscClock clock;
+    return clock;
+}
+
+// Drop-in for std::chrono::steady_clock::now() on hot paths
+inline std::chrono::steady_clock::time_point steady_now() {
+    return std::chrono::steady_clock::time_point(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::nanoseconds(fast_clock().monotonic_ns())));
+}
+
+}
@@ -0,0 +1,815 @@
+#pragma once
+
+#include "history.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sim_core {
+
+// Export of a RunHistory log as an Arrow IPC stream or a Parquet file,
+// written batch by batch: rows are copied out of the log a batch at a time,
+// encoded column-wise and written, so memory stays at one batch however long
+// the run. Both formats are encoded here (flatbuffers for the Arrow
+// metadata, Thrift compact for the Parquet footer) rather than through the
+// Arrow C++ libraries; columns are non-null and Parquet pages are PLAIN and
+// uncompressed, which pyarrow, pandas and polars all read directly.
+
+enum class ColumnType : uint8_t {
+    Bool,
+    UInt8,
+    UInt16,
+    UInt32,
+    UInt64,
+    Int64,
+    Float64,
+    TimestampMs,  // ms since the epoch, UTC
+    Utf8
+};
+
+// One column of a batch, little-endian values (LSB-first bits for Bool)
+struct Column {
+    std::string name;
+    ColumnType type;
+    std::vector<uint8_t> values;
+    std::vector<int32_t> offsets;  // Utf8: rows + 1 entries into values
+    size_t rows = 0;
+
+    Column(std::string column_name, ColumnType column_type)
+        : name(std::move(column_name)), type(column_type)
+    {
+        clear();
+    }
+
+    static size_t width(ColumnType type) {
+        switch (type) {
+            case ColumnType::UInt8: return 1;
+            case ColumnType::UInt16: return 2;
+            case ColumnType::UInt32: return 4;
+            case ColumnType::UInt64:
+            case ColumnType::Int64:
+            case ColumnType::Float64:
+            case ColumnType::TimestampMs: return 8;
+            default: return 0;
+        }
+    }
+
+    void clear() {
+        values.clear();
+        offsets.assign(type == ColumnType::Utf8 ? 1 : 0, 0);
+        rows = 0;
+    }
+
+    void push(uint64_t value) {
+        for (size_t i = 0; i < width(type); ++i) {
+            values.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+        rows++;
+    }
+
+    void push_int(int64_t value) { push(static_cast<uint64_t>(value)); }
+
+    void push_double(double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        push(bits);
+    }
+
+    void push_bool(bool value) {
+        if (rows % 8 == 0) values.push_back(0);
+        values.back() |= static_cast<uint8_t>(value) << (rows % 8);
+        rows++;
+    }
+
+    void push_string(std::string_view value) {
+        values.insert(values.end(), value.begin(), value.end());
+        offsets.push_back(static_cast<int32_t>(values.size()));
+        rows++;
+    }
+};
+
+struct RecordBatch {
+    std::vector<Column> columns;
+
+    size_t rows() const { return columns.empty() ? 0 : columns[0].rows; }
+
+    void clear() {
+        for (auto& column : columns) column.clear();
+    }
+};
+
+namespace export_detail {
+
+inline void put_le(std::vector<uint8_t>& out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+inline void patch_le(std::vector<uint8_t>& out, size_t at, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out[at + i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+inline void pad_to(std::vector<uint8_t>& out, size_t align) {
+    while (out.size() % align != 0) out.push_back(0);
+}
+
+inline void write_bytes(std::ostream& out, const std::vector<uint8_t>& bytes) {
+    out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+// Minimal flatbuffer encoder for the Arrow IPC metadata: a tree of tables,
+// strings, vectors of tables and vectors of structs, laid out front to back
+// (each table before its children, so every offset points forward).
+class FbNode {
+public:
+    enum class Kind { Table, Tables, Structs, String };
+
+private:
+    struct Field {
+        uint16_t id;
+        size_t size;
+        uint64_t bits;
+        std::shared_ptr<FbNode> child;
+    };
+
+    Kind kind_;
+    std::vector<Field> fields_;
+    std::vector<std::shared_ptr<FbNode>> items_;
+    std::vector<uint8_t> bytes_;
+    size_t count_ = 0;
+    size_t align_ = 1;
+
+    size_t write_table(std::vector<uint8_t>& out) const {
+        // Inline layout: soffset to the vtable, then fields widest first
+        auto fields = fields_;
+        std::stable_sort(fields.begin(), fields.end(),
+            [](const Field& a, const Field& b) { return a.size > b.size; });
+
+        uint16_t slots = 0;
+        size_t align = 4;
+        std::vector<uint16_t> offset(fields.size());
+        size_t size = 4;
+        for (size_t i = 0; i < fields.size(); ++i) {
+            size = (size + fields[i].size - 1) / fields[i].size * fields[i].size;
+            offset[i] = static_cast<uint16_t>(size);
+            size += fields[i].size;
+            align = std::max(align, fields[i].size);
+            slots = std::max<uint16_t>(slots, fields[i].id + 1);
+        }
+
+        pad_to(out, 2);
+        size_t vtable = out.size();
+        put_le(out, 4 + 2 * slots, 2);
+        put_le(out, size, 2);
+        for (uint16_t id = 0; id < slots; ++id) {
+            uint16_t at = 0;
+            for (size_t i = 0; i < fields.size(); ++i) {
+                if (fields[i].id == id) at = offset[i];
+            }
+            put_le(out, at, 2);
+        }
+
+        pad_to(out, align);
+        size_t table = out.size();
+        out.resize(table + size, 0);
+        patch_le(out, table, table - vtable, 4);
+        for (size_t i = 0; i < fields.size(); ++i) {
+            if (!fields[i].child) patch_le(out, table + offset[i], fields[i].bits, fields[i].size);
+        }
+        for (size_t i = 0; i < fields.size(); ++i) {
+            if (!fields[i].child) continue;
+            size_t slot = table + offset[i];
+            size_t target = fields[i].child->write(out);
+            patch_le(out, slot, target - slot, 4);
+        }
+        return table;
+    }
+
+public:
+    explicit FbNode(Kind kind) : kind_(kind) {}
+
+    static std::shared_ptr<FbNode> table() { return std::make_shared<FbNode>(Kind::Table); }
+
+    static std::shared_ptr<FbNode> string(std::string_view value) {
+        auto node = std::make_shared<FbNode>(Kind::String);
+        node->bytes_.assign(value.begin(), value.end());
+        return node;
+    }
+
+    static std::shared_ptr<FbNode> tables(std::vector<std::shared_ptr<FbNode>> items) {
+        auto node = std::make_shared<FbNode>(Kind::Tables);
+        node->items_ = std::move(items);
+        return node;
+    }
+
+    // count structs of 8-byte-aligned little-endian fields
+    static std::shared_ptr<FbNode> structs(std::vector<uint8_t> bytes, size_t count) {
+        auto node = std::make_shared<FbNode>(Kind::Structs);
+        node->bytes_ = std::move(bytes);
+        node->count_ = count;
+        node->align_ = 8;
+        return node;
+    }
+
+    FbNode& scalar(uint16_t id, uint64_t bits, size_t size) {
+        fields_.push_back(Field{id, size, bits, nullptr});
+        return *this;
+    }
+
+    FbNode& child(uint16_t id, std::shared_ptr<FbNode> node) {
+        fields_.push_back(Field{id, 4, 0, std::move(node)});
+        return *this;
+    }
+
+    // Appends this node to out and returns its position
+    size_t write(std::vector<uint8_t>& out) const {
+        switch (kind_) {
+            case Kind::Table:
+                return write_table(out);
+            case Kind::String: {
+                pad_to(out, 4);
+                size_t at = out.size();
+                put_le(out, bytes_.size(), 4);
+                out.insert(out.end(), bytes_.begin(), bytes_.end());
+                out.push_back(0);
+                return at;
+            }
+            case Kind::Structs: {
+                while ((out.size() + 4) % align_ != 0) out.push_back(0);
+                size_t at = out.size();
+                put_le(out, count_, 4);
+                out.insert(out.end(), bytes_.begin(), bytes_.end());
+                return at;
+            }
+            case Kind::Tables: {
+                pad_to(out, 4);
+                size_t at = out.size();
+                put_le(out, items_.size(), 4);
+                out.resize(out.size() + 4 * items_.size(), 0);
+                for (size_t i = 0; i < items_.size(); ++i) {
+                    size_t slot = at + 4 + 4 * i;
+                    size_t target = items_[i]->write(out);
+                    patch_le(out, slot, target - slot, 4);
+                }
+                return at;
+            }
+        }
+        return 0;
+    }
+
+    // A finished buffer with this node as root table
+    std::vector<uint8_t> finish() const {
+        std::vector<uint8_t> out(4, 0);
+        patch_le(out, 0, write(out), 4);
+        pad_to(out, 8);
+        return out;
+    }
+};
+
+// Thrift compact protocol writer for the Parquet page headers and footer
+class CompactWriter {
+private:
+    std::vector<int16_t> last_ids_{0};
+
+    void varint(uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    static uint64_t zigzag(int64_t value) {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    void field(int16_t id, uint8_t type) {
+        int16_t delta = id - last_ids_.back();
+        if (delta > 0 && delta <= 15) {
+            out.push_back(static_cast<uint8_t>(delta << 4 | type));
+        } else {
+            out.push_back(type);
+            varint(zigzag(id));
+        }
+        last_ids_.back() = id;
+    }
+
+public:
+    static constexpr uint8_t kI32 = 5;
+    static constexpr uint8_t kI64 = 6;
+    static constexpr uint8_t kBinary = 8;
+    static constexpr uint8_t kStruct = 12;
+
+    std::vector<uint8_t> out;
+
+    void i32(int16_t id, int32_t value) { field(id, kI32); varint(zigzag(value)); }
+    void i64(int16_t id, int64_t value) { field(id, kI64); varint(zigzag(value)); }
+
+    void binary(int16_t id, std::string_view value) {
+        field(id, kBinary);
+        binary_item(value);
+    }
+
+    void begin_struct(int16_t id) {
+        field(id, kStruct);
+        begin_item();
+    }
+
+    void end_struct() {
+        out.push_back(0);
+        last_ids_.pop_back();
+    }
+
+    void begin_list(int16_t id, uint8_t element_type, size_t size) {
+        field(id, 9);
+        if (size < 15) {
+            out.push_back(static_cast<uint8_t>(size << 4 | element_type));
+        } else {
+            out.push_back(static_cast<uint8_t>(0xf0 | element_type));
+            varint(size);
+        }
+    }
+
+    // List elements; struct elements are closed with end_struct
+    void begin_item() { last_ids_.push_back(0); }
+    void i32_item(int32_t value) { varint(zigzag(value)); }
+
+    void binary_item(std::string_view value) {
+        varint(value.size());
+        out.insert(out.end(), value.begin(), value.end());
+    }
+};
+
+}
+
+// Arrow IPC streaming format: a Schema message, one RecordBatch message per
+// batch, then the end-of-stream marker
+class ArrowStreamWriter {
+private:
+    std::ostream& out_;
+    std::vector<uint8_t> body_;
+    bool started_ = false;
+
+    static constexpr int16_t kMetadataV5 = 4;
+    static constexpr uint8_t kHeaderSchema = 1;
+    static constexpr uint8_t kHeaderRecordBatch = 3;
+
+    static std::shared_ptr<export_detail::FbNode> field(const Column& column) {
+        using export_detail::FbNode;
+        // Type union: Int = 2, FloatingPoint = 3, Utf8 = 5, Bool = 6, Timestamp = 10
+        auto type = FbNode::table();
+        uint8_t type_id = 2;
+        switch (column.type) {
+            case ColumnType::Bool: type_id = 6; break;
+            case ColumnType::Utf8: type_id = 5; break;
+            case ColumnType::Float64:
+                type_id = 3;
+                type->scalar(0, 2, 2);  // DOUBLE
+                break;
+            case ColumnType::TimestampMs:
+                type_id = 10;
+                type->scalar(0, 1, 2).child(1, FbNode::string("UTC"));  // MILLISECOND
+                break;
+            default:
+                type->scalar(0, Column::width(column.type) * 8, 4)
+                    .scalar(1, column.type == ColumnType::Int64, 1);
+                break;
+        }
+
+        auto node = FbNode::table();
+        node->child(0, FbNode::string(column.name))
+            .scalar(1, 0, 1)
+            .scalar(2, type_id, 1)
+            .child(3, type)
+            .child(5, FbNode::tables({}));
+        return node;
+    }
+
+    void write_message(uint8_t header_type, std::shared_ptr<export_detail::FbNode> header, size_t body_size) {
+        using export_detail::FbNode;
+        auto message = FbNode::table();
+        message->scalar(0, kMetadataV5, 2)
+            .scalar(1, header_type, 1)
+            .child(2, std::move(header))
+            .scalar(3, body_size, 8);
+        auto metadata = message->finish();
+
+        std::vector<uint8_t> prefix;
+        export_detail::put_le(prefix, 0xffffffff, 4);
+        export_detail::put_le(prefix, metadata.size(), 4);
+        export_detail::write_bytes(out_, prefix);
+        export_detail::write_bytes(out_, metadata);
+    }
+
+    void write_schema(const RecordBatch& batch) {
+        std::vector<std::shared_ptr<export_detail::FbNode>> fields;
+        for (const auto& column : batch.columns) {
+            fields.push_back(field(column));
+        }
+        auto schema = export_detail::FbNode::table();
+        schema->scalar(0, 0, 2).child(1, export_detail::FbNode::tables(std::move(fields)));
+        write_message(kHeaderSchema, schema, 0);
+        started_ = true;
+    }
+
+public:
+    explicit ArrowStreamWriter(std::ostream& out) : out_(out) {}
+
+    void write(const RecordBatch& batch) {
+        using export_detail::put_le;
+        if (!started_) write_schema(batch);
+        if (batch.rows() == 0) return;
+
+        std::vector<uint8_t> nodes;
+        std::vector<uint8_t> buffers;
+        body_.clear();
+        auto add_buffer = [&](const uint8_t* data, size_t size) {
+            put_le(buffers, body_.size(), 8);
+            put_le(buffers, size, 8);
+            body_.insert(body_.end(), data, data + size);
+            export_detail::pad_to(body_, 8);
+        };
+
+        for (const auto& column : batch.columns) {
+            put_le(nodes, column.rows, 8);
+            put_le(nodes, 0, 8);
+            add_buffer(nullptr, 0);  // no validity bitmap: nothing is null
+            if (column.type == ColumnType::Utf8) {
+                std::vector<uint8_t> offsets;
+                for (int32_t offset : column.offsets) put_le(offsets, static_cast<uint32_t>(offset), 4);
+                add_buffer(offsets.data(), offsets.size());
+            }
+            add_buffer(column.values.data(), column.values.size());
+        }
+
+        size_t buffer_count = buffers.size() / 16;
+        auto record_batch = export_detail::FbNode::table();
+        record_batch->scalar(0, batch.rows(), 8)
+            .child(1, export_detail::FbNode::structs(std::move(nodes), batch.columns.size()))
+            .child(2, export_detail::FbNode::structs(std::move(buffers), buffer_count));
+        write_message(kHeaderRecordBatch, record_batch, body_.size());
+        export_detail::write_bytes(out_, body_);
+    }
+
+    // Writes the end-of-stream marker; batch gives the schema if nothing was written
+    void finish(const RecordBatch& batch) {
+        if (!started_) write_schema(batch);
+        std::vector<uint8_t> eos;
+        export_detail::put_le(eos, 0xffffffff, 4);
+        export_detail::put_le(eos, 0, 4);
+        export_detail::write_bytes(out_, eos);
+    }
+};
+
+// Parquet file with one row group per batch, PLAIN-encoded required columns
+class ParquetWriter {
+private:
+    struct ChunkMeta {
+        int64_t page_offset;
+        int64_t size;
+    };
+
+    struct RowGroupMeta {
+        int64_t rows;
+        int64_t bytes;
+        std::vector<ChunkMeta> chunks;
+    };
+
+    std::ostream& out_;
+    int64_t position_ = 0;
+    std::vector<RowGroupMeta> row_groups_;
+    std::vector<uint8_t> page_;
+
+    // Parquet physical types and converted (legacy logical) types
+    static constexpr int32_t kBoolean = 0;
+    static constexpr int32_t kInt32 = 1;
+    static constexpr int32_t kInt64 = 2;
+    static constexpr int32_t kDouble = 5;
+    static constexpr int32_t kByteArray = 6;
+
+    static int32_t physical_type(ColumnType type) {
+        switch (type) {
+            case ColumnType::Bool: return kBoolean;
+            case ColumnType::UInt8:
+            case ColumnType::UInt16:
+            case ColumnType::UInt32: return kInt32;
+            case ColumnType::Float64: return kDouble;
+            case ColumnType::Utf8: return kByteArray;
+            default: return kInt64;
+        }
+    }
+
+    static int32_t converted_type(ColumnType type) {
+        switch (type) {
+            case ColumnType::Utf8: return 0;
+            case ColumnType::TimestampMs: return 9;
+            case ColumnType::UInt8: return 11;
+            case ColumnType::UInt16: return 12;
+            case ColumnType::UInt32: return 13;
+            case ColumnType::UInt64: return 14;
+            default: return -1;
+        }
+    }
+
+    void emit(const std::vector<uint8_t>& bytes) {
+        export_detail::write_bytes(out_, bytes);
+        position_ += static_cast<int64_t>(bytes.size());
+    }
+
+    // PLAIN encoding: narrow integers widen to INT32, strings are length-prefixed
+    void encode_plain(const Column& column) {
+        page_.clear();
+        size_t width = Column::width(column.type);
+        if (column.type == ColumnType::Utf8) {
+            for (size_t i = 0; i < column.rows; ++i) {
+                auto length = static_cast<uint32_t>(column.offsets[i + 1] - column.offsets[i]);
+                export_detail::put_le(page_, length, 4);
+                page_.insert(page_.end(), column.values.begin() + column.offsets[i],
+                             column.values.begin() + column.offsets[i + 1]);
+            }
+        } else if (width != 0 && width < 4) {
+            for (size_t i = 0; i < column.rows; ++i) {
+                uint32_t value = 0;
+                for (size_t b = 0; b < width; ++b) {
+                    value |= static_cast<uint32_t>(column.values[i * width + b]) << (8 * b);
+                }
+                export_detail::put_le(page_, value, 4);
+            }
+        } else {
+            page_ = column.values;
+        }
+    }
+
+public:
+    explicit ParquetWriter(std::ostream& out) : out_(out) {
+        emit({'P', 'A', 'R', '1'});
+    }
+
+    void write(const RecordBatch& batch) {
+        if (batch.rows() == 0) return;
+
+        RowGroupMeta group{static_cast<int64_t>(batch.rows()), 0, {}};
+        for (const auto& column : batch.columns) {
+            encode_plain(column);
+
+            export_detail::CompactWriter header;
+            header.i32(1, 0);  // DATA_PAGE
+            header.i32(2, static_cast<int32_t>(page_.size()));
+            header.i32(3, static_cast<int32_t>(page_.size()));
+            header.begin_struct(5);
+            header.i32(1, static_cast<int32_t>(column.rows));
+            header.i32(2, 0);  // PLAIN
+            header.i32(3, 3);  // RLE levels (none are written for required columns)
+            header.i32(4, 3);
+            header.end_struct();
+            header.out.push_back(0);
+
+            ChunkMeta chunk{position_, static_cast<int64_t>(header.out.size() + page_.size())};
+            emit(header.out);
+            emit(page_);
+            group.bytes += chunk.size;
+            group.chunks.push_back(chunk);
+        }
+        row_groups_.push_back(std::move(group));
+    }
+
+    // Writes the footer; batch supplies the column names and types
+    void finish(const RecordBatch& batch) {
+        export_detail::CompactWriter meta;
+        meta.i32(1, 1);
+
+        meta.begin_list(2, export_detail::CompactWriter::kStruct, batch.columns.size() + 1);
+        meta.begin_item();
+        meta.binary(4, "schema");
+        meta.i32(5, static_cast<int32_t>(batch.columns.size()));
+        meta.end_struct();
+        for (const auto& column : batch.columns) {
+            meta.begin_item();
+            meta.i32(1, physical_type(column.type));
+            meta.i32(3, 0);  // REQUIRED
+            meta.binary(4, column.name);
+            if (converted_type(column.type) >= 0) meta.i32(6, converted_type(column.type));
+            meta.end_struct();
+        }
+
+        int64_t rows = 0;
+        for (const auto& group : row_groups_) rows += group.rows;
+        meta.i64(3, rows);
+
+        meta.begin_list(4, export_detail::CompactWriter::kStruct, row_groups_.size());
+        for (const auto& group : row_groups_) {
+            meta.begin_item();
+            meta.begin_list(1, export_detail::CompactWriter::kStruct, group.chunks.size());
+            for (size_t c = 0; c < group.chunks.size(); ++c) {
+                const auto& chunk = group.chunks[c];
+                const auto& column = batch.columns[c];
+                meta.begin_item();
+                meta.i64(2, chunk.page_offset);
+                meta.begin_struct(3);
+                meta.i32(1, physical_type(column.type));
+                meta.begin_list(2, export_detail::CompactWriter::kI32, 1);
+                meta.i32_item(0);  // PLAIN
+                meta.begin_list(3, export_detail::CompactWriter::kBinary, 1);
+                meta.binary_item(column.name);
+                meta.i32(4, 0);  // UNCOMPRESSED
+                meta.i64(5, group.rows);
+                meta.i64(6, chunk.size);
+                meta.i64(7, chunk.size);
+                meta.i64(9, chunk.page_offset);
+                meta.end_struct();
+                meta.end_struct();
+            }
+            meta.i64(2, group.bytes);
+            meta.i64(3, group.rows);
+            meta.end_struct();
+        }
+        meta.binary(6, "eth-sim");
+        meta.out.push_back(0);
+
+        std::vector<uint8_t> tail;
+        export_detail::put_le(tail, meta.out.size(), 4);
+        tail.insert(tail.end(), {'P', 'A', 'R', '1'});
+        emit(meta.out);
+        emit(tail);
+    }
+};
+
+enum class HistoryTable : uint8_t {
+    Ticks,
+    Rounds,
+    Faults
+};
+
+enum class ExportFormat : uint8_t {
+    Arrow,
+    Parquet
+};
+
+inline HistoryTable parse_history_table(std::string_view name) {
+    if (name == "ticks") return HistoryTable::Ticks;
+    if (name == "rounds") return HistoryTable::Rounds;
+    if (name == "faults") return HistoryTable::Faults;
+    throw std::runtime_error("Unknown history table: " + std::string(name));
+}
+
+inline ExportFormat parse_export_format(std::string_view name) {
+    if (name == "arrow") return ExportFormat::Arrow;
+    if (name == "parquet") return ExportFormat::Parquet;
+    throw std::runtime_error("Unknown export format: " + std::string(name));
+}
+
+namespace export_detail {
+
+inline RecordBatch tick_batch() {
+    return RecordBatch{{
+        {"ts", ColumnType::TimestampMs},
+        {"pair", ColumnType::Utf8},
+        {"source", ColumnType::Utf8},
+        {"src_seq", ColumnType::UInt64},
+        {"price", ColumnType::Float64},
+        {"price_raw", ColumnType::Int64},
+        {"decimals", ColumnType::UInt8},
+        {"delay_ms", ColumnType::UInt32},
+        {"stale", ColumnType::Bool}
+    }};
+}
+
+inline void append_row(RecordBatch& batch, const PriceRecord& row, const RunHistory& history) {
+    auto& c = batch.columns;
+    c[0].push(row.ts);
+    c[1].push_string(history.feed_name(row.feed));
+    c[2].push_string(row.flags & PriceRecord::kChainlink ? "chainlink" : "dex");
+    c[3].push(row.src_seq);
+    c[4].push_double(Price{row.price_raw, row.decimals}.to_double());
+    c[5].push_int(row.price_raw);
+    c[6].push(row.decimals);
+    c[7].push(row.delay_ms);
+    c[8].push_bool(row.flags & PriceRecord::kStale);
+}
+
+inline RecordBatch round_batch() {
+    return RecordBatch{{
+        {"ts", ColumnType::TimestampMs},
+        {"pair", ColumnType::Utf8},
+        {"seq", ColumnType::UInt64},
+        {"trigger", ColumnType::Utf8},
+        {"price", ColumnType::Float64},
+        {"price_raw", ColumnType::Int64},
+        {"decimals", ColumnType::UInt8},
+        {"stale", ColumnType::Bool}
+    }};
+}
+
+inline void append_row(RecordBatch& batch, const OracleRound& row, const RunHistory& history) {
+    auto& c = batch.columns;
+    c[0].push(row.ts);
+    c[1].push_string(history.feed_name(row.feed));
+    c[2].push(row.seq);
+    c[3].push_string(trigger_name(row.trigger));
+    c[4].push_double(Price{row.price_raw, row.decimals}.to_double());
+    c[5].push_int(row.price_raw);
+    c[6].push(row.decimals);
+    c[7].push_bool(row.stale);
+}
+
+inline RecordBatch fault_batch() {
+    return RecordBatch{{
+        {"ts", ColumnType::TimestampMs},
+        {"pair", ColumnType::Utf8},
+        {"src_seq", ColumnType::UInt64},
+        {"kind", ColumnType::Utf8}
+    }};
+}
+
+inline void append_row(RecordBatch& batch, const FaultEvent& row, const RunHistory& history) {
+    auto& c = batch.columns;
+    c[0].push(row.ts);
+    c[1].push_string(history.feed_name(row.feed));
+    c[2].push(row.src_seq);
+    c[3].push_string(fault_kind_name(row.kind));
+}
+
+inline RecordBatch batch_for(const PriceRecord*) { return tick_batch(); }
+inline RecordBatch batch_for(const OracleRound*) { return round_batch(); }
+inline RecordBatch batch_for(const FaultEvent*) { return fault_batch(); }
+
+template<typename Row, typename Writer>
+uint64_t write_log(const RunHistory& history, const HistoryLog<Row>& log, Writer& writer, size_t batch_rows) {
+    auto batch = batch_for(static_cast<const Row*>(nullptr));
+    std::vector<Row> rows;
+    uint64_t written = 0;
+    uint64_t end = log.end();
+    for (uint64_t next = log.begin(); next < end;) {
+        next = log.read(next, std::min<uint64_t>(batch_rows, end - next), rows);
+        if (rows.empty()) break;
+        batch.clear();
+        for (const auto& row : rows) {
+            append_row(batch, row, history);
+        }
+        writer.write(batch);
+        written += rows.size();
+    }
+    batch.clear();
+    writer.finish(batch);
+    return written;
+}
+
+template<typename Writer>
+uint64_t write_table(const RunHistory& history, HistoryTable table, Writer& writer, size_t batch_rows) {
+    switch (table) {
+        case HistoryTable::Ticks: return write_log(history, history.ticks, writer, batch_rows);
+        case HistoryTable::Rounds: return write_log(history, history.rounds, writer, batch_rows);
+        case HistoryTable::Faults: return write_log(history, history.faults, writer, batch_rows);
+    }
+    return 0;
+}
+
+}
+
+// Writes the rows of one history table recorded so far (rows appended
+// during the export are left for the next one) and returns the row count
+inline uint64_t export_history(const RunHistory& history, HistoryTable table, ExportFormat format,
+                               std::ostream& out, size_t batch_rows = 65536) {
+    if (format == ExportFormat::Arrow) {
+        ArrowStreamWriter writer(out);
+        return export_detail::write_table(history, table, writer, batch_rows);
+    }
+    ParquetWriter writer(out);
+    return export_detail::write_table(history, table, writer, batch_rows);
+}
+
+inline const char* export_content_type(ExportFormat format) {
+    return format == ExportFormat::Arrow ? "application/vnd.apache.arrow.stream" : "application/vnd.apache.parquet";
+}
+
+struct ExportRequest {
+    HistoryTable table;
+    ExportFormat format;
+};
+
+// Matches "/export/<ticks|rounds|faults>.<arrow|parquet>"
+inline std::optional<ExportRequest> parse_export_target(std::string_view target) {
+    constexpr std::string_view prefix = "/export/";
+    if (target.substr(0, prefix.size()) != prefix) return std::nullopt;
+    target.remove_prefix(prefix.size());
+
+    auto dot = target.find('.');
+    if (dot == std::string_view::npos) return std::nullopt;
+    auto table = target.substr(0, dot);
+    auto format = target.substr(dot + 1);
+    if (table != "ticks" && table != "rounds" && table != "faults") return std::nullopt;
+    if (format != "arrow" && format != "parquet") return std::nullopt;
+    return ExportRequest{parse_history_table(table), parse_export_format(format)};
+}
+
+}
@@ -4,7 +4,17 @@
 #include <vector>
 #include <cstdint>
 #include <optional>
+#include <map>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
 #include <yaml-cpp/yaml.h>
+#include "fixed_point.hpp"
+#include "types.hpp"
+#include "load_shedder.hpp"
+#include "token_bucket.hpp"
+#include "rng.hpp"
+#include "importance_sampling.hpp"
 
 namespace sim_core {
 
@@ -17,16 +27,47 @@ struct Range {
 struct ServerConfig {
     std::vector<std::string> pairs;
     std::string price_model;
+    std::map<std::string, std::string> pair_price_models;
     double price_start;
+    uint8_t price_decimals;
     double gbm_mu;
     double gbm_sigma;
     double jump_lambda;
     double jump_mu;
     double jump_sigma;
+    double ou_peg;
+    double ou_theta;
+    double ou_sigma;
     uint64_t seed;
     std::string ws_bind;
     std::string http_bind;
     std::vector<std::string> cors_allow_origins;
+    std::string ws_send_order;
+    uint32_t ws_max_in_flight;
+    uint32_t ws_conflate_backlog;
+    LoadShedConfig load_shed;
+    uint32_t io_threads;
+    std::string handoff_socket;
+    uint64_t ws_ping_interval_ms;
+    uint64_t ws_idle_timeout_ms;
+    BandwidthLimit ws_client_limit;
+    BandwidthLimit ws_client_max_limit;  // cap on ?rate=&burst=, 0 = none
+    CrashTilt crash_tilt;
+    size_t history_rows;  // rows kept per history log for export, 0 = off
+    uint64_t digest_checkpoint_ticks;  // ticks per stream digest checkpoint, 0 = off
+
+    const std::string& model_for(const std::string& pair) const {
+        auto it = pair_price_models.find(pair);
+        return it != pair_price_models.end() ? it->second : price_model;
+    }
+};
+
+// Gilbert-Elliott burst loss: a two-state Markov chain per stream. The good
+// state drops with the plain p_drop, the bad state with loss_bad.
+struct BurstLossConfig {
+    double p_enter_bad;  // per tick, good -> bad
+    double p_exit_bad;   // per tick, bad -> good (mean burst 1/p_exit_bad ticks)
+    double loss_bad;
 };
 
 struct DexConfig {
@@ -34,23 +75,42 @@ struct DexConfig {
     Range<uint64_t> dex_tick_ms;
     Range<uint64_t> dex_ws_jitter_ms;
     Range<uint64_t> dex_latency_ms;
+    std::optional<LatencyDistribution> dex_latency_model;  // replaces dex_latency_ms when set
     double dex_p_drop;
+    std::optional<BurstLossConfig> dex_burst_loss;
     double dex_p_dup;
     double dex_p_reorder;
     bool dex_burst_mode;
     uint64_t dex_burst_on_ms;
     uint64_t dex_burst_off_ms;
+    std::string dex_arrival_model;
+    double dex_hawkes_base_hz;
+    double dex_hawkes_alpha_hz;
+    double dex_hawkes_decay_hz;
     std::vector<uint64_t> dex_disconnect_windows_ms;
     uint64_t dex_stale_after_ms;
 };
 
+struct OracleFeedConfig {
+    std::string pair;
+    std::string price_model;
+    double price_start;
+    uint8_t price_decimals;
+    double ou_peg;
+    uint32_t oracle_deviation_bps;
+    uint64_t oracle_heartbeat_ms;
+};
+
 struct OracleConfig {
     ServerConfig server;
+    std::vector<OracleFeedConfig> feeds;
     Range<uint64_t> oracle_tick_ms;
     uint32_t oracle_deviation_bps;
     uint64_t oracle_heartbeat_ms;
     Range<uint64_t> oracle_ws_jitter_ms;
+    std::optional<LatencyDistribution> oracle_latency_model;  // path latency on top of jitter
     double oracle_p_drop;
+    std::optional<BurstLossConfig> oracle_burst_loss;
     double oracle_p_dup;
     double oracle_p_reorder;
     uint64_t oracle_stale_after_ms;
@@ -64,21 +124,186 @@ Range<T> load_range(const YAML::Node& node) {
     };
 }
 
+template<typename T>
+T load_or(const YAML::Node& node, const char* key, T fallback) {
+    if (!node[key]) return fallback;
+    return node[key].as<T>();
+}
+
+// Latency histogram file: one "<upper_ms> <weight>" bin per line, ascending,
+// the first bin starting at 0; blank lines and # comments are skipped
+inline EmpiricalLatency load_latency_histogram(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Cannot open latency histogram: " + path);
+    }
+
+    std::vector<double> edges{0.0};
+    std::vector<double> weights;
+    std::string line;
+    while (std::getline(in, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        double upper = 0.0;
+        double weight = 0.0;
+        if (!(fields >> upper)) continue;
+        if (!(fields >> weight)) {
+            throw std::runtime_error("Bad latency histogram line in " + path + ": " + line);
+        }
+        edges.push_back(upper);
+        weights.push_back(weight);
+    }
+    return EmpiricalLatency(std::move(edges), weights);
+}
+
+// <prefix>_latency_model: "uniform" (default, the *_ms ranges) or one of
+// "lognormal" (<prefix>_latency_median_ms, <prefix>_latency_sigma),
+// "pareto" (<prefix>_latency_min_ms, <prefix>_latency_alpha) and
+// "empirical" (<prefix>_latency_histogram file), capped at <prefix>_latency_cap_ms
+inline std::optional<LatencyDistribution> load_latency_model(const YAML::Node& config, const std::string& prefix) {
+    auto key = [&prefix](const char* name) { return prefix + "_latency_" + name; };
+
+    auto model = load_or<std::string>(config, key("model").c_str(), "uniform");
+    if (model == "uniform") return std::nullopt;
+
+    auto positive = [&](const char* name, double fallback) {
+        double value = load_or(config, key(name).c_str(), fallback);
+        if (!(value > 0.0)) {
+            throw std::runtime_error(key(name) + " must be positive");
+        }
+        return value;
+    };
+
+    double cap_ms = positive("cap_ms", 10000.0);
+    if (model == "lognormal") {
+        return LatencyDistribution{LogNormalLatency{positive("median_ms", 20.0), positive("sigma", 0.6)}, cap_ms};
+    }
+    if (model == "pareto") {
+        return LatencyDistribution{ParetoLatency{positive("min_ms", 10.0), positive("alpha", 2.5)}, cap_ms};
+    }
+    if (model == "empirical") {
+        if (!config[key("histogram")]) {
+            throw std::runtime_error(key("histogram") + " is required for the empirical latency model");
+        }
+        return LatencyDistribution{load_latency_histogram(config[key("histogram")].as<std::string>()), cap_ms};
+    }
+    throw std::runtime_error("Unknown " + key("model") + ": " + model);
+}
+
+// <prefix>_drop_model: "bernoulli" (default) or "gilbert_elliott" with
+// <prefix>_ge_p_enter_bad, <prefix>_ge_p_exit_bad and <prefix>_ge_loss_bad
+inline std::optional<BurstLossConfig> load_burst_loss(const YAML::Node& config, const std::string& prefix) {
+    auto model = load_or<std::string>(config, (prefix + "_drop_model").c_str(), "bernoulli");
+    if (model == "bernoulli") return std::nullopt;
+    if (model != "gilbert_elliott") {
+        throw std::runtime_error("Unknown " + prefix + "_drop_model: " + model);
+    }
+
+    BurstLossConfig loss{
+        load_or(config, (prefix + "_ge_p_enter_bad").c_str(), 0.01),
+        load_or(config, (prefix + "_ge_p_exit_bad").c_str(), 0.25),
+        load_or(config, (prefix + "_ge_loss_bad").c_str(), 0.5)
+    };
+    for (double p : {loss.p_enter_bad, loss.p_exit_bad, loss.loss_bad}) {
+        if (p < 0.0 || p > 1.0) {
+            throw std::runtime_error(prefix + "_ge_* probabilities must be in [0, 1]");
+        }
+    }
+    return loss;
+}
+
+// price_model is either a single model name or a map of pair -> model
+// with an optional "default" entry for pairs not listed.
+inline void load_price_models(const YAML::Node& node, ServerConfig& sc) {
+    if (!node.IsMap()) {
+        sc.price_model = node.as<std::string>();
+        return;
+    }
+
+    sc.price_model = load_or<std::string>(node, "default", "gbm");
+    for (const auto& entry : node) {
+        auto key = entry.first.as<std::string>();
+        if (key != "default") {
+            sc.pair_price_models[key] = entry.second.as<std::string>();
+        }
+    }
+}
+
+inline uint8_t load_price_decimals(const YAML::Node& node, uint8_t fallback) {
+    auto decimals = load_or<uint32_t>(node, "price_decimals", fallback);
+    if (decimals > kMaxPriceDecimals) {
+        throw std::runtime_error("price_decimals must be <= 18");
+    }
+    return static_cast<uint8_t>(decimals);
+}
+
+// Raw prices are int64, so the starting price (and OU peg) scaled by
+// 10^decimals must leave kPriceHeadroom for the path to move
+inline void check_price_scale(const std::string& pair, double price_start, double ou_peg, uint8_t decimals) {
+    double highest = std::max(price_start, ou_peg) * kPriceHeadroom;
+    if (!price_fits(highest, decimals)) {
+        throw std::runtime_error("price_start " + std::to_string(std::max(price_start, ou_peg)) + " for " + pair
+            + " overflows int64 at price_decimals " + std::to_string(decimals)
+            + " (needs " + std::to_string(static_cast<int>(kPriceHeadroom)) + "x headroom); lower price_decimals");
+    }
+}
+
 inline ServerConfig load_server_config(const YAML::Node& config) {
     ServerConfig sc;
 
     sc.pairs = config["pairs"].as<std::vector<std::string>>();
-    sc.price_model = config["price_model"].as<std::string>();
+    if (sc.pairs.size() > PriceRecord::kMaxFeeds) {
+        throw std::runtime_error("pairs lists more than " + std::to_string(PriceRecord::kMaxFeeds) + " entries");
+    }
+    load_price_models(config["price_model"], sc);
     sc.price_start = config["price_start"].as<double>();
+    sc.price_decimals = load_price_decimals(config, kDefaultPriceDecimals);
     sc.gbm_mu = config["gbm_mu"].as<double>();
     sc.gbm_sigma = config["gbm_sigma"].as<double>();
     sc.jump_lambda = config["jump_lambda"].as<double>();
     sc.jump_mu = config["jump_mu"].as<double>();
     sc.jump_sigma = config["jump_sigma"].as<double>();
+    sc.ou_peg = load_or(config, "ou_peg", sc.price_start);
+    check_price_scale(sc.pairs.empty() ? "default" : sc.pairs.front(), sc.price_start, sc.ou_peg, sc.price_decimals);
+    sc.ou_theta = load_or(config, "ou_theta", 8766.0);
+    sc.ou_sigma = load_or(config, "ou_sigma", sc.gbm_sigma);
+    sc.crash_tilt.crash_drop = load_or(config, "tilt_crash_drop", 0.0);
+    sc.crash_tilt.horizon_ms = load_or<uint64_t>(config, "tilt_horizon_ms", 3'600'000);
+    sc.crash_tilt.jump_intensity_scale = load_or(config, "tilt_jump_scale", 1.0);
+    sc.crash_tilt.jump_mean_shift = load_or(config, "tilt_jump_mean_shift", 0.0);
+    if (sc.crash_tilt.crash_drop < 0.0 || sc.crash_tilt.crash_drop >= 1.0) {
+        throw std::runtime_error("tilt_crash_drop must be in [0, 1)");
+    }
+    if (sc.crash_tilt.horizon_ms == 0) {
+        throw std::runtime_error("tilt_horizon_ms must be > 0");
+    }
     sc.seed = config["seed"].as<uint64_t>();
     sc.ws_bind = config["ws_bind"].as<std::string>();
     sc.http_bind = config["http_bind"].as<std::string>();
     sc.cors_allow_origins = config["cors_allow_origins"].as<std::vector<std::string>>();
+    sc.ws_send_order = load_or<std::string>(config, "ws_send_order", "rotate");
+    sc.ws_max_in_flight = load_or<uint32_t>(config, "ws_max_in_flight", 64);
+    sc.ws_conflate_backlog = load_or<uint32_t>(config, "ws_conflate_backlog", 1024);
+    sc.load_shed = LoadShedConfig{
+        load_or<double>(config, "load_degrade_lag_ms", 50.0),
+        load_or<double>(config, "load_shed_lag_ms", 250.0),
+        load_or<size_t>(config, "load_degrade_backlog", 8192),
+        load_or<size_t>(config, "load_shed_backlog", 65536),
+        load_or<uint32_t>(config, "load_recover_samples", 200)
+    };
+    sc.io_threads = std::max<uint32_t>(load_or<uint32_t>(config, "io_threads", 1), 1);
+    sc.handoff_socket = load_or<std::string>(config, "handoff_socket", "");
+    sc.ws_ping_interval_ms = load_or<uint64_t>(config, "ws_ping_interval_ms", 0);
+    sc.ws_idle_timeout_ms = load_or<uint64_t>(config, "ws_idle_timeout_ms", 0);
+    if (sc.ws_idle_timeout_ms > 0 && sc.ws_idle_timeout_ms <= sc.ws_ping_interval_ms) {
+        throw std::runtime_error("ws_idle_timeout_ms must exceed ws_ping_interval_ms");
+    }
+    sc.ws_client_limit.bytes_per_sec = load_or<uint64_t>(config, "ws_client_rate_bytes", 0);
+    sc.ws_client_limit.burst_bytes = load_or<uint64_t>(config, "ws_client_burst_bytes", 0);
+    sc.ws_client_max_limit.bytes_per_sec = load_or<uint64_t>(config, "ws_client_max_rate_bytes", 0);
+    sc.ws_client_max_limit.burst_bytes = load_or<uint64_t>(config, "ws_client_max_burst_bytes", 0);
+    sc.history_rows = load_or<size_t>(config, "history_rows", 1'000'000);
+    sc.digest_checkpoint_ticks = load_or<uint64_t>(config, "digest_checkpoint_ticks", 10000);
 
     return sc;
 }
@@ -91,18 +316,72 @@ inline DexConfig load_dex_config(const std::string& config_path = "configs/dex.y
     dc.dex_tick_ms = load_range<uint64_t>(config["dex_tick_ms"]);
     dc.dex_ws_jitter_ms = load_range<uint64_t>(config["dex_ws_jitter_ms"]);
     dc.dex_latency_ms = load_range<uint64_t>(config["dex_latency_ms"]);
+    dc.dex_latency_model = load_latency_model(config, "dex");
     dc.dex_p_drop = config["dex_p_drop"].as<double>();
+    dc.dex_burst_loss = load_burst_loss(config, "dex");
     dc.dex_p_dup = config["dex_p_dup"].as<double>();
     dc.dex_p_reorder = config["dex_p_reorder"].as<double>();
     dc.dex_burst_mode = config["dex_burst_mode"].as<bool>();
     dc.dex_burst_on_ms = config["dex_burst_on_ms"].as<uint64_t>();
     dc.dex_burst_off_ms = config["dex_burst_off_ms"].as<uint64_t>();
+    dc.dex_arrival_model = load_or<std::string>(config, "dex_arrival_model",
+        dc.dex_burst_mode ? "mmpp" : "uniform");
+    dc.dex_hawkes_base_hz = load_or(config, "dex_hawkes_base_hz", 10.0);
+    dc.dex_hawkes_alpha_hz = load_or(config, "dex_hawkes_alpha_hz", 8.0);
+    dc.dex_hawkes_decay_hz = load_or(config, "dex_hawkes_decay_hz", 10.0);
     dc.dex_disconnect_windows_ms = config["dex_disconnect_windows_ms"].as<std::vector<uint64_t>>();
     dc.dex_stale_after_ms = config["dex_stale_after_ms"].as<uint64_t>();
 
     return dc;
 }
 
+// Reads the optional `feeds:` list (plus `oracle_synthetic_feeds` clones for
+// load testing). Without it every entry in `pairs` becomes a feed using the
+// top-level parameters.
+inline std::vector<OracleFeedConfig> load_oracle_feeds(const YAML::Node& config, const OracleConfig& oc) {
+    std::vector<OracleFeedConfig> feeds;
+
+    auto defaults = [&oc](const std::string& pair) {
+        return OracleFeedConfig{
+            pair,
+            oc.server.model_for(pair),
+            oc.server.price_start,
+            oc.server.price_decimals,
+            oc.server.ou_peg,
+            oc.oracle_deviation_bps,
+            oc.oracle_heartbeat_ms
+        };
+    };
+
+    if (config["feeds"]) {
+        for (const auto& node : config["feeds"]) {
+            auto feed = defaults(node["pair"].as<std::string>());
+            feed.price_model = load_or(node, "price_model", feed.price_model);
+            feed.price_start = load_or(node, "price_start", feed.price_start);
+            feed.price_decimals = load_price_decimals(node, feed.price_decimals);
+            feed.ou_peg = load_or(node, "ou_peg", feed.price_start);
+            check_price_scale(feed.pair, feed.price_start, feed.ou_peg, feed.price_decimals);
+            feed.oracle_deviation_bps = load_or(node, "oracle_deviation_bps", feed.oracle_deviation_bps);
+            feed.oracle_heartbeat_ms = load_or(node, "oracle_heartbeat_ms", feed.oracle_heartbeat_ms);
+            feeds.push_back(std::move(feed));
+        }
+    } else {
+        for (const auto& pair : oc.server.pairs) {
+            feeds.push_back(defaults(pair));
+        }
+    }
+
+    auto synthetic = load_or<uint64_t>(config, "oracle_synthetic_feeds", 0);
+    if (feeds.size() > PriceRecord::kMaxFeeds || synthetic > PriceRecord::kMaxFeeds - feeds.size()) {
+        throw std::runtime_error("More than " + std::to_string(PriceRecord::kMaxFeeds) + " oracle feeds configured");
+    }
+    for (uint64_t i = 0; i < synthetic; ++i) {
+        feeds.push_back(defaults("SYN" + std::to_string(i) + "/USD"));
+    }
+
+    return feeds;
+}
+
 inline OracleConfig load_oracle_config(const std::string& config_path = "configs/oracle.yaml") {
     YAML::Node config = YAML::LoadFile(config_path);
 
@@ -112,10 +391,13 @@ inline OracleConfig load_oracle_config(const std::string& config_path = "configs
     oc.oracle_deviation_bps = config["oracle_deviation_bps"].as<uint32_t>();
     oc.oracle_heartbeat_ms = config["oracle_heartbeat_ms"].as<uint64_t>();
     oc.oracle_ws_jitter_ms = load_range<uint64_t>(config["oracle_ws_jitter_ms"]);
+    oc.oracle_latency_model = load_latency_model(config, "oracle");
     oc.oracle_p_drop = config["oracle_p_drop"].as<double>();
+    oc.oracle_burst_loss = load_burst_loss(config, "oracle");
     oc.oracle_p_dup = config["oracle_p_dup"].as<double>();
     oc.oracle_p_reorder = config["oracle_p_reorder"].as<double>();
     oc.oracle_stale_after_ms = config["oracle_stale_after_ms"].as<uint64_t>();
+    oc.feeds = load_oracle_feeds(config, oc);
 
     return oc;
 }
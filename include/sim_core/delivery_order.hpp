@@ -0,0 +1,90 @@
+#pragma once
+
+#include "det_math.hpp"
+#include <vector>
+#include <array>
+#include <random>
+#include <string>
+#include <numeric>
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <cstdint>
+
+namespace sim_core {
+
+enum class SendOrder {
+    Rotate,
+    Shuffle
+};
+
+inline SendOrder parse_send_order(const std::string& name) {
+    if (name == "rotate") return SendOrder::Rotate;
+    if (name == "shuffle") return SendOrder::Shuffle;
+    throw std::runtime_error("Unknown ws_send_order: " + name);
+}
+
+// Chooses the order subscribers are written to for each tick so that no
+// client is systematically first. Rotate shifts the start position by one
+// every round; Shuffle draws a fresh permutation.
+class DeliveryOrder {
+private:
+    SendOrder mode_;
+    uint64_t round_ = 0;
+    std::mt19937_64 rng_;
+    std::vector<uint32_t> order_;
+
+public:
+    DeliveryOrder(SendOrder mode, std::mt19937_64 rng)
+        : mode_(mode),
+          rng_(std::move(rng))
+    {}
+
+    // Returns a permutation of [0, n) for the next round
+    const std::vector<uint32_t>& next_round(size_t n) {
+        order_.resize(n);
+        if (n == 0) return order_;
+
+        if (mode_ == SendOrder::Rotate) {
+            auto start = static_cast<uint32_t>(round_ % n);
+            for (uint32_t i = 0; i < n; ++i) {
+                uint32_t pos = start + i;
+                order_[i] = pos < n ? pos : pos - static_cast<uint32_t>(n);
+            }
+        } else {
+            std::iota(order_.begin(), order_.end(), 0u);
+            det_shuffle(order_.begin(), order_.end(), rng_);
+        }
+
+        round_++;
+        return order_;
+    }
+};
+
+// Per-client histogram of the position a client's write of a frame started
+// at among that frame's subscribers (0 = first). Power-of-two buckets: 0, 1, 2-3, 4-7, ... 64+.
+struct RankHistogram {
+    static constexpr size_t kBuckets = 8;
+
+    std::array<uint64_t, kBuckets> buckets{};
+    uint64_t sum = 0;
+    uint64_t count = 0;
+
+    static size_t bucket_for(uint32_t rank) {
+        return std::min<size_t>(std::bit_width(rank), kBuckets - 1);
+    }
+
+    // Inclusive upper bound of bucket i, as used for the Prometheus "le" label
+    static std::string upper_bound(size_t i) {
+        if (i + 1 == kBuckets) return "+Inf";
+        return std::to_string((1u << i) - 1);
+    }
+
+    void record(uint32_t rank) {
+        buckets[bucket_for(rank)]++;
+        sum += rank;
+        count++;
+    }
+};
+
+}
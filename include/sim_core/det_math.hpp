@@ -0,0 +1,254 @@
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+namespace sim_core {
+
+// Deterministic math for simulated paths. Everything here is built from
+// IEEE-754 basic operations (+ - * / sqrt, floor) and bit manipulation, so
+// with contraction off (-ffp-contract=off, set in CMakeLists.txt) the same
+// inputs give the same bits on any x86 microarchitecture, ARM, and standard
+// library. libm's exp/log and the <random> distributions give no such
+// guarantee. The functions are branch-free so loops over them vectorize.
+//
+// Accuracy: det_exp and det_log are within 1 ulp; inverse_normal_cdf
+// (Wichura's AS241) is accurate to about 1e-16 relative.
+
+namespace det_detail {
+
+constexpr double kLn2Hi = 6.93147180369123816490e-01;
+constexpr double kLn2Lo = 1.90821492927058770002e-10;
+constexpr double kLog2e = 1.44269504088896338700e+00;
+
+inline double pow2(int64_t k) {
+    return std::bit_cast<double>(static_cast<uint64_t>(k + 1023) << 52);
+}
+
+}
+
+// e^x. x is reduced to r = x - k*ln2 (Cody-Waite), e^r comes from its
+// Taylor series to r^13, and 2^k is applied in two halves so subnormal and
+// overflowing results round the same way everywhere.
+inline double det_exp(double x) {
+    using namespace det_detail;
+    double clamped = x < -1100.0 ? -1100.0 : (x > 1100.0 ? 1100.0 : x);
+    double kf = std::floor(clamped * kLog2e + 0.5);
+    double r = (clamped - kf * kLn2Hi) - kf * kLn2Lo;
+
+    double p = 1.0 / 6227020800.0;
+    p = p * r + 1.0 / 479001600.0;
+    p = p * r + 1.0 / 39916800.0;
+    p = p * r + 1.0 / 3628800.0;
+    p = p * r + 1.0 / 362880.0;
+    p = p * r + 1.0 / 40320.0;
+    p = p * r + 1.0 / 5040.0;
+    p = p * r + 1.0 / 720.0;
+    p = p * r + 1.0 / 120.0;
+    p = p * r + 1.0 / 24.0;
+    p = p * r + 1.0 / 6.0;
+    p = p * r + 0.5;
+    p = p * r + 1.0;
+    p = p * r + 1.0;
+
+    auto k = static_cast<int64_t>(kf);
+    int64_t half = k / 2;
+    double result = p * pow2(half) * pow2(k - half);
+    return x != x ? x : result;
+}
+
+// Natural log, fdlibm's reduction: x = 2^k * (1 + f) with 1 + f in
+// [sqrt(2)/2, sqrt(2)), then a minimax series in s = f / (2 + f).
+inline double det_log(double x) {
+    using namespace det_detail;
+    constexpr double kLg1 = 6.666666666666735130e-01;
+    constexpr double kLg2 = 3.999999999940941908e-01;
+    constexpr double kLg3 = 2.857142874366239149e-01;
+    constexpr double kLg4 = 2.222219843214978396e-01;
+    constexpr double kLg5 = 1.818357216161805012e-01;
+    constexpr double kLg6 = 1.531383769920937332e-01;
+    constexpr double kLg7 = 1.479819860511658591e-01;
+
+    bool subnormal = x < std::numeric_limits<double>::min();
+    double scaled = subnormal ? x * 18014398509481984.0 : x;  // 2^54
+    auto bits = std::bit_cast<uint64_t>(scaled);
+    int64_t k = static_cast<int64_t>(bits >> 52) - 1023 - (subnormal ? 54 : 0);
+    double m = std::bit_cast<double>((bits & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL);
+    bool high = m > 1.4142135623730951;
+    m = high ? m * 0.5 : m;
+    k = high ? k + 1 : k;
+
+    double f = m - 1.0;
+    double s = f / (2.0 + f);
+    double z = s * s;
+    double r = kLg7;
+    r = r * z + kLg6;
+    r = r * z + kLg5;
+    r = r * z + kLg4;
+    r = r * z + kLg3;
+    r = r * z + kLg2;
+    r = r * z + kLg1;
+    r = r * z;
+    double hfsq = 0.5 * f * f;
+    auto kf = static_cast<double>(k);
+    double result = kf * kLn2Hi - ((hfsq - (s * (hfsq + r) + kf * kLn2Lo)) - f);
+
+    result = x == std::numeric_limits<double>::infinity() ? x : result;
+    result = x == 0.0 ? -std::numeric_limits<double>::infinity() : result;
+    result = x < 0.0 ? std::numeric_limits<double>::quiet_NaN() : result;
+    return x != x ? x : result;
+}
+
+// log(1 + x), accurate for small x (the rounding of 1 + x is corrected for)
+inline double det_log1p(double x) {
+    double u = 1.0 + x;
+    double d = u - 1.0;
+    double result = det_log(u) * (x / (d == 0.0 ? 1.0 : d));
+    return d == 0.0 ? x : result;
+}
+
+// Standard normal quantile, Wichura's AS241 (PPND16)
+inline double inverse_normal_cdf(double p) {
+    double q = p - 0.5;
+
+    // Central region, |q| <= 0.425
+    double r = 0.180625 - q * q;
+    double num = 2.5090809287301226727e+3;
+    num = num * r + 3.3430575583588128105e+4;
+    num = num * r + 6.7265770927008700853e+4;
+    num = num * r + 4.5921953931549871457e+4;
+    num = num * r + 1.3731693765509461125e+4;
+    num = num * r + 1.9715909503065514427e+3;
+    num = num * r + 1.3314166789178437745e+2;
+    num = num * r + 3.3871328727963666080e+0;
+    double den = 5.2264952788528545610e+3;
+    den = den * r + 2.8729085735721942674e+4;
+    den = den * r + 3.9307895800092710610e+4;
+    den = den * r + 2.1213794301586595867e+4;
+    den = den * r + 5.3941960214247511077e+3;
+    den = den * r + 6.8718700749205790830e+2;
+    den = den * r + 4.2313330701600911252e+1;
+    den = den * r + 1.0;
+    double central = q * num / den;
+
+    // Tails, on the distance from the nearer end
+    double tail = q < 0.0 ? p : 1.0 - p;
+    double t = std::sqrt(-det_log(tail > 0.0 ? tail : std::numeric_limits<double>::min()));
+    bool near = t <= 5.0;
+
+    double u = near ? t - 1.6 : t - 5.0;
+    double tn = near ? 7.74545014278341407640e-4 : 2.01033439929228813265e-7;
+    tn = tn * u + (near ? 2.27238449892691845833e-2 : 2.71155556874348757815e-5);
+    tn = tn * u + (near ? 2.41780725177450611770e-1 : 1.24266094738807843860e-3);
+    tn = tn * u + (near ? 1.27045825245236838258e+0 : 2.65321895265761230930e-2);
+    tn = tn * u + (near ? 3.64784832476320460504e+0 : 2.96560571828504891230e-1);
+    tn = tn * u + (near ? 5.76949722146069140550e+0 : 1.78482653991729133580e+0);
+    tn = tn * u + (near ? 4.63033784615654529590e+0 : 5.46378491116411436990e+0);
+    tn = tn * u + (near ? 1.42343711074968357734e+0 : 6.65790464350110377720e+0);
+    double td = near ? 1.05075007164441684324e-9 : 2.04426310338993978564e-15;
+    td = td * u + (near ? 5.47593808499534494600e-4 : 1.42151175831644588870e-7);
+    td = td * u + (near ? 1.51986665636164571966e-2 : 1.84631831751005468180e-5);
+    td = td * u + (near ? 1.48103976427480074590e-1 : 7.86869131145613259100e-4);
+    td = td * u + (near ? 6.89767334985100004550e-1 : 1.48753612908506148525e-2);
+    td = td * u + (near ? 1.67638483018380384940e+0 : 1.36929880922735805310e-1);
+    td = td * u + (near ? 2.05319162663775882187e+0 : 5.99832206555887937690e-1);
+    td = td * u + 1.0;
+    double tail_value = tn / td;
+    tail_value = q < 0.0 ? -tail_value : tail_value;
+
+    double result = std::abs(q) <= 0.425 ? central : tail_value;
+    result = p <= 0.0 ? -std::numeric_limits<double>::infinity() : result;
+    return p >= 1.0 ? std::numeric_limits<double>::infinity() : result;
+}
+
+// Uniform in [0, 1) from the top 53 bits of a 64-bit generator
+template<typename Rng>
+double uniform01(Rng& rng) {
+    static_assert(Rng::min() == 0 && Rng::max() == UINT64_MAX, "needs a 64-bit generator");
+    return static_cast<double>(rng() >> 11) * 0x1p-53;
+}
+
+// Uniform in (0, 1): never 0 or 1, safe for log and quantile functions
+template<typename Rng>
+double uniform_open01(Rng& rng) {
+    static_assert(Rng::min() == 0 && Rng::max() == UINT64_MAX, "needs a 64-bit generator");
+    return (static_cast<double>(rng() >> 11) + 0.5) * 0x1p-53;
+}
+
+// Unbiased integer in [min, max] (Lemire's multiply-and-reject)
+template<typename Rng>
+uint64_t uniform_int(Rng& rng, uint64_t min, uint64_t max) {
+    static_assert(Rng::min() == 0 && Rng::max() == UINT64_MAX, "needs a 64-bit generator");
+    __extension__ typedef unsigned __int128 Wide;
+
+    uint64_t range = max - min + 1;
+    if (range == 0) return rng();
+
+    Wide m = static_cast<Wide>(rng()) * range;
+    auto low = static_cast<uint64_t>(m);
+    if (low < range) {
+        uint64_t threshold = (0 - range) % range;
+        while (low < threshold) {
+            m = static_cast<Wide>(rng()) * range;
+            low = static_cast<uint64_t>(m);
+        }
+    }
+    return min + static_cast<uint64_t>(m >> 64);
+}
+
+// Drop-in replacements for std::uniform_real_distribution<double> and
+// std::normal_distribution<double>, with the same output on every platform
+
+class DetUniform {
+private:
+    double a_;
+    double b_;
+
+public:
+    explicit DetUniform(double a = 0.0, double b = 1.0) : a_(a), b_(b) {}
+
+    template<typename Rng>
+    double operator()(Rng& rng) const {
+        return a_ + (b_ - a_) * uniform01(rng);
+    }
+};
+
+class DetNormal {
+private:
+    double mean_;
+    double stddev_;
+
+public:
+    explicit DetNormal(double mean = 0.0, double stddev = 1.0) : mean_(mean), stddev_(stddev) {}
+
+    template<typename Rng>
+    double operator()(Rng& rng) const {
+        return mean_ + stddev_ * inverse_normal_cdf(uniform_open01(rng));
+    }
+};
+
+// Fisher-Yates with uniform_int, in place of std::shuffle
+template<typename It, typename Rng>
+void det_shuffle(It first, It last, Rng& rng) {
+    auto n = static_cast<uint64_t>(last - first);
+    for (uint64_t i = n; i > 1; --i) {
+        uint64_t j = uniform_int(rng, 0, i - 1);
+        using std::swap;
+        swap(first[i - 1], first[j]);
+    }
+}
+
+// 64-bit FNV-1a, stable across platforms (unlike std::hash)
+inline uint64_t fnv1a64(const char* data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+}
@@ -0,0 +1,395 @@
+#pragma once
+
+#include "types.hpp"
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace sim_core {
+
+// XXH64 (xxHash, 64-bit), written out so digests can be checked against any
+// xxHash implementation. Inputs are read little-endian regardless of host.
+class Xxh64 {
+public:
+    using Lanes = std::array<uint64_t, 4>;
+    static constexpr size_t kStripe = 32;
+
+private:
+    static constexpr uint64_t P1 = 0x9E3779B185EBCA87ULL;
+    static constexpr uint64_t P2 = 0xC2B2AE3D27D4EB4FULL;
+    static constexpr uint64_t P3 = 0x165667B19E3779F9ULL;
+    static constexpr uint64_t P4 = 0x85EBCA77C2B2AE63ULL;
+    static constexpr uint64_t P5 = 0x27D4EB2F165667C5ULL;
+
+    Lanes lanes_;
+    uint64_t seed_;
+    uint64_t total_ = 0;
+    std::array<uint8_t, kStripe> tail_{};
+    size_t tail_len_ = 0;
+
+    static uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+    static uint64_t read64(const uint8_t* p) {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof v);
+        if constexpr (std::endian::native == std::endian::big) v = byteswap(v);
+        return v;
+    }
+
+    static uint64_t byteswap(uint64_t v) {
+        uint64_t out = 0;
+        for (int i = 0; i < 8; ++i, v >>= 8) out = (out << 8) | (v & 0xff);
+        return out;
+    }
+
+    static uint64_t read32(const uint8_t* p) {
+        return static_cast<uint64_t>(p[0]) | static_cast<uint64_t>(p[1]) << 8
+             | static_cast<uint64_t>(p[2]) << 16 | static_cast<uint64_t>(p[3]) << 24;
+    }
+
+    static uint64_t round(uint64_t acc, uint64_t input) {
+        acc += input * P2;
+        return rotl(acc, 31) * P1;
+    }
+
+    static uint64_t merge(uint64_t h, uint64_t lane) {
+        h ^= round(0, lane);
+        return h * P1 + P4;
+    }
+
+public:
+    explicit Xxh64(uint64_t seed = 0) : lanes_(init(seed)), seed_(seed) {}
+
+    static Lanes init(uint64_t seed) {
+        return Lanes{seed + P1 + P2, seed + P2, seed, seed - P1};
+    }
+
+    // Folds one 32-byte stripe into the lanes
+    static void stripe(Lanes& lanes, const uint8_t* p) {
+        stripe(lanes, Lanes{read64(p), read64(p + 8), read64(p + 16), read64(p + 24)});
+    }
+
+    // Same, given the stripe as its four little-endian words
+    static void stripe(Lanes& lanes, const Lanes& words) {
+        for (size_t i = 0; i < 4; ++i) lanes[i] = round(lanes[i], words[i]);
+    }
+
+    // Digest of total bytes whose whole stripes went into lanes, followed by
+    // the remaining tail_len (< 32) bytes
+    static uint64_t finish(const Lanes& lanes, uint64_t seed, uint64_t total,
+                           const uint8_t* tail, size_t tail_len) {
+        uint64_t h;
+        if (total >= kStripe) {
+            h = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18);
+            for (uint64_t lane : lanes) h = merge(h, lane);
+        } else {
+            h = seed + P5;
+        }
+        h += total;
+
+        for (; tail_len >= 8; tail += 8, tail_len -= 8) {
+            h ^= round(0, read64(tail));
+            h = rotl(h, 27) * P1 + P4;
+        }
+        if (tail_len >= 4) {
+            h ^= read32(tail) * P1;
+            h = rotl(h, 23) * P2 + P3;
+            tail += 4;
+            tail_len -= 4;
+        }
+        for (; tail_len > 0; ++tail, --tail_len) {
+            h ^= *tail * P5;
+            h = rotl(h, 11) * P1;
+        }
+
+        h ^= h >> 33;
+        h *= P2;
+        h ^= h >> 29;
+        h *= P3;
+        h ^= h >> 32;
+        return h;
+    }
+
+    static uint64_t hash(const void* data, size_t len, uint64_t seed = 0) {
+        Xxh64 h(seed);
+        h.update(data, len);
+        return h.digest();
+    }
+
+    void update(const void* data, size_t len) {
+        auto p = static_cast<const uint8_t*>(data);
+        total_ += len;
+
+        if (tail_len_ > 0) {
+            size_t take = std::min(len, kStripe - tail_len_);
+            std::memcpy(tail_.data() + tail_len_, p, take);
+            tail_len_ += take;
+            p += take;
+            len -= take;
+            if (tail_len_ < kStripe) return;
+            stripe(lanes_, tail_.data());
+            tail_len_ = 0;
+        }
+        for (; len >= kStripe; p += kStripe, len -= kStripe) {
+            stripe(lanes_, p);
+        }
+        std::memcpy(tail_.data(), p, len);
+        tail_len_ = len;
+    }
+
+    uint64_t digest() const {
+        return finish(lanes_, seed_, total_, tail_.data(), tail_len_);
+    }
+};
+
+inline std::string digest_hex(uint64_t digest) {
+    static constexpr char kDigits[] = "0123456789abcdef";
+    std::string out(16, '0');
+    for (int i = 15; i >= 0; --i, digest >>= 4) {
+        out[static_cast<size_t>(i)] = kDigits[digest & 0xf];
+    }
+    return out;
+}
+
+// The bytes of a tick that a digest covers: its encode_record layout with
+// ts zeroed, since timestamps come from the wall clock and differ between
+// otherwise identical runs. Held as the layout's four little-endian words,
+// which is what XXH64 reads, to skip the byte-wise encode.
+using DigestRecord = Xxh64::Lanes;
+
+inline DigestRecord digest_record(const PriceMsg& msg, uint16_t feed) {
+    auto record = to_record(msg, feed);
+    return DigestRecord{
+        0,
+        record.src_seq,
+        static_cast<uint64_t>(record.price_raw),
+        record.delay_ms | static_cast<uint64_t>(record.feed) << 32
+            | static_cast<uint64_t>(record.decimals) << 48 | static_cast<uint64_t>(record.flags) << 56
+    };
+}
+
+// XXH64 (seed 0) of a sequence of digest records, one stripe per record
+struct RecordDigest {
+    Xxh64::Lanes lanes = Xxh64::init(0);
+    uint64_t records = 0;
+
+    void add(const DigestRecord& record) {
+        Xxh64::stripe(lanes, record);
+        records++;
+    }
+
+    uint64_t value() const {
+        return Xxh64::finish(lanes, 0, records * Xxh64::kStripe, nullptr, 0);
+    }
+};
+
+struct DigestCheckpoint {
+    uint64_t ticks;   // ticks folded in, this one included
+    uint64_t seq;     // src_seq of the tick
+    uint64_t digest;
+};
+
+struct FeedDigest {
+    uint64_t ticks = 0;
+    uint64_t last_seq = 0;
+    uint64_t digest = 0;
+};
+
+// Rolling digest of every tick emitted on each feed, in emission order
+// (after fault injection): XXH64 over the concatenated digest records, so a
+// run can be compared with another by one number per feed, or re-derived
+// from the binary tick history. Every checkpoint_ticks ticks the digest is
+// kept with the tick's seq (the newest max_checkpoints per feed), which
+// bisects where two runs diverge.
+//
+// record() must come from a single thread (the ticker). It costs one hash
+// stripe and a seqlock publish, no lock; readers retry if they overlap it.
+class StreamDigest {
+private:
+    struct Feed {
+        std::atomic<uint64_t> version{0};  // odd while record() is writing
+        std::array<std::atomic<uint64_t>, 4> lanes{};
+        std::atomic<uint64_t> ticks{0};
+        std::atomic<uint64_t> last_seq{0};
+        uint64_t next_checkpoint = UINT64_MAX;     // tick count, written by record() only
+        std::deque<DigestCheckpoint> checkpoints;  // under checkpoint_mutex_
+    };
+
+    std::vector<std::string> pairs_;
+    std::vector<Feed> feeds_;
+    uint64_t checkpoint_ticks_;
+    size_t max_checkpoints_;
+    mutable std::mutex checkpoint_mutex_;
+
+    void reset_checkpoint(Feed& feed, uint64_t ticks) const {
+        feed.next_checkpoint = checkpoint_ticks_ > 0 ? (ticks / checkpoint_ticks_ + 1) * checkpoint_ticks_ : UINT64_MAX;
+    }
+
+    void publish(Feed& feed, const RecordDigest& state, uint64_t last_seq) {
+        uint64_t version = feed.version.load(std::memory_order_relaxed);
+        feed.version.store(version + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < 4; ++i) {
+            feed.lanes[i].store(state.lanes[i], std::memory_order_relaxed);
+        }
+        feed.ticks.store(state.records, std::memory_order_relaxed);
+        feed.last_seq.store(last_seq, std::memory_order_relaxed);
+        feed.version.store(version + 2, std::memory_order_release);
+    }
+
+    // Consistent copy of a feed's state, spinning past a concurrent record()
+    static RecordDigest load(const Feed& feed, uint64_t& last_seq) {
+        RecordDigest state;
+        while (true) {
+            uint64_t before = feed.version.load(std::memory_order_acquire);
+            for (size_t i = 0; i < 4; ++i) {
+                state.lanes[i] = feed.lanes[i].load(std::memory_order_relaxed);
+            }
+            state.records = feed.ticks.load(std::memory_order_relaxed);
+            last_seq = feed.last_seq.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if ((before & 1) == 0 && feed.version.load(std::memory_order_relaxed) == before) {
+                return state;
+            }
+        }
+    }
+
+    const Feed& feed_at(uint32_t feed) const {
+        if (feed >= feeds_.size()) {
+            throw std::runtime_error("Unknown feed index " + std::to_string(feed));
+        }
+        return feeds_[feed];
+    }
+
+public:
+    static constexpr size_t kMaxCheckpoints = 1024;
+
+    StreamDigest(std::vector<std::string> pairs, uint64_t checkpoint_ticks,
+                 size_t max_checkpoints = kMaxCheckpoints)
+        : pairs_(std::move(pairs))
+        , feeds_(pairs_.size())
+        , checkpoint_ticks_(checkpoint_ticks)
+        , max_checkpoints_(max_checkpoints)
+    {
+        if (pairs_.size() > PriceRecord::kMaxFeeds) {
+            throw std::invalid_argument("StreamDigest: too many feeds for the record's feed index");
+        }
+        for (auto& feed : feeds_) {
+            publish(feed, RecordDigest{}, 0);
+            reset_checkpoint(feed, 0);
+        }
+    }
+
+    size_t feed_count() const { return feeds_.size(); }
+    const std::string& pair(uint32_t feed) const { return pairs_.at(feed); }
+
+    // Folds a tick into its feed and returns its digest record
+    DigestRecord record(const PriceMsg& msg, uint32_t feed_index) {
+        if (feed_index >= feeds_.size()) {
+            throw std::runtime_error("Unknown feed index " + std::to_string(feed_index));
+        }
+        Feed& feed = feeds_[feed_index];
+        auto bytes = digest_record(msg, static_cast<uint16_t>(feed_index));
+
+        RecordDigest state;
+        for (size_t i = 0; i < 4; ++i) {
+            state.lanes[i] = feed.lanes[i].load(std::memory_order_relaxed);
+        }
+        state.records = feed.ticks.load(std::memory_order_relaxed);
+        state.add(bytes);
+        publish(feed, state, msg.src_seq);
+
+        if (state.records == feed.next_checkpoint) {
+            feed.next_checkpoint += checkpoint_ticks_;
+            std::lock_guard<std::mutex> lock(checkpoint_mutex_);
+            feed.checkpoints.push_back(DigestCheckpoint{state.records, msg.src_seq, state.value()});
+            if (feed.checkpoints.size() > max_checkpoints_) feed.checkpoints.pop_front();
+        }
+        return bytes;
+    }
+
+    FeedDigest value(uint32_t feed) const {
+        FeedDigest out;
+        auto state = load(feed_at(feed), out.last_seq);
+        out.ticks = state.records;
+        out.digest = state.value();
+        return out;
+    }
+
+    std::vector<DigestCheckpoint> checkpoints(uint32_t feed) const {
+        const auto& f = feed_at(feed);
+        std::lock_guard<std::mutex> lock(checkpoint_mutex_);
+        return {f.checkpoints.begin(), f.checkpoints.end()};
+    }
+
+    // Running state for a replacement process to continue from (handoff)
+    nlohmann::json save() const {
+        nlohmann::json feeds = nlohmann::json::array();
+        for (uint32_t i = 0; i < feeds_.size(); ++i) {
+            uint64_t last_seq = 0;
+            auto state = load(feeds_[i], last_seq);
+            feeds.push_back({{"pair", pairs_[i]}, {"lanes", state.lanes},
+                             {"ticks", state.records}, {"last_seq", last_seq}});
+        }
+        return feeds;
+    }
+
+    // Call before the ticker starts
+    void restore(const nlohmann::json& j) {
+        for (const auto& saved : j) {
+            auto it = std::find(pairs_.begin(), pairs_.end(), saved.at("pair").get<std::string>());
+            if (it == pairs_.end()) continue;
+            RecordDigest state;
+            state.lanes = saved.at("lanes").get<Xxh64::Lanes>();
+            state.records = saved.at("ticks").get<uint64_t>();
+            auto& feed = feeds_[static_cast<size_t>(it - pairs_.begin())];
+            publish(feed, state, saved.at("last_seq").get<uint64_t>());
+            reset_checkpoint(feed, state.records);
+        }
+    }
+
+    // Body of /digest
+    nlohmann::json to_json() const {
+        nlohmann::json feeds = nlohmann::json::array();
+        for (uint32_t i = 0; i < feeds_.size(); ++i) {
+            auto value = this->value(i);
+            nlohmann::json checkpoints = nlohmann::json::array();
+            for (const auto& cp : this->checkpoints(i)) {
+                checkpoints.push_back({{"ticks", cp.ticks}, {"seq", cp.seq}, {"digest", digest_hex(cp.digest)}});
+            }
+            feeds.push_back({{"pair", pairs_[i]}, {"ticks", value.ticks}, {"last_seq", value.last_seq},
+                             {"digest", digest_hex(value.digest)}, {"checkpoints", std::move(checkpoints)}});
+        }
+        return {{"algorithm", "xxh64"}, {"checkpoint_ticks", checkpoint_ticks_}, {"feeds", std::move(feeds)}};
+    }
+
+    // Prometheus samples; the digest goes in a label since sample values are doubles
+    std::string to_prometheus() const {
+        std::string out;
+        out += "# HELP stream_digest_ticks Ticks folded into the feed's stream digest\n";
+        out += "# TYPE stream_digest_ticks counter\n";
+        std::string info;
+        for (uint32_t i = 0; i < feeds_.size(); ++i) {
+            auto value = this->value(i);
+            out += "stream_digest_ticks{pair=\"" + pairs_[i] + "\"} " + std::to_string(value.ticks) + "\n";
+            info += "stream_digest_info{pair=\"" + pairs_[i] + "\",digest=\"" + digest_hex(value.digest) + "\"} 1\n";
+        }
+        out += "\n# HELP stream_digest_info XXH64 of the ticks emitted on the feed so far\n";
+        out += "# TYPE stream_digest_info gauge\n";
+        out += info;
+        out += "\n";
+        return out;
+    }
+};
+
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "config.hpp"
+#include "price_engine.hpp"
+#include "gbm_engine.hpp"
+#include "ou_engine.hpp"
+#include <optional>
+#include <variant>
+#include <stdexcept>
+
+namespace sim_core {
+
+// Closed set of engines, dispatched statically. Add new engines here and to
+// make_engine below.
+using EngineVariant = std::variant<GbmPriceEngine, OuPriceEngine>;
+
+// Builds the engine selected by price_model for the given pair. "jump" is
+// GBM with Merton jumps from jump_lambda/jump_mu/jump_sigma. The crash tilt
+// (tilt_* settings) applies to every model.
+inline EngineVariant make_engine(
+    const ServerConfig& config,
+    const std::string& pair,
+    uint64_t tick_interval_ms,
+    std::mt19937_64 rng)
+{
+    const std::string& model = config.model_for(pair);
+
+    if (model == "gbm" || model == "jump") {
+        bool jumps = model == "jump";
+        return GbmPriceEngine(
+            pair,
+            config.price_start,
+            config.gbm_mu,
+            config.gbm_sigma,
+            tick_interval_ms,
+            std::move(rng),
+            config.price_decimals,
+            jumps ? config.jump_lambda : 0.0,
+            jumps ? config.jump_mu : 0.0,
+            jumps ? config.jump_sigma : 0.0,
+            config.crash_tilt
+        );
+    }
+
+    if (model == "ou") {
+        return OuPriceEngine(
+            pair,
+            config.price_start,
+            config.ou_peg,
+            config.ou_theta,
+            config.ou_sigma,
+            config.jump_lambda,
+            config.jump_mu,
+            config.jump_sigma,
+            tick_interval_ms,
+            std::move(rng),
+            config.price_decimals,
+            config.crash_tilt
+        );
+    }
+
+    throw std::runtime_error("Unknown price_model '" + model + "' for pair " + pair);
+}
+
+inline int64_t step(EngineVariant& engine) {
+    return std::visit([](auto& e) { return e.step(); }, engine);
+}
+
+inline int64_t step_normal(EngineVariant& engine, double z) {
+    return std::visit([z](auto& e) { return e.step_normal(z); }, engine);
+}
+
+// One dispatch per batch; the stepping loop itself is fully inlined
+inline void next_ticks(EngineVariant& engine, std::span<int64_t> out) {
+    std::visit([out](auto& e) { e.next_ticks(out); }, engine);
+}
+
+inline PriceMsg next_tick(EngineVariant& engine, uint64_t ts, uint64_t seq,
+                          SourceKind source, uint32_t delay_ms, bool stale) {
+    return std::visit([&](auto& e) { return e.next_tick(ts, seq, source, delay_ms, stale); }, engine);
+}
+
+inline Price current_price(const EngineVariant& engine) {
+    return std::visit([](const auto& e) { return e.current_price(); }, engine);
+}
+
+inline std::optional<double> log_weight(const EngineVariant& engine) {
+    return std::visit([](const auto& e) { return e.log_weight(); }, engine);
+}
+
+inline void split_paths(EngineVariant& engine, uint64_t steps) {
+    std::visit([steps](auto& e) { e.split_paths(steps); }, engine);
+}
+
+inline std::optional<uint64_t> path(const EngineVariant& engine) {
+    return std::visit([](const auto& e) { return e.path(); }, engine);
+}
+
+inline bool path_complete(const EngineVariant& engine) {
+    return std::visit([](const auto& e) { return e.path_complete(); }, engine);
+}
+
+inline nlohmann::json save_engine(const EngineVariant& engine) {
+    return std::visit([](const auto& e) { return e.save(); }, engine);
+}
+
+// Throws if the saved engine is a different model or price scale
+inline void restore_engine(EngineVariant& engine, const nlohmann::json& saved) {
+    std::visit([&saved](auto& e) { e.restore(saved); }, engine);
+}
+
+// Virtual PriceEngine over a statically dispatched engine, for callers that
+// still hold a PriceEnginePtr.
+template<typename Engine>
+class PriceEngineAdapter : public PriceEngine {
+private:
+    Engine engine_;
+
+public:
+    explicit PriceEngineAdapter(Engine engine) : engine_(std::move(engine)) {}
+
+    PriceMsg next_tick(
+        uint64_t ts,
+        uint64_t seq,
+        SourceKind source,
+        uint32_t delay_ms,
+        bool stale
+    ) override {
+        return engine_.next_tick(ts, seq, source, delay_ms, stale);
+    }
+
+    Price current_price() const override {
+        return engine_.current_price();
+    }
+
+    std::string pair() const override {
+        return engine_.pair();
+    }
+
+    Engine& engine() { return engine_; }
+};
+
+inline PriceEnginePtr make_price_engine(
+    const ServerConfig& config,
+    const std::string& pair,
+    uint64_t tick_interval_ms,
+    std::mt19937_64 rng)
+{
+    return std::visit([](auto&& e) -> PriceEnginePtr {
+        using Engine = std::decay_t<decltype(e)>;
+        return std::make_unique<PriceEngineAdapter<Engine>>(std::move(e));
+    }, make_engine(config, pair, tick_interval_ms, std::move(rng)));
+}
+
+}
@@ -0,0 +1,339 @@
+#pragma once
+
+#include "types.hpp"
+#include "config.hpp"
+#include "rng.hpp"
+#include "metrics.hpp"
+#include "history.hpp"
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sim_core {
+
+// Per-tick fault injection expressed as policy types. Each stage has an
+// enabled and a disabled policy; dispatch_fault_pipeline picks them from
+// config once at startup, so disabled stages compile away on the hot path.
+
+struct FaultConfig {
+    Range<uint64_t> latency_ms;
+    Range<uint64_t> jitter_ms;
+    double p_drop;
+    double p_dup;
+    double p_reorder;
+    uint64_t stale_after_ms;  // 0 leaves msg.stale untouched
+    std::optional<BurstLossConfig> burst_loss{};  // replaces i.i.d. drops when set
+    std::optional<LatencyDistribution> latency_model{};  // replaces latency_ms when set
+};
+
+struct NoDelay {
+    static constexpr bool enabled = false;
+};
+
+// Path latency plus send jitter, reported in delay_ms
+struct UniformDelay {
+    static constexpr bool enabled = true;
+    Range<uint64_t> latency_ms;
+    Range<uint64_t> jitter_ms;
+
+    uint32_t sample(std::mt19937_64& rng) const {
+        return static_cast<uint32_t>(
+            sample_range(rng, latency_ms.min, latency_ms.max) +
+            sample_range(rng, jitter_ms.min, jitter_ms.max)
+        );
+    }
+};
+
+// Tail latency model plus uniform send jitter
+struct ModeledDelay {
+    static constexpr bool enabled = true;
+    LatencyDistribution latency;
+    Range<uint64_t> jitter_ms;
+
+    uint32_t sample(std::mt19937_64& rng) const {
+        return latency.sample(rng) + static_cast<uint32_t>(sample_range(rng, jitter_ms.min, jitter_ms.max));
+    }
+};
+
+struct NoDrop {
+    static constexpr bool enabled = false;
+};
+
+// Drop stages see the stream (oracle feed index, 0 for the DEX) so loss
+// state can be kept per stream
+struct BernoulliDrop {
+    static constexpr bool enabled = true;
+    double p;
+
+    bool sample(std::mt19937_64& rng, uint32_t) { return happens(rng, p); }
+};
+
+// Gilbert-Elliott loss: each stream steps a good/bad Markov chain once per
+// tick and drops with its current state's loss rate, so losses cluster.
+// Long-run loss is p_good * (1 - pi) + loss_bad * pi, pi = enter / (enter + exit).
+struct GilbertElliottDrop {
+    static constexpr bool enabled = true;
+    double p_good;
+    BurstLossConfig bad;
+    std::vector<uint8_t> in_bad = {};
+
+    bool sample(std::mt19937_64& rng, uint32_t stream) {
+        if (stream >= in_bad.size()) {
+            in_bad.resize(stream + 1, 0);
+        }
+        if (in_bad[stream]) {
+            in_bad[stream] = !happens(rng, bad.p_exit_bad);
+        } else if (happens(rng, bad.p_enter_bad)) {
+            in_bad[stream] = 1;
+            get_metrics().ws_loss_bursts++;
+        }
+        return happens(rng, in_bad[stream] ? bad.loss_bad : p_good);
+    }
+};
+
+struct NoDup {
+    static constexpr bool enabled = false;
+};
+
+struct BernoulliDup {
+    static constexpr bool enabled = true;
+    double p;
+
+    bool sample(std::mt19937_64& rng) const { return happens(rng, p); }
+};
+
+struct NoReorder {
+    static constexpr bool enabled = false;
+};
+
+// Holds a frame back and releases it after the next one on the same stream
+struct BernoulliReorder {
+    static constexpr bool enabled = true;
+    double p;
+
+    bool sample(std::mt19937_64& rng) const { return happens(rng, p); }
+};
+
+struct NoStaleness {
+    static constexpr bool enabled = false;
+};
+
+// Marks a tick stale when the gap since the previous tick exceeds the limit
+struct StaleAfter {
+    static constexpr bool enabled = true;
+    uint64_t stale_after_ms;
+    uint64_t last_tick_ms = 0;
+
+    bool update(uint64_t now_ms) {
+        bool stale = now_ms - last_tick_ms > stale_after_ms;
+        last_tick_ms = now_ms;
+        return stale;
+    }
+};
+
+template<typename Delay, typename Drop, typename Dup, typename Reorder, typename Staleness>
+class FaultPipeline {
+private:
+    Delay delay_;
+    Drop drop_;
+    Dup dup_;
+    Reorder reorder_;
+    Staleness staleness_;
+    std::mt19937_64 rng_;
+    std::vector<std::optional<PriceMsg>> held_;  // reorder slot per stream
+    RunHistory* history_ = nullptr;
+
+    void record(FaultKind kind, const PriceMsg& msg, uint32_t stream) {
+        if (history_ != nullptr) {
+            history_->record_fault(kind, msg, stream);
+        }
+    }
+
+    template<typename Emit>
+    void send(const PriceMsg& msg, Emit& emit, uint32_t stream) {
+        emit(msg);
+        get_metrics().ws_frames_sent++;
+
+        if constexpr (Dup::enabled) {
+            if (dup_.sample(rng_)) {
+                emit(msg);
+                get_metrics().ws_frames_duplicated++;
+                record(FaultKind::Duplicate, msg, stream);
+            }
+        }
+    }
+
+public:
+    FaultPipeline(Delay delay, Drop drop, Dup dup, Reorder reorder, Staleness staleness, std::mt19937_64 rng)
+        : delay_(delay),
+          drop_(drop),
+          dup_(dup),
+          reorder_(reorder),
+          staleness_(staleness),
+          rng_(std::move(rng))
+    {}
+
+    // Records injected faults into history (must outlive the pipeline)
+    void set_history(RunHistory* history) { history_ = history; }
+
+    // Generator, held reorder frames and burst-loss states, for a handoff.
+    // Staleness is measured against the new process's clock and restarts.
+    nlohmann::json save() const {
+        auto held = nlohmann::json::array();
+        for (uint32_t stream = 0; stream < held_.size(); ++stream) {
+            if (!held_[stream].has_value()) continue;
+            const auto& msg = *held_[stream];
+            held.push_back({
+                {"stream", stream},
+                {"msg", msg},
+                {"price_raw", msg.price.raw},
+                {"decimals", msg.price.decimals}
+            });
+        }
+        nlohmann::json j{{"rng", save_rng(rng_)}, {"held", held}};
+        if constexpr (std::is_same_v<Drop, GilbertElliottDrop>) {
+            j["in_bad"] = drop_.in_bad;
+        }
+        return j;
+    }
+
+    void restore(const nlohmann::json& saved) {
+        restore_rng(rng_, saved.at("rng").get<std::string>());
+        if constexpr (Reorder::enabled) {
+            for (const auto& entry : saved.at("held")) {
+                auto stream = entry.at("stream").get<uint32_t>();
+                if (stream >= held_.size()) {
+                    held_.resize(stream + 1);
+                }
+                auto msg = entry.at("msg").get<PriceMsg>();
+                msg.price = Price{entry.at("price_raw").get<int64_t>(), entry.at("decimals").get<uint8_t>()};
+                held_[stream] = std::move(msg);
+            }
+        }
+        if constexpr (std::is_same_v<Drop, GilbertElliottDrop>) {
+            if (saved.contains("in_bad")) {
+                drop_.in_bad = saved["in_bad"].get<std::vector<uint8_t>>();
+            }
+        }
+    }
+
+    // Runs one generated tick through the enabled stages; emit is called for
+    // every frame that should go out, in order. stream keys per-stream
+    // stage state (the oracle feed index).
+    template<typename Emit>
+    void process(PriceMsg msg, uint64_t now_ms, Emit&& emit, uint32_t stream = 0) {
+        if constexpr (Delay::enabled) {
+            msg.delay_ms = delay_.sample(rng_);
+        }
+        if constexpr (Staleness::enabled) {
+            msg.stale = staleness_.update(now_ms);
+        }
+        if constexpr (Drop::enabled) {
+            if (drop_.sample(rng_, stream)) {
+                get_metrics().ws_frames_dropped++;
+                record(FaultKind::Drop, msg, stream);
+                return;
+            }
+        }
+        if constexpr (Reorder::enabled) {
+            if (stream >= held_.size()) {
+                held_.resize(stream + 1);
+            }
+            auto& held = held_[stream];
+            if (held.has_value()) {
+                send(msg, emit, stream);
+                send(*held, emit, stream);
+                held.reset();
+                return;
+            }
+            if (reorder_.sample(rng_)) {
+                get_metrics().ws_frames_reordered++;
+                record(FaultKind::Reorder, msg, stream);
+                held = std::move(msg);
+                return;
+            }
+        }
+        send(msg, emit, stream);
+    }
+};
+
+namespace detail {
+
+template<typename On, typename Off, typename F>
+void choose_stage(bool enabled, On on, Off off, F&& f) {
+    if (enabled) {
+        f(on);
+    } else {
+        f(off);
+    }
+}
+
+}
+
+// Calls f with the FaultPipeline specialization matching config
+template<typename F>
+void dispatch_fault_pipeline(const FaultConfig& config, std::mt19937_64 rng, F&& f) {
+    using detail::choose_stage;
+
+    bool delay_on = config.latency_ms.max > 0 || config.jitter_ms.max > 0;
+
+    auto with_delay = [&](auto&& g) {
+        if (config.latency_model.has_value()) {
+            g(ModeledDelay{*config.latency_model, config.jitter_ms});
+        } else {
+            choose_stage(delay_on, UniformDelay{config.latency_ms, config.jitter_ms}, NoDelay{}, g);
+        }
+    };
+
+    auto with_drop = [&](auto&& g) {
+        if (config.burst_loss.has_value()) {
+            g(GilbertElliottDrop{config.p_drop, *config.burst_loss});
+        } else {
+            choose_stage(config.p_drop > 0.0, BernoulliDrop{config.p_drop}, NoDrop{}, g);
+        }
+    };
+
+    with_delay([&](auto delay) {
+    with_drop([&](auto drop) {
+    choose_stage(config.p_dup > 0.0, BernoulliDup{config.p_dup}, NoDup{}, [&](auto dup) {
+    choose_stage(config.p_reorder > 0.0, BernoulliReorder{config.p_reorder}, NoReorder{}, [&](auto reorder) {
+    choose_stage(config.stale_after_ms > 0, StaleAfter{config.stale_after_ms}, NoStaleness{}, [&](auto staleness) {
+        f(FaultPipeline<decltype(delay), decltype(drop), decltype(dup), decltype(reorder), decltype(staleness)>(
+            std::move(delay), std::move(drop), dup, reorder, staleness, std::move(rng)));
+    });
+    });
+    });
+    });
+    });
+}
+
+inline FaultConfig dex_fault_config(const DexConfig& config) {
+    return FaultConfig{
+        config.dex_latency_ms,
+        config.dex_ws_jitter_ms,
+        config.dex_p_drop,
+        config.dex_p_dup,
+        config.dex_p_reorder,
+        config.dex_stale_after_ms,
+        config.dex_burst_loss,
+        config.dex_latency_model
+    };
+}
+
+// Oracle staleness is tracked per feed by OracleFeedSet, so the stage is off
+inline FaultConfig oracle_fault_config(const OracleConfig& config) {
+    return FaultConfig{
+        Range<uint64_t>{0, 0},
+        config.oracle_ws_jitter_ms,
+        config.oracle_p_drop,
+        config.oracle_p_dup,
+        config.oracle_p_reorder,
+        0,
+        config.oracle_burst_loss,
+        config.oracle_latency_model
+    };
+}
+
+}
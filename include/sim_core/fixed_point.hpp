@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace sim_core {
+
+constexpr uint8_t kMaxPriceDecimals = 18;
+constexpr uint8_t kDefaultPriceDecimals = 8;
+
+// Configs must leave room for prices to reach this multiple of their start
+// before the raw value leaves int64
+constexpr double kPriceHeadroom = 1000.0;
+
+constexpr int64_t pow10_i64(uint8_t exponent) {
+    int64_t value = 1;
+    for (uint8_t i = 0; i < exponent; ++i) {
+        value *= 10;
+    }
+    return value;
+}
+
+// Whether price * 10^decimals is representable as an int64 raw value
+inline bool price_fits(double price, uint8_t decimals) {
+    constexpr double kLimit = 9223372036854775808.0;  // 2^63
+    double scaled = price * static_cast<double>(pow10_i64(decimals));
+    return scaled > -kLimit && scaled < kLimit;  // false for NaN
+}
+
+// llround of an already scaled price, throwing instead of returning an
+// unspecified value when it does not fit in int64
+inline int64_t scaled_to_raw(double scaled) {
+    constexpr double kLimit = 9223372036854775808.0;
+    if (!(scaled > -kLimit && scaled < kLimit)) {
+        throw std::out_of_range("price exceeds the int64 range of its decimals");
+    }
+    return std::llround(scaled);
+}
+
+// Fixed-point price as Chainlink reports it: an integer answer scaled by
+// 10^decimals. Comparisons and trigger math stay in integers; conversion to
+// double happens only when serializing to JSON or logging.
+struct Price {
+    int64_t raw = 0;
+    uint8_t decimals = kDefaultPriceDecimals;
+
+    static Price from_double(double value, uint8_t decimals = kDefaultPriceDecimals) {
+        if (decimals > kMaxPriceDecimals) {
+            throw std::invalid_argument("price decimals must be <= 18");
+        }
+        return Price{scaled_to_raw(value * static_cast<double>(pow10_i64(decimals))), decimals};
+    }
+
+    double to_double() const {
+        return static_cast<double>(raw) / static_cast<double>(pow10_i64(decimals));
+    }
+
+    friend bool operator==(const Price&, const Price&) = default;
+};
+
+// Smallest absolute move in raw units that reaches deviation_bps of last:
+// ceil(last * bps / 10000), computed without overflowing int64. With it the
+// hot-path trigger check is a single integer compare, |current - last| >= band,
+// which is exactly floor(|dp / p| * 10000) >= bps.
+constexpr int64_t deviation_band(int64_t last, uint32_t deviation_bps) {
+    int64_t magnitude = last < 0 ? -last : last;
+    int64_t whole = magnitude / 10000;
+    int64_t rest = magnitude % 10000;
+    int64_t bps = static_cast<int64_t>(deviation_bps);
+    return whole * bps + (rest * bps + 9999) / 10000;
+}
+
+inline bool deviation_exceeded(int64_t current, int64_t last, uint32_t deviation_bps) {
+    return std::llabs(current - last) >= deviation_band(last, deviation_bps);
+}
+
+}
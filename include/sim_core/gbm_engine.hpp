@@ -1,37 +1,130 @@
 #pragma once
 
-#include "price_engine.hpp"
+#include "types.hpp"
+#include "importance_sampling.hpp"
+#include "det_math.hpp"
+#include "rng.hpp"
+#include <optional>
 #include <random>
 #include <cmath>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace sim_core {
 
-class GbmPriceEngine : public PriceEngine {
+// Statically dispatched engine (see engine_factory.hpp for the variant
+// registry and the PriceEngine adapter). With jump_lambda > 0 it is a
+// Merton jump-diffusion: Poisson jumps with normal log sizes on top of the
+// GBM step. An optional CrashTilt switches it to importance sampling.
+class GbmPriceEngine final {
 private:
     std::string pair_;
+    double initial_price_;
     double price_;
     double drift_;
     double volatility_;
-    uint64_t tick_interval_ms_;
+    double dt_;
+    double sqrt_dt_;
+    double jump_prob_;
+    double jump_mu_;
+    double jump_sigma_;
+    uint8_t decimals_;
     std::mt19937_64 rng_;
-    std::normal_distribution<double> normal_;
+    DetNormal normal_;
+    DetUniform uniform_;
+    std::vector<double> scratch_;
+    LikelihoodRatio likelihood_;
+    PathSplit paths_;
+
+    double step_factor(double z) const {
+        double dw = z * sqrt_dt_;
+
+        double drift_component = drift_ * dt_;
+        double diffusion_component = volatility_ * dw;
+        return det_exp(drift_component + diffusion_component);
+    }
+
+    double jump_log_return() {
+        bool jumped = uniform_(rng_) < likelihood_.jump_probability();
+        likelihood_.jump_decision(jumped);
+        if (!jumped) return 0.0;
+        return jump_mu_ + jump_sigma_ * likelihood_.jump_size(normal_(rng_));
+    }
 
 public:
+    // drift and volatility are annualized; jump_lambda is in events per hour
     GbmPriceEngine(
         std::string pair,
         double initial_price,
         double drift,
         double volatility,
         uint64_t tick_interval_ms,
-        std::mt19937_64 rng
+        std::mt19937_64 rng,
+        uint8_t decimals = kDefaultPriceDecimals,
+        double jump_lambda = 0.0,
+        double jump_mu = 0.0,
+        double jump_sigma = 0.0,
+        const CrashTilt& tilt = {}
     ) : pair_(std::move(pair)),
+        initial_price_(initial_price),
         price_(initial_price),
         drift_(drift),
         volatility_(volatility),
-        tick_interval_ms_(tick_interval_ms),
+        dt_(static_cast<double>(tick_interval_ms) / 1000.0 / 86400.0 / 365.25),
+        sqrt_dt_(std::sqrt(dt_)),
+        jump_mu_(jump_mu),
+        jump_sigma_(jump_sigma),
+        decimals_(decimals),
         rng_(std::move(rng)),
-        normal_(0.0, 1.0)
-    {}
+        normal_(0.0, 1.0),
+        uniform_(0.0, 1.0)
+    {
+        double dt_hours = static_cast<double>(tick_interval_ms) / 1000.0 / 3600.0;
+        jump_prob_ = jump_lambda > 0.0 ? 1.0 - det_exp(-jump_lambda * dt_hours) : 0.0;
+        likelihood_ = LikelihoodRatio(tilt, dt_, volatility_ * sqrt_dt_, jump_prob_, jump_sigma_);
+    }
+
+    int64_t step() {
+        return step_normal(normal_(rng_));
+    }
+
+    // Steps with a caller-supplied standard normal shock (path_generator.hpp)
+    int64_t step_normal(double z) {
+        if (paths_.begin_step()) {
+            price_ = initial_price_;
+            likelihood_.reset();
+        }
+        price_ *= step_factor(likelihood_.diffusion(z));
+        if (jump_prob_ > 0.0) price_ *= det_exp(jump_log_return());
+        price_ = std::max(price_, 0.01);
+        return Price::from_double(price_, decimals_).raw;
+    }
+
+    // Fills out with the next out.size() raw prices. Draws stay serial, the
+    // per-step exp factors are independent and computed in a separate loop
+    // the compiler can vectorize. Bit-identical to calling step() repeatedly.
+    void next_ticks(std::span<int64_t> out) {
+        if (jump_prob_ > 0.0 || likelihood_.active() || paths_.enabled()) {
+            for (auto& raw : out) raw = step();
+            return;
+        }
+
+        scratch_.resize(out.size());
+        for (auto& z : scratch_) {
+            z = normal_(rng_);
+        }
+        for (auto& z : scratch_) {
+            z = step_factor(z);
+        }
+
+        double scale = static_cast<double>(pow10_i64(decimals_));
+        for (size_t i = 0; i < out.size(); ++i) {
+            price_ = std::max(price_ * scratch_[i], 0.01);
+            out[i] = scaled_to_raw(price_ * scale);
+        }
+    }
 
     PriceMsg next_tick(
         uint64_t ts,
@@ -39,36 +132,86 @@ public:
         SourceKind source,
         uint32_t delay_ms,
         bool stale
-    ) override {
-        double dt = static_cast<double>(tick_interval_ms_) / 1000.0 / 86400.0 / 365.25;
-
-        double dw = normal_(rng_) * std::sqrt(dt);
-
-        double drift_component = drift_ * dt;
-        double diffusion_component = volatility_ * dw;
-        double relative_change = drift_component + diffusion_component;
-
-        price_ *= std::exp(relative_change);
-        price_ = std::max(price_, 0.01);
-
+    ) {
         return PriceMsg{
             ts,
             pair_,
-            price_,
+            Price{step(), decimals_},
             source,
             seq,
             delay_ms,
-            stale
+            stale,
+            log_weight(),
+            path(),
+            paths_.complete()
+        };
+    }
+
+    // Log likelihood ratio of the path since construction, the last reset
+    // or the path's restart, set only while importance sampling
+    std::optional<double> log_weight() const {
+        if (!likelihood_.active()) return std::nullopt;
+        return likelihood_.log_weight();
+    }
+
+    void reset_log_weight() { likelihood_.reset(); }
+
+    // Restarts from the initial price with a fresh weight every steps steps
+    // (see PathSplit); 0 keeps one endless path
+    void split_paths(uint64_t steps) { paths_ = PathSplit{steps}; }
+
+    // Index of the current path while split
+    std::optional<uint64_t> path() const {
+        if (!paths_.enabled()) return std::nullopt;
+        return paths_.path;
+    }
+
+    bool path_complete() const { return paths_.complete(); }
+
+    // Full stepping state (price, generator, weight and path position) for a
+    // handoff; restore() continues the exact stream on an engine built from
+    // the same config
+    nlohmann::json save() const {
+        nlohmann::json j{
+            {"model", "gbm"},
+            {"price", price_},
+            {"price_raw", current_price().raw},
+            {"decimals", decimals_},
+            {"rng", save_rng(rng_)},
+            {"log_weight", likelihood_.log_weight()},
+            {"path", paths_.path},
+            {"path_step", paths_.step}
         };
+        return j;
     }
 
-    double current_price() const override {
-        return price_;
+    void restore(const nlohmann::json& j) {
+        if (j.at("model").get<std::string>() != "gbm") {
+            throw std::runtime_error("Saved " + j["model"].get<std::string>() + " engine for " + pair_ +
+                " does not match the configured gbm engine");
+        }
+        if (j.at("decimals").get<uint8_t>() != decimals_) {
+            throw std::runtime_error("Saved engine for " + pair_ + " has " +
+                std::to_string(j["decimals"].get<int>()) + " price decimals, config has " +
+                std::to_string(decimals_));
+        }
+        price_ = j.at("price").get<double>();
+        restore_rng(rng_, j.at("rng").get<std::string>());
+        likelihood_.restore(j.at("log_weight").get<double>());
+        paths_.restore(j.at("path").get<uint64_t>(), j.at("path_step").get<uint64_t>());
     }
 
-    std::string pair() const override {
+    Price current_price() const {
+        return Price::from_double(price_, decimals_);
+    }
+
+    const std::string& pair() const {
         return pair_;
     }
+
+    uint8_t decimals() const {
+        return decimals_;
+    }
 };
 
 }
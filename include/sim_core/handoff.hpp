@@ -0,0 +1,445 @@
+#pragma once
+
+#include "ws_hub.hpp"
+#include "io_pool.hpp"
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace sim_core {
+
+// Zero-downtime restart. A running server listens on a unix socket
+// (handoff_socket); a replacement started with the same setting connects to
+// it and receives the listening sockets, every live subscriber socket with
+// its tier, bandwidth limit and partly read frame (SCM_RIGHTS) and a JSON
+// snapshot of the generator state. The old process pauses its ticker, lets queued frames drain, lets
+// writes and pings in flight finish, cancels its reads so it consumes no
+// input meant for the new process, sends everything, waits for an ack and
+// exits without closing the connections.
+
+struct Handoff {
+    nlohmann::json state;
+    std::vector<int> listener_fds;
+    std::vector<int> client_fds;
+    std::vector<Tier> client_tiers;
+    std::vector<BandwidthLimit> client_limits;
+    std::vector<std::string> client_unread;
+    int conn = -1;  // to the old process, acked by complete_handoff()
+};
+
+namespace detail {
+
+constexpr size_t kFdsPerMessage = 250;  // below the kernel's SCM_MAX_FD
+constexpr char kHandoffAck = 'K';
+
+inline void write_all(int fd, const void* data, size_t n) {
+    auto* p = static_cast<const char*>(data);
+    while (n > 0) {
+        ssize_t w = ::write(fd, p, n);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) throw std::runtime_error(std::string("handoff write failed: ") + std::strerror(errno));
+        p += w;
+        n -= static_cast<size_t>(w);
+    }
+}
+
+inline void read_all(int fd, void* data, size_t n) {
+    auto* p = static_cast<char*>(data);
+    while (n > 0) {
+        ssize_t r = ::read(fd, p, n);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) throw std::runtime_error("handoff connection closed");
+        p += r;
+        n -= static_cast<size_t>(r);
+    }
+}
+
+// Sends fds in chunks, each chunk riding on a one-byte message
+inline void send_fds(int sock, const std::vector<int>& fds) {
+    for (size_t off = 0; off < fds.size(); off += kFdsPerMessage) {
+        size_t n = std::min(kFdsPerMessage, fds.size() - off);
+
+        char byte = 0;
+        iovec iov{&byte, 1};
+        std::vector<char> control(CMSG_SPACE(sizeof(int) * n));
+
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.data();
+        msg.msg_controllen = control.size();
+
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * n);
+        std::memcpy(CMSG_DATA(cmsg), fds.data() + off, sizeof(int) * n);
+
+        if (::sendmsg(sock, &msg, 0) != 1) {
+            throw std::runtime_error(std::string("handoff sendmsg failed: ") + std::strerror(errno));
+        }
+    }
+}
+
+inline std::vector<int> recv_fds(int sock, size_t count) {
+    std::vector<int> fds;
+    fds.reserve(count);
+
+    while (fds.size() < count) {
+        size_t n = std::min(kFdsPerMessage, count - fds.size());
+
+        char byte = 0;
+        iovec iov{&byte, 1};
+        std::vector<char> control(CMSG_SPACE(sizeof(int) * n));
+
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.data();
+        msg.msg_controllen = control.size();
+
+        if (::recvmsg(sock, &msg, MSG_CMSG_CLOEXEC) != 1) {
+            throw std::runtime_error("handoff recvmsg failed");
+        }
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        if (cmsg == nullptr || cmsg->cmsg_type != SCM_RIGHTS ||
+            cmsg->cmsg_len != CMSG_LEN(sizeof(int) * n)) {
+            throw std::runtime_error("handoff message carried no descriptors");
+        }
+
+        size_t base = fds.size();
+        fds.resize(base + n);
+        std::memcpy(fds.data() + base, CMSG_DATA(cmsg), sizeof(int) * n);
+    }
+    return fds;
+}
+
+inline sockaddr_un unix_address(const std::string& path) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("handoff_socket path too long: " + path);
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return addr;
+}
+
+inline boost::asio::ip::tcp socket_protocol(int fd) {
+    sockaddr_storage addr{};
+    socklen_t len = sizeof(addr);
+    if (::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+        throw std::runtime_error("handoff: getsockname failed");
+    }
+    return addr.ss_family == AF_INET6 ? boost::asio::ip::tcp::v6() : boost::asio::ip::tcp::v4();
+}
+
+}
+
+// Old side: header (length-prefixed JSON with counts, tiers, limits and
+// unread bytes), then fds
+inline void send_handoff(
+    int conn,
+    const nlohmann::json& state,
+    const std::vector<int>& listener_fds,
+    const std::vector<HandoffClient>& clients)
+{
+    nlohmann::json header;
+    header["state"] = state;
+    header["listeners"] = listener_fds.size();
+    header["tiers"] = nlohmann::json::array();
+    header["limits"] = nlohmann::json::array();
+    header["unread"] = nlohmann::json::array();
+
+    std::vector<int> fds = listener_fds;
+    for (const auto& client : clients) {
+        fds.push_back(client.fd);
+        header["tiers"].push_back(tier_name(client.tier));
+        header["limits"].push_back({client.limit.bytes_per_sec, client.limit.burst_bytes});
+        header["unread"].push_back(std::vector<uint8_t>(client.unread.begin(), client.unread.end()));
+    }
+
+    std::string body = header.dump();
+    auto len = static_cast<uint32_t>(body.size());
+    uint8_t prefix[4] = {
+        static_cast<uint8_t>(len), static_cast<uint8_t>(len >> 8),
+        static_cast<uint8_t>(len >> 16), static_cast<uint8_t>(len >> 24)
+    };
+    detail::write_all(conn, prefix, sizeof(prefix));
+    detail::write_all(conn, body.data(), body.size());
+    detail::send_fds(conn, fds);
+}
+
+// Waits for the new process's ack without blocking the thread; false on
+// timeout, a wrong byte or a closed connection
+template<typename Socket>
+boost::asio::awaitable<bool> async_await_handoff_ack(Socket& conn, std::chrono::milliseconds timeout) {
+    namespace asio = boost::asio;
+
+    asio::steady_timer timer(conn.get_executor());
+    timer.expires_after(timeout);
+    timer.async_wait([&conn](boost::system::error_code ec) {
+        if (!ec) {
+            boost::system::error_code ignored;
+            conn.cancel(ignored);
+        }
+    });
+
+    char ack = 0;
+    boost::system::error_code ec;
+    co_await asio::async_read(conn, asio::buffer(&ack, 1), asio::redirect_error(asio::use_awaitable, ec));
+    timer.cancel();
+    co_return !ec && ack == detail::kHandoffAck;
+}
+
+// New side: reads what send_handoff wrote
+inline Handoff receive_handoff(int conn) {
+    uint8_t prefix[4];
+    detail::read_all(conn, prefix, sizeof(prefix));
+    uint32_t len = prefix[0] | (prefix[1] << 8) | (prefix[2] << 16) | (static_cast<uint32_t>(prefix[3]) << 24);
+
+    std::string body(len, '\0');
+    detail::read_all(conn, body.data(), len);
+    auto header = nlohmann::json::parse(body);
+
+    Handoff handoff;
+    handoff.conn = conn;
+    handoff.state = header["state"];
+
+    size_t listeners = header["listeners"].get<size_t>();
+    for (const auto& tier : header["tiers"]) {
+        handoff.client_tiers.push_back(parse_tier(tier.get<std::string>()));
+    }
+    // absent when handed over by a build without bandwidth limits
+    handoff.client_limits.resize(handoff.client_tiers.size());
+    if (header.contains("limits")) {
+        for (size_t i = 0; i < handoff.client_limits.size(); ++i) {
+            const auto& limit = header["limits"].at(i);
+            handoff.client_limits[i] = BandwidthLimit{limit.at(0).get<uint64_t>(), limit.at(1).get<uint64_t>()};
+        }
+    }
+
+    handoff.client_unread.resize(handoff.client_tiers.size());
+    if (header.contains("unread")) {
+        for (size_t i = 0; i < handoff.client_unread.size(); ++i) {
+            auto bytes = header["unread"].at(i).get<std::vector<uint8_t>>();
+            handoff.client_unread[i].assign(bytes.begin(), bytes.end());
+        }
+    }
+
+    auto fds = detail::recv_fds(conn, listeners + handoff.client_tiers.size());
+    handoff.listener_fds.assign(fds.begin(), fds.begin() + static_cast<ptrdiff_t>(listeners));
+    handoff.client_fds.assign(fds.begin() + static_cast<ptrdiff_t>(listeners), fds.end());
+    return handoff;
+}
+
+// Connects to a running server's handoff socket; nullopt if none is listening
+inline std::optional<Handoff> request_handoff(const std::string& path) {
+    int conn = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (conn < 0) {
+        throw std::runtime_error("handoff: socket() failed");
+    }
+
+    auto addr = detail::unix_address(path);
+    if (::connect(conn, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(conn);
+        return std::nullopt;
+    }
+
+    try {
+        return receive_handoff(conn);
+    } catch (...) {
+        ::close(conn);
+        throw;
+    }
+}
+
+// Tells the old process everything was adopted so it can exit
+inline void complete_handoff(Handoff& handoff) {
+    char ack = detail::kHandoffAck;
+    detail::write_all(handoff.conn, &ack, 1);
+    ::close(handoff.conn);
+    handoff.conn = -1;
+}
+
+inline boost::asio::ip::tcp::acceptor adopt_acceptor(boost::asio::io_context& ioc, int fd) {
+    return boost::asio::ip::tcp::acceptor(ioc, detail::socket_protocol(fd), fd);
+}
+
+// Wraps an already-upgraded websocket connection. Beast has no way to mark a
+// stream open without a handshake, so the handshake is run against a
+// socketpair (its 101 reply is discarded) and the real socket swapped in.
+// unread, the start of a frame the old process read only in part, follows
+// the handshake request so the stream parses it before reading the socket.
+// Options negotiated by the original handshake, such as permessage-deflate,
+// are not carried over: the new stream runs without extensions (the servers
+// enable none today, so a new extension must be handed over too).
+inline std::shared_ptr<WsHub::Stream> adopt_websocket(boost::asio::io_context& ioc, int fd,
+                                                      const std::string& unread = {}) {
+    if (unread.size() > TrackedSocket::kMaxUnreadBytes) {
+        ::close(fd);
+        throw std::runtime_error("handoff: unread bytes exceed the websocket read buffer");
+    }
+
+    int pair[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, pair) != 0) {
+        ::close(fd);
+        throw std::runtime_error("handoff: socketpair failed");
+    }
+
+    auto protocol = detail::socket_protocol(fd);
+    auto ws = std::make_shared<WsHub::Stream>(boost::asio::ip::tcp::socket(ioc, protocol, pair[0]));
+
+    std::string handshake =
+        "GET / HTTP/1.1\r\n"
+        "Host: handoff\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: upgrade\r\n"
+        "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+        "Sec-WebSocket-Version: 13\r\n"
+        "\r\n" + unread;
+
+    boost::beast::error_code ec;
+    ws->accept(boost::asio::buffer(handshake), ec);
+    ::close(pair[1]);
+
+    auto& socket = ws->next_layer();
+    socket.close();
+    if (ec) {
+        ::close(fd);
+        throw std::runtime_error("handoff: adopt handshake failed: " + ec.message());
+    }
+    socket.assign(protocol, fd);
+    socket.track_frames(unread);
+    return ws;
+}
+
+// Listening sockets for the I/O contexts: inherited ones when taking over
+// (spread round robin, so io_threads changes apply on the next cold start),
+// otherwise freshly bound
+inline std::vector<boost::asio::ip::tcp::acceptor> open_listeners(
+    IoPool& pool,
+    const boost::asio::ip::tcp::endpoint& endpoint,
+    const std::optional<Handoff>& handoff)
+{
+    auto contexts = pool.io_contexts();
+    std::vector<boost::asio::ip::tcp::acceptor> acceptors;
+
+    if (handoff.has_value() && !handoff->listener_fds.empty()) {
+        for (size_t i = 0; i < handoff->listener_fds.size(); ++i) {
+            acceptors.push_back(adopt_acceptor(*contexts[i % contexts.size()], handoff->listener_fds[i]));
+        }
+    } else {
+        for (auto* ioc : contexts) {
+            acceptors.push_back(open_acceptor(*ioc, endpoint, pool.reuse_port()));
+        }
+    }
+    return acceptors;
+}
+
+// Registers handed-over subscribers with the hub, spread over the I/O
+// contexts, and calls start(ioc, ws, id) to run each one's session
+template<typename Start>
+void adopt_clients(const Handoff& handoff, IoPool& pool, WsHub& hub, Start&& start) {
+    auto contexts = pool.io_contexts();
+    for (size_t i = 0; i < handoff.client_fds.size(); ++i) {
+        auto& ioc = *contexts[i % contexts.size()];
+        auto ws = adopt_websocket(ioc, handoff.client_fds[i], handoff.client_unread[i]);
+        SlotId id = hub.add(ws, handoff.client_tiers[i], handoff.client_limits[i]);
+        hub.activate(id);
+        start(ioc, std::move(ws), id);
+    }
+}
+
+// Serves handoff requests on path for the life of the process. State must
+// provide pause_for_handoff() returning the JSON snapshot and
+// resume_after_handoff(). Connections accepted between the snapshot and exit
+// are refused and reconnect. If the handoff fails, subscribers whose reads
+// were already cancelled are closed and reconnect too.
+template<typename State>
+boost::asio::awaitable<void> serve_handoff(
+    std::string path,
+    std::shared_ptr<State> state,
+    std::vector<boost::asio::ip::tcp::acceptor>& listeners)
+{
+    namespace asio = boost::asio;
+    using local = asio::local::stream_protocol;
+
+    auto executor = co_await asio::this_coro::executor;
+
+    ::unlink(path.c_str());
+    local::acceptor acceptor(executor, local::endpoint(path));
+
+    while (true) {
+        auto conn = co_await acceptor.async_accept(asio::use_awaitable);
+        spdlog::warn("Handoff requested on {}", path);
+
+        auto snapshot = state->pause_for_handoff();
+        auto& hub = state->hub();
+
+        asio::steady_timer timer(executor);
+        auto wait_until = [&timer](auto done, int max_ms) -> asio::awaitable<bool> {
+            for (int waited = 0; !done(); waited += 10) {
+                if (waited >= max_ms) co_return false;
+                timer.expires_after(std::chrono::milliseconds(10));
+                co_await timer.async_wait(asio::use_awaitable);
+            }
+            co_return true;
+        };
+
+        co_await wait_until([&hub] { return hub.drained(); }, 2000);
+
+        // A socket must not change hands mid-frame, and this process must
+        // stop reading before the new one starts
+        hub.freeze_for_handoff();
+        if (!co_await wait_until([&hub] { return hub.writes_idle(); }, 2000)) {
+            spdlog::warn("Handoff: writes still in flight, those clients will be dropped");
+        }
+        hub.stop_reads();
+        co_await wait_until([&hub] { return hub.reads_stopped(); }, 1000);
+
+        std::vector<int> listener_fds;
+        for (auto& listener : listeners) {
+            listener_fds.push_back(::dup(listener.native_handle()));
+        }
+        auto clients = hub.handoff_clients();
+        if (clients.size() < hub.size()) {
+            spdlog::warn("Handoff: {} of {} clients busy, not handed over", hub.size() - clients.size(), hub.size());
+        }
+
+        bool handed_off = false;
+        try {
+            send_handoff(conn.native_handle(), snapshot, listener_fds, clients);
+            handed_off = co_await async_await_handoff_ack(conn, std::chrono::milliseconds(5000));
+        } catch (const std::exception& e) {
+            spdlog::error("Handoff failed: {}", e.what());
+        }
+
+        if (handed_off) {
+            spdlog::warn("Handed off {} listeners and {} clients, exiting", listener_fds.size(), clients.size());
+            spdlog::default_logger()->flush();
+            // skip destructors so nothing is closed or sent on the shared sockets
+            std::_Exit(0);
+        }
+
+        spdlog::error("Handoff not acknowledged, resuming");
+        for (int fd : listener_fds) ::close(fd);
+        for (const auto& client : clients) ::close(client.fd);
+        hub.abort_handoff();
+        state->resume_after_handoff();
+    }
+}
+
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "types.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace sim_core {
+
+// In-memory record of a run for export: every frame sent to subscribers,
+// every oracle round and every injected fault, as fixed-size rows.
+
+// Bounded append-only log keeping the most recent `capacity` rows. Rows are
+// addressed by their index since the start of the run, so a reader can page
+// through in batches while the ticker keeps appending; rows overwritten
+// before they are read are skipped. Capacity 0 records nothing.
+template<typename T>
+class HistoryLog {
+private:
+    std::vector<T> ring_;
+    size_t capacity_;
+    uint64_t end_ = 0;
+    mutable std::mutex mutex_;
+
+public:
+    explicit HistoryLog(size_t capacity) : capacity_(capacity) {}
+
+    bool enabled() const { return capacity_ > 0; }
+
+    void append(const T& row) {
+        if (capacity_ == 0) return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (ring_.size() < capacity_) {
+            ring_.push_back(row);
+        } else {
+            ring_[end_ % capacity_] = row;
+        }
+        end_++;
+    }
+
+    // Index of the oldest row still held
+    uint64_t begin() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return end_ - ring_.size();
+    }
+
+    uint64_t end() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return end_;
+    }
+
+    // Replaces out with up to max rows from index `from` (or the oldest held
+    // row, if later) and returns the index after the last row copied
+    uint64_t read(uint64_t from, size_t max, std::vector<T>& out) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        out.clear();
+        uint64_t first = end_ - ring_.size();
+        from = std::max(from, first);
+        uint64_t to = std::min<uint64_t>(end_, from + max);
+        for (uint64_t i = from; i < to; ++i) {
+            out.push_back(ring_[i % capacity_]);
+        }
+        return to;
+    }
+};
+
+// One published oracle round, before delivery faults
+struct OracleRound {
+    uint64_t ts;
+    uint64_t seq;
+    int64_t price_raw;
+    uint32_t feed;
+    uint8_t decimals;
+    PublishTrigger trigger;
+    bool stale;
+};
+
+enum class FaultKind : uint8_t {
+    Drop,
+    Duplicate,
+    Reorder
+};
+
+inline const char* fault_kind_name(FaultKind kind) {
+    switch (kind) {
+        case FaultKind::Drop: return "drop";
+        case FaultKind::Duplicate: return "duplicate";
+        case FaultKind::Reorder: return "reorder";
+    }
+    return "unknown";
+}
+
+struct FaultEvent {
+    uint64_t ts;
+    uint64_t src_seq;
+    uint32_t feed;
+    FaultKind kind;
+};
+
+class RunHistory {
+private:
+    std::vector<std::string> feeds_;
+
+public:
+    HistoryLog<PriceRecord> ticks;
+    HistoryLog<OracleRound> rounds;
+    HistoryLog<FaultEvent> faults;
+
+    // feeds names the pair of each feed index; capacity is per log
+    RunHistory(std::vector<std::string> feeds, size_t capacity)
+        : feeds_(std::move(feeds)), ticks(capacity), rounds(capacity), faults(capacity)
+    {
+        if (feeds_.size() > PriceRecord::kMaxFeeds) {
+            throw std::invalid_argument("RunHistory: too many feeds for the record's feed index");
+        }
+    }
+
+    bool enabled() const { return ticks.enabled(); }
+
+    size_t feed_count() const { return feeds_.size(); }
+
+    std::optional<uint32_t> find_feed(const std::string& pair) const {
+        auto it = std::find(feeds_.begin(), feeds_.end(), pair);
+        if (it == feeds_.end()) return std::nullopt;
+        return static_cast<uint32_t>(it - feeds_.begin());
+    }
+
+    const std::string& feed_name(uint32_t feed) const {
+        if (feed >= feeds_.size()) {
+            throw std::runtime_error("Unknown feed index " + std::to_string(feed));
+        }
+        return feeds_[feed];
+    }
+
+    void record_tick(const PriceMsg& msg, uint32_t feed) {
+        ticks.append(to_record(msg, static_cast<uint16_t>(feed)));
+    }
+
+    void record_fault(FaultKind kind, const PriceMsg& msg, uint32_t feed) {
+        faults.append(FaultEvent{msg.ts, msg.src_seq, feed, kind});
+    }
+};
+
+}
@@ -0,0 +1,537 @@
+#pragma once
+
+#include "columnar_export.hpp"
+#include "utils.hpp"
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+#include <nlohmann/json.hpp>
+
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sim_core {
+
+// Streamed HTTP endpoints over the run history:
+//
+//   /history/<ticks|rounds|faults>?format=ndjson|csv|binary&pair=&from_ms=&to_ms=
+//   /candles?interval_ms=60000&format=ndjson|csv&pair=&from_ms=&to_ms=
+//   /export/<ticks|rounds|faults>.<arrow|parquet>
+//
+// A ChunkSource encodes the next batch of rows straight out of the history
+// log on each call, and the session writes that chunk (chunked transfer
+// encoding) before asking for the next one. A response of any length holds
+// one chunk in memory, and the I/O thread runs other sessions between chunks.
+// binary is the 32-byte encode_record layout, for ticks only.
+
+class ChunkSource {
+public:
+    virtual ~ChunkSource() = default;
+    virtual const char* content_type() const = 0;
+
+    // Replaces out with the next chunk, which may be empty when a call
+    // scanned rows without output; false once the stream is done
+    virtual bool next(std::string& out) = 0;
+};
+
+enum class RowFormat : uint8_t {
+    Ndjson,
+    Csv,
+    Binary
+};
+
+struct HistoryQuery {
+    RowFormat format = RowFormat::Ndjson;
+    std::optional<uint32_t> feed;   // only this pair
+    uint64_t from_ms = 0;           // ts >= from_ms
+    uint64_t to_ms = std::numeric_limits<uint64_t>::max();  // ts < to_ms
+
+    bool matches(uint64_t ts, uint32_t feed_index) const {
+        return ts >= from_ms && ts < to_ms && (!feed.has_value() || *feed == feed_index);
+    }
+};
+
+namespace stream_detail {
+
+constexpr size_t kBatchRows = 1024;
+constexpr size_t kChunkBytes = 256 * 1024;
+constexpr uint64_t kMaxScanRows = 64 * kBatchRows;  // per next(), bounds the time per call
+
+template<typename T>
+void append_number(std::string& out, T value) {
+    char buf[32];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr);
+}
+
+inline void append_bool(std::string& out, bool value) {
+    out += value ? "true" : "false";
+}
+
+inline const char* row_content_type(RowFormat format) {
+    switch (format) {
+        case RowFormat::Ndjson: return "application/x-ndjson";
+        case RowFormat::Csv: return "text/csv";
+        case RowFormat::Binary: return "application/octet-stream";
+    }
+    return "application/octet-stream";
+}
+
+// Pair names as JSON string literals and CSV fields, by feed index
+struct PairNames {
+    std::vector<std::string> json;
+    std::vector<std::string> csv;
+
+    explicit PairNames(const RunHistory& history) {
+        for (uint32_t feed = 0; feed < history.feed_count(); ++feed) {
+            const auto& pair = history.feed_name(feed);
+            json.push_back(nlohmann::json(pair).dump());
+            bool quote = pair.find_first_of(",\"\n") != std::string::npos;
+            std::string field = pair;
+            if (quote) {
+                field.clear();
+                for (char c : pair) {
+                    if (c == '"') field += '"';
+                    field += c;
+                }
+                field = '"' + field + '"';
+            }
+            csv.push_back(std::move(field));
+        }
+    }
+};
+
+inline double price_of(int64_t raw, uint8_t decimals) {
+    return Price{raw, decimals}.to_double();
+}
+
+// Field names and values follow the WebSocket price messages
+inline const char* csv_header(const PriceRecord*) {
+    return "ts,pair,price,source,src_seq,delay_ms,stale\n";
+}
+
+inline void append_row(std::string& out, const PriceRecord& row, const PairNames& names, RowFormat format) {
+    const char* source = (row.flags & PriceRecord::kChainlink) ? "chainlink" : "dex";
+    bool stale = row.flags & PriceRecord::kStale;
+    double price = price_of(row.price_raw, row.decimals);
+
+    if (format == RowFormat::Binary) {
+        uint8_t bytes[PriceRecord::kEncodedSize];
+        encode_record(row, bytes);
+        out.append(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+    } else if (format == RowFormat::Csv) {
+        append_number(out, row.ts); out += ',';
+        out += names.csv[row.feed]; out += ',';
+        append_number(out, price); out += ',';
+        out += source; out += ',';
+        append_number(out, row.src_seq); out += ',';
+        append_number(out, row.delay_ms); out += ',';
+        append_bool(out, stale); out += '\n';
+    } else {
+        out += "{\"ts\":"; append_number(out, row.ts);
+        out += ",\"pair\":"; out += names.json[row.feed];
+        out += ",\"price\":"; append_number(out, price);
+        out += ",\"source\":\""; out += source;
+        out += "\",\"src_seq\":"; append_number(out, row.src_seq);
+        out += ",\"delay_ms\":"; append_number(out, row.delay_ms);
+        out += ",\"stale\":"; append_bool(out, stale);
+        out += "}\n";
+    }
+}
+
+inline const char* csv_header(const OracleRound*) {
+    return "ts,pair,seq,trigger,price,stale\n";
+}
+
+inline void append_row(std::string& out, const OracleRound& row, const PairNames& names, RowFormat format) {
+    double price = price_of(row.price_raw, row.decimals);
+    if (format == RowFormat::Csv) {
+        append_number(out, row.ts); out += ',';
+        out += names.csv[row.feed]; out += ',';
+        append_number(out, row.seq); out += ',';
+        out += trigger_name(row.trigger); out += ',';
+        append_number(out, price); out += ',';
+        append_bool(out, row.stale); out += '\n';
+    } else {
+        out += "{\"ts\":"; append_number(out, row.ts);
+        out += ",\"pair\":"; out += names.json[row.feed];
+        out += ",\"seq\":"; append_number(out, row.seq);
+        out += ",\"trigger\":\""; out += trigger_name(row.trigger);
+        out += "\",\"price\":"; append_number(out, price);
+        out += ",\"stale\":"; append_bool(out, row.stale);
+        out += "}\n";
+    }
+}
+
+inline const char* csv_header(const FaultEvent*) {
+    return "ts,pair,src_seq,kind\n";
+}
+
+inline void append_row(std::string& out, const FaultEvent& row, const PairNames& names, RowFormat format) {
+    if (format == RowFormat::Csv) {
+        append_number(out, row.ts); out += ',';
+        out += names.csv[row.feed]; out += ',';
+        append_number(out, row.src_seq); out += ',';
+        out += fault_kind_name(row.kind); out += '\n';
+    } else {
+        out += "{\"ts\":"; append_number(out, row.ts);
+        out += ",\"pair\":"; out += names.json[row.feed];
+        out += ",\"src_seq\":"; append_number(out, row.src_seq);
+        out += ",\"kind\":\""; out += fault_kind_name(row.kind);
+        out += "\"}\n";
+    }
+}
+
+inline uint32_t feed_of(const PriceRecord& row) { return row.feed; }
+inline uint32_t feed_of(const OracleRound& row) { return row.feed; }
+inline uint32_t feed_of(const FaultEvent& row) { return row.feed; }
+
+}
+
+// Rows of one history log recorded before the stream opened
+template<typename Row>
+class RowStream : public ChunkSource {
+private:
+    const HistoryLog<Row>& log_;
+    stream_detail::PairNames names_;
+    HistoryQuery query_;
+    uint64_t next_;
+    uint64_t end_;
+    std::vector<Row> rows_;
+    bool header_ = false;
+
+public:
+    RowStream(const RunHistory& history, const HistoryLog<Row>& log, HistoryQuery query)
+        : log_(log), names_(history), query_(query), next_(log.begin()), end_(log.end()) {}
+
+    const char* content_type() const override { return stream_detail::row_content_type(query_.format); }
+
+    bool next(std::string& out) override {
+        out.clear();
+        if (query_.format == RowFormat::Csv && !header_) {
+            out += stream_detail::csv_header(static_cast<const Row*>(nullptr));
+            header_ = true;
+        }
+        bool more = next_ < end_;
+        for (uint64_t scanned = 0; more && out.size() < stream_detail::kChunkBytes
+                                   && scanned < stream_detail::kMaxScanRows;) {
+            next_ = log_.read(next_, std::min<uint64_t>(stream_detail::kBatchRows, end_ - next_), rows_);
+            for (const auto& row : rows_) {
+                if (query_.matches(row.ts, stream_detail::feed_of(row))) {
+                    stream_detail::append_row(out, row, names_, query_.format);
+                }
+            }
+            scanned += rows_.size();
+            more = !rows_.empty() && next_ < end_;
+        }
+        if (!more) end_ = next_;
+        return more || !out.empty();
+    }
+};
+
+// OHLC candles per pair from the sent ticks, in interval_ms buckets by tick
+// ts. Duplicated frames are counted once; a late (reordered) frame for a
+// candle that has already closed is skipped.
+class CandleStream : public ChunkSource {
+private:
+    struct Candle {
+        uint64_t start_ms = 0;
+        int64_t open = 0;
+        int64_t high = 0;
+        int64_t low = 0;
+        int64_t close = 0;
+        uint64_t ticks = 0;
+        uint64_t last_seq = 0;
+        uint8_t decimals = 0;
+        bool active = false;
+    };
+
+    const HistoryLog<PriceRecord>& log_;
+    stream_detail::PairNames names_;
+    HistoryQuery query_;
+    uint64_t interval_ms_;
+    uint64_t next_;
+    uint64_t end_;
+    std::vector<PriceRecord> rows_;
+    std::vector<Candle> open_;
+    bool header_ = false;
+    bool flushed_ = false;
+
+    void emit(std::string& out, uint32_t feed, const Candle& c) const {
+        using stream_detail::append_number;
+        auto price = [&c](int64_t raw) { return stream_detail::price_of(raw, c.decimals); };
+        if (query_.format == RowFormat::Csv) {
+            append_number(out, c.start_ms); out += ',';
+            out += names_.csv[feed]; out += ',';
+            append_number(out, price(c.open)); out += ',';
+            append_number(out, price(c.high)); out += ',';
+            append_number(out, price(c.low)); out += ',';
+            append_number(out, price(c.close)); out += ',';
+            append_number(out, c.ticks); out += '\n';
+        } else {
+            out += "{\"start_ms\":"; append_number(out, c.start_ms);
+            out += ",\"pair\":"; out += names_.json[feed];
+            out += ",\"open\":"; append_number(out, price(c.open));
+            out += ",\"high\":"; append_number(out, price(c.high));
+            out += ",\"low\":"; append_number(out, price(c.low));
+            out += ",\"close\":"; append_number(out, price(c.close));
+            out += ",\"ticks\":"; append_number(out, c.ticks);
+            out += "}\n";
+        }
+    }
+
+    void add(std::string& out, const PriceRecord& row) {
+        auto& c = open_[row.feed];
+        if (c.active && row.src_seq == c.last_seq) return;
+
+        uint64_t bucket = row.ts - row.ts % interval_ms_;
+        if (c.active && bucket < c.start_ms) return;
+        if (c.active && bucket > c.start_ms) {
+            emit(out, row.feed, c);
+            c.active = false;
+        }
+        if (!c.active) {
+            c = Candle{bucket, row.price_raw, row.price_raw, row.price_raw, row.price_raw, 0, 0, row.decimals, true};
+        }
+        c.high = std::max(c.high, row.price_raw);
+        c.low = std::min(c.low, row.price_raw);
+        c.close = row.price_raw;
+        c.ticks++;
+        c.last_seq = row.src_seq;
+    }
+
+public:
+    CandleStream(const RunHistory& history, HistoryQuery query, uint64_t interval_ms)
+        : log_(history.ticks), names_(history), query_(query), interval_ms_(interval_ms),
+          next_(history.ticks.begin()), end_(history.ticks.end()), open_(history.feed_count())
+    {
+        if (interval_ms_ == 0) {
+            throw std::invalid_argument("interval_ms must be > 0");
+        }
+        if (query_.format == RowFormat::Binary) {
+            throw std::invalid_argument("candles are ndjson or csv");
+        }
+    }
+
+    const char* content_type() const override { return stream_detail::row_content_type(query_.format); }
+
+    bool next(std::string& out) override {
+        out.clear();
+        if (query_.format == RowFormat::Csv && !header_) {
+            out += "start_ms,pair,open,high,low,close,ticks\n";
+            header_ = true;
+        }
+        if (flushed_) return false;
+
+        bool more = next_ < end_;
+        for (uint64_t scanned = 0; more && out.size() < stream_detail::kChunkBytes
+                                   && scanned < stream_detail::kMaxScanRows;) {
+            next_ = log_.read(next_, std::min<uint64_t>(stream_detail::kBatchRows, end_ - next_), rows_);
+            for (const auto& row : rows_) {
+                if (row.feed < open_.size() && query_.matches(row.ts, row.feed)) add(out, row);
+            }
+            scanned += rows_.size();
+            more = !rows_.empty() && next_ < end_;
+        }
+        if (!more) {
+            for (uint32_t feed = 0; feed < open_.size(); ++feed) {
+                if (open_[feed].active) emit(out, feed, open_[feed]);
+            }
+            flushed_ = true;
+        }
+        return true;
+    }
+};
+
+// Arrow IPC or Parquet, one record batch / row group per chunk
+template<typename Row, typename Writer>
+class ExportStream : public ChunkSource {
+private:
+    const RunHistory& history_;
+    const HistoryLog<Row>& log_;
+    ExportFormat format_;
+    std::ostringstream buffer_;
+    Writer writer_{buffer_};
+    RecordBatch batch_;
+    std::vector<Row> rows_;
+    uint64_t next_;
+    uint64_t end_;
+    bool done_ = false;
+
+    static constexpr size_t kExportBatchRows = 16384;
+
+public:
+    ExportStream(const RunHistory& history, const HistoryLog<Row>& log, ExportFormat format)
+        : history_(history), log_(log), format_(format),
+          batch_(export_detail::batch_for(static_cast<const Row*>(nullptr))),
+          next_(log.begin()), end_(log.end()) {}
+
+    const char* content_type() const override { return export_content_type(format_); }
+
+    bool next(std::string& out) override {
+        if (done_) return false;
+
+        rows_.clear();
+        if (next_ < end_) {
+            next_ = log_.read(next_, std::min<uint64_t>(kExportBatchRows, end_ - next_), rows_);
+        }
+        batch_.clear();
+        if (rows_.empty()) {
+            writer_.finish(batch_);
+            done_ = true;
+        } else {
+            for (const auto& row : rows_) {
+                export_detail::append_row(batch_, row, history_);
+            }
+            writer_.write(batch_);
+        }
+
+        out = std::move(buffer_).str();
+        buffer_.str({});
+        return true;
+    }
+};
+
+namespace stream_detail {
+
+inline uint64_t parse_u64(std::string_view target, std::string_view key, uint64_t fallback) {
+    auto value = query_param(target, key);
+    if (!value.has_value()) return fallback;
+    uint64_t out = 0;
+    auto result = std::from_chars(value->data(), value->data() + value->size(), out);
+    if (result.ec != std::errc{} || result.ptr != value->data() + value->size()) {
+        throw std::invalid_argument("Bad " + std::string(key) + ": " + *value);
+    }
+    return out;
+}
+
+inline HistoryQuery parse_query(std::string_view target, const RunHistory& history) {
+    HistoryQuery query;
+    auto format = query_param(target, "format").value_or("ndjson");
+    if (format == "ndjson") query.format = RowFormat::Ndjson;
+    else if (format == "csv") query.format = RowFormat::Csv;
+    else if (format == "binary") query.format = RowFormat::Binary;
+    else throw std::invalid_argument("Unknown format: " + format);
+
+    if (auto pair = query_param(target, "pair")) {
+        query.feed = history.find_feed(*pair);
+        if (!query.feed.has_value()) {
+            throw std::invalid_argument("Unknown pair: " + *pair);
+        }
+    }
+    query.from_ms = parse_u64(target, "from_ms", query.from_ms);
+    query.to_ms = parse_u64(target, "to_ms", query.to_ms);
+    return query;
+}
+
+template<typename Row>
+std::unique_ptr<ChunkSource> open_export(const RunHistory& history, const HistoryLog<Row>& log, ExportFormat format) {
+    if (format == ExportFormat::Arrow) {
+        return std::make_unique<ExportStream<Row, ArrowStreamWriter>>(history, log, format);
+    }
+    return std::make_unique<ExportStream<Row, ParquetWriter>>(history, log, format);
+}
+
+}
+
+// Source for a streamed history endpoint, or nullptr when target is not
+// one. Throws std::invalid_argument for bad query parameters.
+inline std::unique_ptr<ChunkSource> open_history_stream(std::string_view target, const RunHistory& history) {
+    std::string_view path = target.substr(0, target.find('?'));
+
+    if (auto request = parse_export_target(path)) {
+        switch (request->table) {
+            case HistoryTable::Ticks: return stream_detail::open_export(history, history.ticks, request->format);
+            case HistoryTable::Rounds: return stream_detail::open_export(history, history.rounds, request->format);
+            case HistoryTable::Faults: return stream_detail::open_export(history, history.faults, request->format);
+        }
+    }
+
+    if (path == "/candles") {
+        auto query = stream_detail::parse_query(target, history);
+        return std::make_unique<CandleStream>(history, query, stream_detail::parse_u64(target, "interval_ms", 60000));
+    }
+
+    constexpr std::string_view prefix = "/history/";
+    if (path.substr(0, prefix.size()) != prefix) return nullptr;
+    auto table = path.substr(prefix.size());
+    if (table != "ticks" && table != "rounds" && table != "faults") return nullptr;
+
+    auto query = stream_detail::parse_query(target, history);
+    if (query.format == RowFormat::Binary && table != "ticks") {
+        throw std::invalid_argument("binary is only available for ticks");
+    }
+    switch (parse_history_table(table)) {
+        case HistoryTable::Ticks: return std::make_unique<RowStream<PriceRecord>>(history, history.ticks, query);
+        case HistoryTable::Rounds: return std::make_unique<RowStream<OracleRound>>(history, history.rounds, query);
+        case HistoryTable::Faults: return std::make_unique<RowStream<FaultEvent>>(history, history.faults, query);
+    }
+    return nullptr;
+}
+
+// Writes source as a 200 response, one HTTP chunk per next(). HTTP/1.0
+// clients get the raw bytes and the connection closed instead.
+template<typename Request>
+boost::asio::awaitable<void> async_write_chunked(
+    boost::beast::tcp_stream& stream,
+    const Request& req,
+    const char* server,
+    ChunkSource& source)
+{
+    namespace asio = boost::asio;
+    namespace http = boost::beast::http;
+
+    bool chunked = req.version() >= 11;
+    http::response<http::empty_body> res{http::status::ok, req.version()};
+    res.set(http::field::server, server);
+    res.set(http::field::content_type, source.content_type());
+    res.set(http::field::access_control_allow_origin, "*");
+    res.keep_alive(chunked && req.keep_alive());
+    res.chunked(chunked);
+
+    http::response_serializer<http::empty_body> serializer{res};
+    stream.expires_after(std::chrono::seconds(30));
+    co_await http::async_write_header(stream, serializer, asio::use_awaitable);
+
+    std::string chunk;
+    while (source.next(chunk)) {
+        if (chunk.empty()) {
+            // nothing matched in this stretch of history; let other work run
+            co_await asio::post(stream.get_executor(), asio::use_awaitable);
+            continue;
+        }
+        stream.expires_after(std::chrono::seconds(30));
+        if (chunked) {
+            co_await asio::async_write(stream, http::make_chunk(asio::buffer(chunk)), asio::use_awaitable);
+        } else {
+            co_await asio::async_write(stream, asio::buffer(chunk), asio::use_awaitable);
+        }
+    }
+    if (chunked) {
+        co_await asio::async_write(stream, http::make_chunk_last(), asio::use_awaitable);
+    }
+}
+
+template<typename Request>
+boost::beast::http::response<boost::beast::http::string_body> bad_request(
+    const Request& req, const char* server, const std::string& message)
+{
+    namespace http = boost::beast::http;
+    http::response<http::string_body> res{http::status::bad_request, req.version()};
+    res.set(http::field::server, server);
+    res.set(http::field::content_type, "text/plain");
+    res.keep_alive(req.keep_alive());
+    res.body() = message;
+    res.prepare_payload();
+    return res;
+}
+
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "det_math.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+namespace sim_core {
+
+// Importance-sampling tilt toward crashes. With a tilt set, engines draw
+// their shocks from a measure under which crashes are common and keep the
+// log likelihood ratio log(dP/dQ) of the path so far. Weighting each path by
+// exp(log_weight) gives unbiased estimates under the untilted model.
+struct CrashTilt {
+    double crash_drop = 0.0;             // fractional drop made typical, 0 = no drift tilt
+    uint64_t horizon_ms = 3'600'000;     // ...over this horizon
+    double jump_intensity_scale = 1.0;   // multiplies the per-step jump probability
+    double jump_mean_shift = 0.0;        // added to the mean log jump size
+
+    bool enabled() const {
+        return crash_drop > 0.0 || jump_intensity_scale != 1.0 || jump_mean_shift != 0.0;
+    }
+
+    // Annualized log-drift added so the expected log move over the horizon
+    // is log(1 - crash_drop)
+    double drift_shift() const {
+        if (crash_drop <= 0.0) return 0.0;
+        double horizon_years = static_cast<double>(horizon_ms) / 1000.0 / 86400.0 / 365.25;
+        return det_log1p(-crash_drop) / horizon_years;
+    }
+};
+
+// Cuts a live engine's endless stream into paths of a fixed number of steps,
+// so its likelihood ratio is a per-path weight: once a path's last step is
+// taken, the next step restarts from the initial state with a fresh weight.
+struct PathSplit {
+    uint64_t steps = 0;  // steps per path, 0 = one endless path
+    uint64_t step = 0;   // steps taken in the current path
+    uint64_t path = 0;   // index of the current path
+
+    bool enabled() const { return steps > 0; }
+    bool complete() const { return steps > 0 && step == steps; }
+
+    // Call before each step; true if the engine must restart first
+    bool begin_step() {
+        if (steps == 0) return false;
+        bool restart = step == steps;
+        if (restart) {
+            step = 0;
+            path++;
+        }
+        step++;
+        return restart;
+    }
+
+    // Resumes a saved position; steps stays as configured
+    void restore(uint64_t saved_path, uint64_t saved_step) {
+        if (steps == 0) return;
+        path = saved_path;
+        step = std::min(saved_step, steps);
+    }
+};
+
+// Per-engine tilted shock source and likelihood ratio accumulator. Normal
+// shocks are shifted by a constant mean (so each step contributes
+// -theta*x + theta^2/2), the Bernoulli jump decision uses a scaled
+// probability (p/q or (1-p)/(1-q)), and the jump size is shifted in units of
+// its own standard deviation. Without a tilt every call is the identity.
+class LikelihoodRatio {
+private:
+    static constexpr double kMaxJumpProbability = 0.5;
+
+    double theta_ = 0.0;
+    double jump_p_ = 0.0;
+    double jump_q_ = 0.0;
+    double jump_eta_ = 0.0;
+    double log_weight_ = 0.0;
+    bool active_ = false;
+
+    static double shift(double z, double by, double& log_weight) {
+        double x = z + by;
+        log_weight += -by * x + 0.5 * by * by;
+        return x;
+    }
+
+public:
+    LikelihoodRatio() = default;
+
+    // step_stddev is the per-step standard deviation of the log-price
+    // diffusion, jump_prob the untilted per-step jump probability
+    LikelihoodRatio(const CrashTilt& tilt, double dt_years, double step_stddev,
+                    double jump_prob, double jump_sigma)
+        : jump_p_(jump_prob), jump_q_(jump_prob), active_(tilt.enabled())
+    {
+        if (!active_) return;
+        if (tilt.jump_intensity_scale <= 0.0) {
+            throw std::runtime_error("tilt_jump_scale must be > 0");
+        }
+        if (tilt.jump_mean_shift != 0.0 && jump_sigma <= 0.0) {
+            throw std::runtime_error("tilt_jump_mean_shift needs jump_sigma > 0");
+        }
+
+        if (step_stddev > 0.0) {
+            theta_ = tilt.drift_shift() * dt_years / step_stddev;
+        }
+        if (jump_prob > 0.0) {
+            jump_q_ = std::min(jump_prob * tilt.jump_intensity_scale,
+                               std::max(kMaxJumpProbability, jump_prob));
+        }
+        if (jump_sigma > 0.0) {
+            jump_eta_ = tilt.jump_mean_shift / jump_sigma;
+        }
+    }
+
+    bool active() const { return active_; }
+    double log_weight() const { return log_weight_; }
+    void reset() { log_weight_ = 0.0; }
+    void restore(double log_weight) { log_weight_ = log_weight; }
+
+    // Maps a standard normal draw to the tilted diffusion shock
+    double diffusion(double z) {
+        return theta_ == 0.0 ? z : shift(z, theta_, log_weight_);
+    }
+
+    double jump_probability() const { return jump_q_; }
+
+    void jump_decision(bool jumped) {
+        if (jump_q_ == jump_p_) return;
+        log_weight_ += jumped
+            ? det_log(jump_p_ / jump_q_)
+            : det_log1p(-jump_p_) - det_log1p(-jump_q_);
+    }
+
+    // Maps a standard normal draw to the tilted standardized jump size
+    double jump_size(double z) {
+        return jump_eta_ == 0.0 ? z : shift(z, jump_eta_, log_weight_);
+    }
+};
+
+}
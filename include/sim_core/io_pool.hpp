@@ -0,0 +1,97 @@
+#pragma once
+
+#include <boost/asio.hpp>
+
+#include <cerrno>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+
+namespace sim_core {
+
+// Sets SO_REUSEPORT directly; Asio has no public option for it. Throws
+// boost::system::system_error like acceptor.set_option would.
+inline void set_reuse_port(boost::asio::ip::tcp::acceptor& acceptor) {
+    int on = 1;
+    if (::setsockopt(acceptor.native_handle(), SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0) {
+        throw boost::system::system_error(errno, boost::system::system_category(), "setsockopt(SO_REUSEPORT)");
+    }
+}
+
+// Listening acceptor; with reuse_port several acceptors (one per thread) can
+// bind the same endpoint and the kernel spreads new connections across them.
+inline boost::asio::ip::tcp::acceptor open_acceptor(
+    boost::asio::io_context& ioc,
+    const boost::asio::ip::tcp::endpoint& endpoint,
+    bool reuse_port)
+{
+    boost::asio::ip::tcp::acceptor acceptor(ioc);
+    acceptor.open(endpoint.protocol());
+    acceptor.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
+    if (reuse_port) {
+        set_reuse_port(acceptor);
+    }
+    acceptor.bind(endpoint);
+    acceptor.listen(boost::asio::socket_base::max_listen_connections);
+    return acceptor;
+}
+
+// One single-threaded io_context per thread. With io_threads == 1 the ticker
+// and all sessions share one context, as before. With io_threads > 1 the
+// ticker keeps context 0 to itself and each of the io_threads I/O contexts
+// gets its own SO_REUSEPORT acceptor, so handshakes run in parallel without
+// delaying ticks.
+class IoPool {
+private:
+    std::vector<std::unique_ptr<boost::asio::io_context>> contexts_;
+    std::vector<std::thread> threads_;
+
+public:
+    explicit IoPool(uint32_t io_threads) {
+        size_t count = io_threads > 1 ? io_threads + 1 : 1;
+        for (size_t i = 0; i < count; ++i) {
+            contexts_.push_back(std::make_unique<boost::asio::io_context>(1));
+        }
+    }
+
+    ~IoPool() {
+        stop();
+        for (auto& t : threads_) {
+            if (t.joinable()) t.join();
+        }
+    }
+
+    boost::asio::io_context& ticker_context() { return *contexts_.front(); }
+
+    // Contexts that accept connections
+    std::vector<boost::asio::io_context*> io_contexts() {
+        std::vector<boost::asio::io_context*> out;
+        for (size_t i = contexts_.size() > 1 ? 1 : 0; i < contexts_.size(); ++i) {
+            out.push_back(contexts_[i].get());
+        }
+        return out;
+    }
+
+    bool reuse_port() const { return contexts_.size() > 1; }
+
+    // Runs every context, context 0 on the calling thread; returns when all stop
+    void run() {
+        for (size_t i = 1; i < contexts_.size(); ++i) {
+            threads_.emplace_back([ctx = contexts_[i].get()] { ctx->run(); });
+        }
+        contexts_.front()->run();
+        for (auto& t : threads_) {
+            t.join();
+        }
+        threads_.clear();
+    }
+
+    void stop() {
+        for (auto& ctx : contexts_) {
+            ctx->stop();
+        }
+    }
+};
+
+}
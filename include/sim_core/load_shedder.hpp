@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+namespace sim_core {
+
+// Degradation levels, in escalation order.
+// Degraded: conflate lower tiers, batch overdue ticks, per-tick logs off.
+// Shedding: additionally disconnect and refuse dashboard-tier clients.
+enum class LoadMode : uint8_t {
+    Normal,
+    Degraded,
+    Shedding
+};
+
+inline const char* load_mode_name(LoadMode mode) {
+    switch (mode) {
+        case LoadMode::Normal: return "normal";
+        case LoadMode::Degraded: return "degraded";
+        case LoadMode::Shedding: return "shedding";
+    }
+    return "unknown";
+}
+
+struct LoadShedConfig {
+    double degrade_lag_ms;
+    double shed_lag_ms;
+    size_t degrade_backlog;
+    size_t shed_backlog;
+    uint32_t recover_samples;  // consecutive calm samples before stepping down
+};
+
+// Picks a LoadMode from ticker lag (how late tick timers fire) and send
+// backlog. Lag is smoothed with an EWMA. Escalation is immediate; stepping
+// down needs recover_samples consecutive samples below half the thresholds
+// of the current level, one level at a time, so the mode does not flap.
+class LoadShedder {
+private:
+    static constexpr double kLagAlpha = 0.2;
+    static constexpr double kRecoverRatio = 0.5;
+
+    LoadShedConfig config_;
+    LoadMode mode_ = LoadMode::Normal;
+    double lag_ewma_ms_ = 0.0;
+    double last_lag_ms_ = 0.0;
+    size_t last_backlog_ = 0;
+    uint32_t calm_samples_ = 0;
+    uint64_t transitions_ = 0;
+
+    LoadMode pressure(double scale) const {
+        if (lag_ewma_ms_ >= config_.shed_lag_ms * scale ||
+            static_cast<double>(last_backlog_) >= static_cast<double>(config_.shed_backlog) * scale) {
+            return LoadMode::Shedding;
+        }
+        if (lag_ewma_ms_ >= config_.degrade_lag_ms * scale ||
+            static_cast<double>(last_backlog_) >= static_cast<double>(config_.degrade_backlog) * scale) {
+            return LoadMode::Degraded;
+        }
+        return LoadMode::Normal;
+    }
+
+public:
+    explicit LoadShedder(LoadShedConfig config)
+        : config_(config)
+    {}
+
+    // Feeds one sample; returns true when the mode changed
+    bool update(double lag_ms, size_t backlog) {
+        last_lag_ms_ = std::max(lag_ms, 0.0);
+        last_backlog_ = backlog;
+        lag_ewma_ms_ += kLagAlpha * (last_lag_ms_ - lag_ewma_ms_);
+
+        LoadMode target = pressure(1.0);
+        if (target > mode_) {
+            mode_ = target;
+            calm_samples_ = 0;
+            transitions_++;
+            return true;
+        }
+
+        if (mode_ != LoadMode::Normal && pressure(kRecoverRatio) < mode_) {
+            if (++calm_samples_ >= config_.recover_samples) {
+                mode_ = static_cast<LoadMode>(static_cast<uint8_t>(mode_) - 1);
+                calm_samples_ = 0;
+                transitions_++;
+                return true;
+            }
+        } else {
+            calm_samples_ = 0;
+        }
+        return false;
+    }
+
+    LoadMode mode() const { return mode_; }
+    double lag_ms() const { return lag_ewma_ms_; }
+
+    std::string to_prometheus() const {
+        std::ostringstream oss;
+
+        oss << "# HELP sim_load_mode Load shedding level (0 normal, 1 degraded, 2 shedding)\n";
+        oss << "# TYPE sim_load_mode gauge\n";
+        oss << "sim_load_mode{mode=\"" << load_mode_name(mode_) << "\"} " << static_cast<int>(mode_) << "\n\n";
+
+        oss << "# HELP ticker_lag_ms Smoothed lateness of tick timers\n";
+        oss << "# TYPE ticker_lag_ms gauge\n";
+        oss << "ticker_lag_ms " << lag_ewma_ms_ << "\n\n";
+
+        oss << "# HELP sim_load_mode_transitions Load mode changes since start\n";
+        oss << "# TYPE sim_load_mode_transitions counter\n";
+        oss << "sim_load_mode_transitions " << transitions_ << "\n\n";
+
+        return oss.str();
+    }
+};
+
+}
@@ -11,13 +11,27 @@ public:
     std::atomic<uint64_t> price_ticks_generated{0};
     std::atomic<uint64_t> ws_frames_sent{0};
     std::atomic<uint64_t> ws_frames_dropped{0};
+    std::atomic<uint64_t> ws_loss_bursts{0};
     std::atomic<uint64_t> ws_frames_duplicated{0};
+    std::atomic<uint64_t> ws_frames_reordered{0};
+    std::atomic<uint64_t> ws_frames_conflated{0};
+    std::atomic<uint64_t> ws_clients_shed{0};
+    std::atomic<uint64_t> ws_pings_sent{0};
+    std::atomic<uint64_t> ws_idle_evictions{0};
+    std::atomic<uint64_t> ws_sends_throttled{0};
 
     void reset() {
         price_ticks_generated = 0;
         ws_frames_sent = 0;
         ws_frames_dropped = 0;
+        ws_loss_bursts = 0;
         ws_frames_duplicated = 0;
+        ws_frames_reordered = 0;
+        ws_frames_conflated = 0;
+        ws_clients_shed = 0;
+        ws_pings_sent = 0;
+        ws_idle_evictions = 0;
+        ws_sends_throttled = 0;
     }
 
     std::string to_prometheus() const {
@@ -35,10 +49,38 @@ public:
         oss << "# TYPE ws_frames_dropped counter\n";
         oss << "ws_frames_dropped " << ws_frames_dropped.load() << "\n\n";
 
+        oss << "# HELP ws_loss_bursts Gilbert-Elliott transitions into the bad (bursty loss) state\n";
+        oss << "# TYPE ws_loss_bursts counter\n";
+        oss << "ws_loss_bursts " << ws_loss_bursts.load() << "\n\n";
+
         oss << "# HELP ws_frames_duplicated Total WebSocket frames duplicated\n";
         oss << "# TYPE ws_frames_duplicated counter\n";
         oss << "ws_frames_duplicated " << ws_frames_duplicated.load() << "\n\n";
 
+        oss << "# HELP ws_frames_reordered Total WebSocket frames held back and sent out of order\n";
+        oss << "# TYPE ws_frames_reordered counter\n";
+        oss << "ws_frames_reordered " << ws_frames_reordered.load() << "\n\n";
+
+        oss << "# HELP ws_frames_conflated Queued frames replaced by a newer frame for a lower-tier subscriber\n";
+        oss << "# TYPE ws_frames_conflated counter\n";
+        oss << "ws_frames_conflated " << ws_frames_conflated.load() << "\n\n";
+
+        oss << "# HELP ws_clients_shed Dashboard clients disconnected or refused while shedding load\n";
+        oss << "# TYPE ws_clients_shed counter\n";
+        oss << "ws_clients_shed " << ws_clients_shed.load() << "\n\n";
+
+        oss << "# HELP ws_pings_sent Keepalive pings sent to quiet subscribers\n";
+        oss << "# TYPE ws_pings_sent counter\n";
+        oss << "ws_pings_sent " << ws_pings_sent.load() << "\n\n";
+
+        oss << "# HELP ws_idle_evictions Subscribers disconnected after the idle timeout\n";
+        oss << "# TYPE ws_idle_evictions counter\n";
+        oss << "ws_idle_evictions " << ws_idle_evictions.load() << "\n\n";
+
+        oss << "# HELP ws_sends_throttled Sends deferred by a subscriber's bandwidth limit\n";
+        oss << "# TYPE ws_sends_throttled counter\n";
+        oss << "ws_sends_throttled " << ws_sends_throttled.load() << "\n\n";
+
         return oss.str();
     }
 };
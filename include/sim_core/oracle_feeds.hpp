@@ -0,0 +1,285 @@
+#pragma once
+
+#include "engine_factory.hpp"
+#include "rng.hpp"
+#include "fixed_point.hpp"
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace sim_core {
+
+// Chainlink-style trigger rule on fixed-point prices; see deviation_band
+inline PublishTrigger should_publish(
+    Price current,
+    std::optional<Price> last_published,
+    uint32_t deviation_bps,
+    uint64_t elapsed_ms,
+    uint64_t heartbeat_ms)
+{
+    if (!last_published.has_value()) {
+        return PublishTrigger::First;
+    }
+    if (deviation_exceeded(current.raw, last_published->raw, deviation_bps)) {
+        return PublishTrigger::Deviation;
+    }
+    if (elapsed_ms >= heartbeat_ms) {
+        return PublishTrigger::Heartbeat;
+    }
+    return PublishTrigger::None;
+}
+
+// Batched form of deviation_exceeded over SoA arrays, with each feed's band
+// precomputed at publish time. Branch-free integer compares so the compiler
+// vectorizes it; a band of 0 (never published) always fires.
+inline void deviation_mask(
+    const int64_t* current,
+    const int64_t* last_published,
+    const int64_t* band,
+    uint8_t* mask,
+    size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        int64_t diff = current[i] - last_published[i];
+        int64_t magnitude = diff < 0 ? -diff : diff;
+        mask[i] = magnitude >= band[i];
+    }
+}
+
+// Hosts many oracle feeds driven by one timer heap. Hot per-feed state is
+// kept as parallel arrays so that all feeds due at the same instant are
+// stepped and then checked for deviation in one batched pass.
+class OracleFeedSet {
+public:
+    struct Publish {
+        uint32_t feed;
+        PublishTrigger trigger;
+        uint64_t seq;
+        Price price;
+        bool stale;
+        std::optional<double> log_weight;
+        std::optional<uint64_t> path;
+        bool path_end;
+    };
+
+private:
+    struct Timer {
+        uint64_t due_ms;
+        uint32_t feed;
+
+        bool operator>(const Timer& other) const {
+            return due_ms > other.due_ms || (due_ms == other.due_ms && feed > other.feed);
+        }
+    };
+
+    std::vector<std::string> pairs_;
+    std::vector<EngineVariant> engines_;
+
+    std::vector<int64_t> current_;
+    std::vector<int64_t> last_published_;
+    std::vector<int64_t> band_;
+    std::vector<uint32_t> deviation_bps_;
+    std::vector<uint8_t> decimals_;
+    std::vector<uint8_t> published_;
+    std::vector<uint64_t> heartbeat_ms_;
+    std::vector<uint64_t> last_publish_ms_;
+    std::vector<uint64_t> last_poll_ms_;
+    std::vector<uint64_t> seq_;
+
+    Range<uint64_t> poll_ms_;
+    uint64_t stale_after_ms_;
+    std::mt19937_64 rng_;
+    std::vector<Timer> heap_;
+    uint64_t polled_ms_ = 0;
+
+    std::vector<uint32_t> batch_;
+    std::vector<int64_t> batch_current_;
+    std::vector<int64_t> batch_last_;
+    std::vector<int64_t> batch_band_;
+    std::vector<uint8_t> batch_mask_;
+    std::vector<Publish> publishes_;
+
+    void schedule(uint32_t feed, uint64_t due_ms) {
+        heap_.push_back(Timer{due_ms, feed});
+        std::push_heap(heap_.begin(), heap_.end(), std::greater<Timer>());
+    }
+
+public:
+    OracleFeedSet(Range<uint64_t> poll_ms, uint64_t stale_after_ms, std::mt19937_64 rng)
+        : poll_ms_(poll_ms),
+          stale_after_ms_(stale_after_ms),
+          rng_(std::move(rng))
+    {}
+
+    uint32_t add_feed(std::string pair, EngineVariant engine, uint32_t deviation_bps,
+                      uint64_t heartbeat_ms, uint64_t now_ms) {
+        auto feed = static_cast<uint32_t>(pairs_.size());
+
+        auto start = sim_core::current_price(engine);
+        current_.push_back(start.raw);
+        decimals_.push_back(start.decimals);
+        pairs_.push_back(std::move(pair));
+        engines_.push_back(std::move(engine));
+        last_published_.push_back(0);
+        band_.push_back(0);
+        published_.push_back(0);
+        deviation_bps_.push_back(deviation_bps);
+        heartbeat_ms_.push_back(heartbeat_ms);
+        last_publish_ms_.push_back(now_ms);
+        last_poll_ms_.push_back(now_ms);
+        seq_.push_back(0);
+
+        schedule(feed, now_ms + sample_range(rng_, poll_ms_.min, poll_ms_.max));
+        return feed;
+    }
+
+    size_t size() const { return pairs_.size(); }
+
+    const std::string& pair(uint32_t feed) const { return pairs_[feed]; }
+
+    Price current_price(uint32_t feed) const { return Price{current_[feed], decimals_[feed]}; }
+
+    std::optional<Price> last_published_price(uint32_t feed) const {
+        if (!published_[feed]) return std::nullopt;
+        return Price{last_published_[feed], decimals_[feed]};
+    }
+
+    uint32_t deviation_bps(uint32_t feed) const { return deviation_bps_[feed]; }
+
+    uint64_t next_seq(uint32_t feed) const { return seq_[feed]; }
+
+    // Per-feed engine, sequence, deviation reference and schedule plus the
+    // poll generator, with times relative to the last poll, for a handoff
+    nlohmann::json save() const {
+        std::vector<uint64_t> due(pairs_.size(), polled_ms_);
+        for (const auto& timer : heap_) {
+            due[timer.feed] = timer.due_ms;
+        }
+
+        auto feeds = nlohmann::json::array();
+        for (uint32_t feed = 0; feed < pairs_.size(); ++feed) {
+            feeds.push_back({
+                {"pair", pairs_[feed]},
+                {"engine", save_engine(engines_[feed])},
+                {"seq", seq_[feed]},
+                {"last_published_raw", published_[feed] ? nlohmann::json(last_published_[feed]) : nlohmann::json(nullptr)},
+                {"since_publish_ms", polled_ms_ - last_publish_ms_[feed]},
+                {"since_poll_ms", polled_ms_ - last_poll_ms_[feed]},
+                {"due_in_ms", due[feed] > polled_ms_ ? due[feed] - polled_ms_ : 0}
+            });
+        }
+        return nlohmann::json{{"rng", save_rng(rng_)}, {"feeds", feeds}};
+    }
+
+    // Resumes the saved feeds (matched by pair) as if their last poll was at
+    // now_ms; feeds missing from saved keep their fresh state. Returns the
+    // number of feeds resumed.
+    size_t restore(const nlohmann::json& saved, uint64_t now_ms) {
+        std::unordered_map<std::string, uint32_t> by_pair;
+        for (uint32_t feed = 0; feed < pairs_.size(); ++feed) {
+            by_pair[pairs_[feed]] = feed;
+        }
+
+        std::vector<uint64_t> due(pairs_.size(), now_ms);
+        for (const auto& timer : heap_) {
+            due[timer.feed] = timer.due_ms;
+        }
+
+        size_t resumed = 0;
+        for (const auto& entry : saved.at("feeds")) {
+            auto it = by_pair.find(entry.at("pair").get<std::string>());
+            if (it == by_pair.end()) continue;
+            uint32_t feed = it->second;
+
+            restore_engine(engines_[feed], entry.at("engine"));
+            current_[feed] = sim_core::current_price(engines_[feed]).raw;
+            seq_[feed] = entry.at("seq").get<uint64_t>();
+            if (!entry.at("last_published_raw").is_null()) {
+                last_published_[feed] = entry["last_published_raw"].get<int64_t>();
+                band_[feed] = deviation_band(last_published_[feed], deviation_bps_[feed]);
+                published_[feed] = 1;
+            }
+            // unsigned wraparound keeps now_ms - last_*_ms equal to the saved gap
+            last_publish_ms_[feed] = now_ms - entry.at("since_publish_ms").get<uint64_t>();
+            last_poll_ms_[feed] = now_ms - entry.at("since_poll_ms").get<uint64_t>();
+            due[feed] = now_ms + entry.at("due_in_ms").get<uint64_t>();
+            resumed++;
+        }
+        restore_rng(rng_, saved.at("rng").get<std::string>());
+
+        heap_.clear();
+        for (uint32_t feed = 0; feed < pairs_.size(); ++feed) {
+            schedule(feed, due[feed]);
+        }
+        polled_ms_ = now_ms;
+        return resumed;
+    }
+
+    uint64_t next_due_ms() const {
+        return heap_.empty() ? UINT64_MAX : heap_.front().due_ms;
+    }
+
+    // Steps every feed whose poll timer is due, evaluates deviation for the
+    // batch at once, then heartbeats, and marks triggered feeds published.
+    const std::vector<Publish>& poll(uint64_t now_ms) {
+        polled_ms_ = now_ms;
+        batch_.clear();
+        while (!heap_.empty() && heap_.front().due_ms <= now_ms) {
+            std::pop_heap(heap_.begin(), heap_.end(), std::greater<Timer>());
+            batch_.push_back(heap_.back().feed);
+            heap_.pop_back();
+        }
+
+        size_t n = batch_.size();
+        batch_current_.resize(n);
+        batch_last_.resize(n);
+        batch_band_.resize(n);
+        batch_mask_.resize(n);
+
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t feed = batch_[i];
+            current_[feed] = step(engines_[feed]);
+            batch_current_[i] = current_[feed];
+            batch_last_[i] = last_published_[feed];
+            batch_band_[i] = band_[feed];
+        }
+
+        deviation_mask(batch_current_.data(), batch_last_.data(), batch_band_.data(), batch_mask_.data(), n);
+
+        publishes_.clear();
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t feed = batch_[i];
+            bool stale = now_ms - last_poll_ms_[feed] > stale_after_ms_;
+            last_poll_ms_[feed] = now_ms;
+
+            PublishTrigger trigger = PublishTrigger::None;
+            if (batch_mask_[i]) {
+                trigger = published_[feed] ? PublishTrigger::Deviation : PublishTrigger::First;
+            } else if (now_ms - last_publish_ms_[feed] >= heartbeat_ms_[feed] || path_complete(engines_[feed])) {
+                // a live path's last step is always published so its final weight is seen
+                trigger = PublishTrigger::Heartbeat;
+            }
+
+            if (trigger != PublishTrigger::None) {
+                last_published_[feed] = current_[feed];
+                band_[feed] = deviation_band(current_[feed], deviation_bps_[feed]);
+                published_[feed] = 1;
+                last_publish_ms_[feed] = now_ms;
+                publishes_.push_back(Publish{
+                    feed, trigger, seq_[feed]++, current_price(feed), stale, log_weight(engines_[feed]),
+                    path(engines_[feed]), path_complete(engines_[feed])
+                });
+            }
+
+            schedule(feed, now_ms + sample_range(rng_, poll_ms_.min, poll_ms_.max));
+        }
+
+        return publishes_;
+    }
+};
+
+}
@@ -0,0 +1,220 @@
+#pragma once
+
+#include "types.hpp"
+#include "importance_sampling.hpp"
+#include "det_math.hpp"
+#include "rng.hpp"
+#include <optional>
+#include <random>
+#include <cmath>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace sim_core {
+
+// Mean-reverting (Ornstein-Uhlenbeck) engine for pegged assets.
+// Log price reverts to log(peg) and is stepped with the exact discretization,
+// so one normal draw and one exp per tick, same as GBM. Optional Poisson
+// depeg jumps shock the log price, which then reverts back to the peg.
+class OuPriceEngine final {
+private:
+    std::string pair_;
+    double initial_price_;
+    double price_;
+    double log_price_;
+    double log_peg_;
+    double decay_;
+    double step_stddev_;
+    double jump_prob_;
+    double jump_mu_;
+    double jump_sigma_;
+    uint8_t decimals_;
+    std::mt19937_64 rng_;
+    DetNormal normal_;
+    DetUniform uniform_;
+    std::vector<double> scratch_;
+    LikelihoodRatio likelihood_;
+    PathSplit paths_;
+
+    double step_log_price() {
+        return step_log_price(normal_(rng_));
+    }
+
+    double step_log_price(double z) {
+        if (paths_.begin_step()) {
+            log_price_ = det_log(initial_price_);
+            likelihood_.reset();
+        }
+        log_price_ = log_peg_ + (log_price_ - log_peg_) * decay_ + step_stddev_ * likelihood_.diffusion(z);
+
+        if (jump_prob_ > 0.0) {
+            bool jumped = uniform_(rng_) < likelihood_.jump_probability();
+            likelihood_.jump_decision(jumped);
+            if (jumped) {
+                log_price_ += jump_mu_ + jump_sigma_ * likelihood_.jump_size(normal_(rng_));
+            }
+        }
+        return log_price_;
+    }
+
+public:
+    // theta and sigma are annualized; jump_lambda is in events per hour
+    OuPriceEngine(
+        std::string pair,
+        double initial_price,
+        double peg,
+        double theta,
+        double sigma,
+        double jump_lambda,
+        double jump_mu,
+        double jump_sigma,
+        uint64_t tick_interval_ms,
+        std::mt19937_64 rng,
+        uint8_t decimals = kDefaultPriceDecimals,
+        const CrashTilt& tilt = {}
+    ) : pair_(std::move(pair)),
+        initial_price_(initial_price),
+        price_(initial_price),
+        log_price_(det_log(initial_price)),
+        log_peg_(det_log(peg)),
+        jump_mu_(jump_mu),
+        jump_sigma_(jump_sigma),
+        decimals_(decimals),
+        rng_(std::move(rng)),
+        normal_(0.0, 1.0),
+        uniform_(0.0, 1.0)
+    {
+        double dt = static_cast<double>(tick_interval_ms) / 1000.0 / 86400.0 / 365.25;
+
+        decay_ = det_exp(-theta * dt);
+        step_stddev_ = theta > 0.0
+            ? sigma * std::sqrt((1.0 - det_exp(-2.0 * theta * dt)) / (2.0 * theta))
+            : sigma * std::sqrt(dt);
+
+        double dt_hours = static_cast<double>(tick_interval_ms) / 1000.0 / 3600.0;
+        jump_prob_ = jump_lambda > 0.0 ? 1.0 - det_exp(-jump_lambda * dt_hours) : 0.0;
+        likelihood_ = LikelihoodRatio(tilt, dt, step_stddev_, jump_prob_, jump_sigma_);
+    }
+
+    int64_t step() {
+        return step_normal(normal_(rng_));
+    }
+
+    // Steps with a caller-supplied diffusion shock (path_generator.hpp);
+    // depeg jumps still come from the engine's own generator
+    int64_t step_normal(double z) {
+        price_ = std::max(det_exp(step_log_price(z)), 0.01);
+        return Price::from_double(price_, decimals_).raw;
+    }
+
+    // Batch form of step(): the log-price recursion and draws are serial,
+    // the exp loop is independent per tick and vectorizable.
+    void next_ticks(std::span<int64_t> out) {
+        scratch_.resize(out.size());
+        for (auto& y : scratch_) {
+            y = step_log_price();
+        }
+        for (auto& y : scratch_) {
+            y = det_exp(y);
+        }
+
+        double scale = static_cast<double>(pow10_i64(decimals_));
+        for (size_t i = 0; i < out.size(); ++i) {
+            price_ = std::max(scratch_[i], 0.01);
+            out[i] = scaled_to_raw(price_ * scale);
+        }
+    }
+
+    PriceMsg next_tick(
+        uint64_t ts,
+        uint64_t seq,
+        SourceKind source,
+        uint32_t delay_ms,
+        bool stale
+    ) {
+        return PriceMsg{
+            ts,
+            pair_,
+            Price{step(), decimals_},
+            source,
+            seq,
+            delay_ms,
+            stale,
+            log_weight(),
+            path(),
+            paths_.complete()
+        };
+    }
+
+    // Log likelihood ratio of the path since construction, the last reset
+    // or the path's restart, set only while importance sampling
+    std::optional<double> log_weight() const {
+        if (!likelihood_.active()) return std::nullopt;
+        return likelihood_.log_weight();
+    }
+
+    void reset_log_weight() { likelihood_.reset(); }
+
+    // Restarts from the initial price with a fresh weight every steps steps
+    // (see PathSplit); 0 keeps one endless path
+    void split_paths(uint64_t steps) { paths_ = PathSplit{steps}; }
+
+    // Index of the current path while split
+    std::optional<uint64_t> path() const {
+        if (!paths_.enabled()) return std::nullopt;
+        return paths_.path;
+    }
+
+    bool path_complete() const { return paths_.complete(); }
+
+    // Full stepping state (price, generator, weight and path position) for a
+    // handoff; restore() continues the exact stream on an engine built from
+    // the same config
+    nlohmann::json save() const {
+        nlohmann::json j{
+            {"model", "ou"},
+            {"price", price_},
+            {"price_raw", current_price().raw},
+            {"decimals", decimals_},
+            {"rng", save_rng(rng_)},
+            {"log_weight", likelihood_.log_weight()},
+            {"path", paths_.path},
+            {"path_step", paths_.step}
+        };
+        j["log_price"] = log_price_;
+        return j;
+    }
+
+    void restore(const nlohmann::json& j) {
+        if (j.at("model").get<std::string>() != "ou") {
+            throw std::runtime_error("Saved " + j["model"].get<std::string>() + " engine for " + pair_ +
+                " does not match the configured ou engine");
+        }
+        if (j.at("decimals").get<uint8_t>() != decimals_) {
+            throw std::runtime_error("Saved engine for " + pair_ + " has " +
+                std::to_string(j["decimals"].get<int>()) + " price decimals, config has " +
+                std::to_string(decimals_));
+        }
+        price_ = j.at("price").get<double>();
+        log_price_ = j.at("log_price").get<double>();
+        restore_rng(rng_, j.at("rng").get<std::string>());
+        likelihood_.restore(j.at("log_weight").get<double>());
+        paths_.restore(j.at("path").get<uint64_t>(), j.at("path_step").get<uint64_t>());
+    }
+
+    Price current_price() const {
+        return Price::from_double(price_, decimals_);
+    }
+
+    const std::string& pair() const {
+        return pair_;
+    }
+
+    uint8_t decimals() const {
+        return decimals_;
+    }
+};
+
+}
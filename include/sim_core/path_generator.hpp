@@ -0,0 +1,310 @@
+#pragma once
+
+#include "engine_factory.hpp"
+#include "det_math.hpp"
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace sim_core {
+
+// Offline Monte Carlo over the engines. A PathGenerator hands out one
+// vector of per-step standard normal shocks per path; engines consume them
+// through step_normal() instead of their own generator.
+
+enum class PathSampling : uint8_t {
+    Pseudo,      // independent mt19937_64 draws
+    Antithetic,  // every second path is the negation of the one before
+    Sobol        // scrambled Sobol points through a Brownian bridge
+};
+
+inline PathSampling parse_path_sampling(const std::string& name) {
+    if (name == "pseudo") return PathSampling::Pseudo;
+    if (name == "antithetic") return PathSampling::Antithetic;
+    if (name == "sobol") return PathSampling::Sobol;
+    throw std::runtime_error("Unknown path sampling mode: " + name);
+}
+
+inline const char* path_sampling_name(PathSampling mode) {
+    switch (mode) {
+        case PathSampling::Pseudo: return "pseudo";
+        case PathSampling::Antithetic: return "antithetic";
+        case PathSampling::Sobol: return "sobol";
+    }
+    return "unknown";
+}
+
+// Sobol low-discrepancy sequence (Gray-code order, 32-bit) with a random
+// digital shift per dimension. Primitive polynomials are enumerated in
+// degree order up to degree 13 (kMaxDims dimensions). Initial direction
+// numbers for dimensions 2-21 are Joe and Kuo's; later ones are fixed
+// pseudo-random odd values, which keeps the sequence valid but less
+// uniform in high projections. Put the important coordinates first.
+class SobolSequence {
+public:
+    static constexpr size_t kMaxDims = 1111;
+
+private:
+    static constexpr int kBits = 32;
+
+    std::vector<std::array<uint32_t, kBits>> directions_;
+    std::vector<uint32_t> state_;
+    std::vector<uint32_t> shift_;
+    uint64_t index_ = 0;
+
+    // x^e mod poly over GF(2); poly has degree deg
+    static uint32_t pow_mod(uint64_t e, uint32_t poly, int deg) {
+        auto mul = [poly, deg](uint32_t x, uint32_t y) {
+            uint32_t r = 0;
+            for (int i = 0; i < deg; ++i) {
+                if ((y >> i) & 1) r ^= x;
+                x <<= 1;
+                if ((x >> deg) & 1) x ^= poly;
+            }
+            return r;
+        };
+        uint32_t result = 1;
+        uint32_t base = deg > 1 ? 2 : (2 ^ poly);  // x mod poly
+        while (e > 0) {
+            if (e & 1) result = mul(result, base);
+            base = mul(base, base);
+            e >>= 1;
+        }
+        return result;
+    }
+
+    static bool primitive(uint32_t poly, int deg) {
+        uint64_t order = (uint64_t{1} << deg) - 1;
+        if (pow_mod(order, poly, deg) != 1) return false;
+
+        uint64_t n = order;
+        for (uint64_t q = 2; q * q <= n; ++q) {
+            if (n % q != 0) continue;
+            if (pow_mod(order / q, poly, deg) == 1) return false;
+            while (n % q == 0) n /= q;
+        }
+        return n == 1 || pow_mod(order / n, poly, deg) != 1;
+    }
+
+    // (degree, middle coefficients a) of primitive polynomials, degree order
+    static std::vector<std::pair<int, uint32_t>> primitive_polynomials(size_t count) {
+        std::vector<std::pair<int, uint32_t>> out;
+        for (int deg = 1; out.size() < count; ++deg) {
+            for (uint32_t a = 0; a < (1u << (deg - 1)) && out.size() < count; ++a) {
+                uint32_t poly = (1u << deg) | (a << 1) | 1u;
+                if (primitive(poly, deg)) out.emplace_back(deg, a);
+            }
+        }
+        return out;
+    }
+
+public:
+    SobolSequence(size_t dims, std::mt19937_64& rng) {
+        static const std::vector<std::vector<uint32_t>> kJoeKuo = {
+            {1}, {1, 3}, {1, 3, 1}, {1, 1, 1}, {1, 1, 3, 3}, {1, 3, 5, 13}, {1, 1, 5, 5, 17},
+            {1, 1, 5, 5, 5}, {1, 1, 7, 11, 19}, {1, 1, 5, 1, 1}, {1, 1, 1, 3, 11}, {1, 3, 5, 5, 31},
+            {1, 3, 3, 9, 7, 49}, {1, 1, 1, 15, 21, 21}, {1, 3, 1, 13, 27, 49}, {1, 1, 1, 15, 7, 5},
+            {1, 3, 1, 15, 13, 25}, {1, 1, 5, 5, 19, 61}, {1, 3, 7, 11, 23, 15, 103}, {1, 3, 7, 13, 13, 15, 69}
+        };
+
+        if (dims == 0 || dims > kMaxDims) {
+            throw std::runtime_error("SobolSequence: dimensions must be in 1.." + std::to_string(kMaxDims));
+        }
+
+        directions_.resize(dims);
+        for (int k = 0; k < kBits; ++k) {
+            directions_[0][k] = 1u << (kBits - 1 - k);
+        }
+
+        auto polys = primitive_polynomials(dims - 1);
+        std::mt19937_64 fill(0x50B01);
+        for (size_t d = 1; d < dims; ++d) {
+            auto [deg, a] = polys[d - 1];
+            auto& v = directions_[d];
+
+            for (int k = 0; k < deg && k < kBits; ++k) {
+                uint32_t m = d - 1 < kJoeKuo.size()
+                    ? kJoeKuo[d - 1][k]
+                    : static_cast<uint32_t>(fill() % (uint64_t{1} << (k + 1))) | 1u;
+                v[k] = m << (kBits - 1 - k);
+            }
+            for (int k = deg; k < kBits; ++k) {
+                v[k] = v[k - deg] ^ (v[k - deg] >> deg);
+                for (int j = 1; j < deg; ++j) {
+                    if ((a >> (deg - 1 - j)) & 1) v[k] ^= v[k - j];
+                }
+            }
+        }
+
+        state_.assign(dims, 0);
+        shift_.resize(dims);
+        for (auto& s : shift_) s = static_cast<uint32_t>(rng());
+    }
+
+    size_t dims() const { return directions_.size(); }
+
+    // Next point in (0, 1)^dims
+    void next(std::span<double> out) {
+        for (size_t d = 0; d < state_.size(); ++d) {
+            out[d] = (static_cast<double>(state_[d] ^ shift_[d]) + 0.5) / 4294967296.0;
+        }
+        int bit = std::countr_one(index_);
+        if (bit >= kBits) {
+            throw std::runtime_error("SobolSequence: exhausted 2^32 points");
+        }
+        for (size_t d = 0; d < state_.size(); ++d) {
+            state_[d] ^= directions_[d][bit];
+        }
+        index_++;
+    }
+};
+
+// Brownian bridge over n unit time steps: z[0] sets the endpoint, then each
+// z[i] fills the midpoint of the widest remaining gap. Fed quasi-random
+// points, the leading (best distributed) coordinates carry most of the
+// path's variance.
+class BrownianBridge {
+private:
+    size_t n_;
+    std::vector<size_t> bridge_, left_, right_;
+    std::vector<double> left_weight_, right_weight_, stddev_;
+    mutable std::vector<double> path_;
+
+public:
+    explicit BrownianBridge(size_t steps)
+        : n_(steps), bridge_(steps), left_(steps), right_(steps),
+          left_weight_(steps), right_weight_(steps), stddev_(steps), path_(steps)
+    {
+        if (steps == 0) throw std::runtime_error("BrownianBridge: need at least one step");
+
+        auto t = [](size_t i) { return static_cast<double>(i + 1); };
+        std::vector<size_t> filled(steps, 0);
+        filled[steps - 1] = 1;
+        bridge_[0] = steps - 1;
+        stddev_[0] = std::sqrt(t(steps - 1));
+
+        for (size_t i = 1, j = 0; i < steps; ++i) {
+            while (filled[j]) ++j;
+            size_t k = j;
+            while (!filled[k]) ++k;
+            size_t l = j + ((k - 1 - j) >> 1);
+            filled[l] = i;
+            bridge_[i] = l;
+            left_[i] = j;
+            right_[i] = k;
+
+            double t_left = j == 0 ? 0.0 : t(j - 1);
+            left_weight_[i] = (t(k) - t(l)) / (t(k) - t_left);
+            right_weight_[i] = (t(l) - t_left) / (t(k) - t_left);
+            stddev_[i] = std::sqrt((t(l) - t_left) * (t(k) - t(l)) / (t(k) - t_left));
+
+            j = k + 1;
+            if (j >= steps) j = 0;
+        }
+    }
+
+    // Maps bridge-ordered normals to per-step increments, each N(0, 1)
+    void transform(std::span<const double> z, std::span<double> increments) const {
+        path_[n_ - 1] = stddev_[0] * z[0];
+        for (size_t i = 1; i < n_; ++i) {
+            size_t j = left_[i];
+            double left = j == 0 ? 0.0 : path_[j - 1];
+            path_[bridge_[i]] = left_weight_[i] * left + right_weight_[i] * path_[right_[i]] + stddev_[i] * z[i];
+        }
+        increments[0] = path_[0];
+        for (size_t i = 1; i < n_; ++i) {
+            increments[i] = path_[i] - path_[i - 1];
+        }
+    }
+};
+
+// Per-step standard normal shocks for one path at a time. With Sobol,
+// steps beyond SobolSequence::kMaxDims take pseudo-random bridge
+// coordinates (they only refine the path between already fixed points).
+class PathGenerator {
+private:
+    size_t steps_;
+    PathSampling mode_;
+    std::mt19937_64 rng_;
+    DetNormal normal_{0.0, 1.0};
+    std::vector<double> last_;
+    bool mirror_next_ = false;
+    std::optional<SobolSequence> sobol_;
+    std::optional<BrownianBridge> bridge_;
+    std::vector<double> point_;
+
+public:
+    PathGenerator(size_t steps, PathSampling mode, std::mt19937_64 rng)
+        : steps_(steps), mode_(mode), rng_(std::move(rng)), last_(steps)
+    {
+        if (mode_ == PathSampling::Sobol) {
+            sobol_.emplace(std::min(steps, SobolSequence::kMaxDims), rng_);
+            bridge_.emplace(steps);
+            point_.resize(steps);
+        }
+    }
+
+    size_t steps() const { return steps_; }
+    PathSampling mode() const { return mode_; }
+
+    void next(std::span<double> z) {
+        switch (mode_) {
+            case PathSampling::Pseudo:
+                for (auto& x : z) x = normal_(rng_);
+                break;
+
+            case PathSampling::Antithetic:
+                if (mirror_next_) {
+                    for (size_t i = 0; i < steps_; ++i) z[i] = -last_[i];
+                } else {
+                    for (size_t i = 0; i < steps_; ++i) z[i] = last_[i] = normal_(rng_);
+                }
+                mirror_next_ = !mirror_next_;
+                break;
+
+            case PathSampling::Sobol: {
+                size_t dims = sobol_->dims();
+                sobol_->next(std::span<double>(point_).first(dims));
+                for (size_t i = 0; i < dims; ++i) point_[i] = inverse_normal_cdf(point_[i]);
+                for (size_t i = dims; i < steps_; ++i) point_[i] = normal_(rng_);
+                bridge_->transform(point_, z);
+                break;
+            }
+        }
+    }
+};
+
+// Runs n_paths paths of paths.steps() ticks. make_engine(path) returns a
+// fresh EngineVariant per path; on_path(path, raw_prices) sees every tick.
+// on_path may take a third argument, the path's likelihood-ratio weight
+// (1 unless the engines carry a CrashTilt).
+template<typename MakeEngine, typename OnPath>
+void simulate_paths(size_t n_paths, PathGenerator& paths, MakeEngine&& make_engine, OnPath&& on_path) {
+    std::vector<double> z(paths.steps());
+    std::vector<int64_t> prices(paths.steps());
+
+    for (size_t p = 0; p < n_paths; ++p) {
+        EngineVariant engine = make_engine(p);
+        paths.next(z);
+        for (size_t i = 0; i < z.size(); ++i) {
+            prices[i] = step_normal(engine, z[i]);
+        }
+
+        std::span<const int64_t> path(prices);
+        if constexpr (std::is_invocable_v<OnPath&, size_t, std::span<const int64_t>, double>) {
+            on_path(p, path, det_exp(log_weight(engine).value_or(0.0)));
+        } else {
+            on_path(p, path);
+        }
+    }
+}
+
+}
@@ -17,7 +17,7 @@ public:
         bool stale
     ) = 0;
 
-    virtual double current_price() const = 0;
+    virtual Price current_price() const = 0;
 
     virtual std::string pair() const = 0;
 };
@@ -1,41 +1,182 @@
 #pragma once
 
+#include "det_math.hpp"
 #include <random>
 #include <string>
 #include <cstdint>
+#include <algorithm>
+#include <cmath>
 #include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <variant>
+#include <vector>
 
 namespace sim_core {
 
+// Generator seeded from seed and a stream label. The label hash is FNV-1a
+// rather than std::hash so streams match across standard libraries.
 inline std::mt19937_64 create_labeled_rng(uint64_t seed, const std::string& label) {
-    std::hash<std::string> hasher;
-    uint64_t label_hash = hasher(label);
+    uint64_t label_hash = fnv1a64(label.data(), label.size());
 
     uint64_t final_seed = seed ^ label_hash;
 
     return std::mt19937_64(final_seed);
 }
 
+// Generator state as text (operator<<), so a run can resume mid-stream
+inline std::string save_rng(const std::mt19937_64& rng) {
+    std::ostringstream out;
+    out << rng;
+    return out.str();
+}
+
+inline void restore_rng(std::mt19937_64& rng, const std::string& saved) {
+    std::istringstream in(saved);
+    in >> rng;
+    if (!in) throw std::runtime_error("Invalid saved generator state");
+}
+
 inline bool happens(std::mt19937_64& rng, double probability) {
     if (probability <= 0.0) return false;
     if (probability >= 1.0) return true;
 
-    std::uniform_real_distribution<double> dist(0.0, 1.0);
-    return dist(rng) < probability;
+    return uniform01(rng) < probability;
 }
 
 inline uint64_t sample_range(std::mt19937_64& rng, uint64_t min, uint64_t max) {
     if (min >= max) return min;
 
-    std::uniform_int_distribution<uint64_t> dist(min, max);
-    return dist(rng);
+    return uniform_int(rng, min, max);
 }
 
 inline double sample_range_f64(std::mt19937_64& rng, double min, double max) {
     if (min >= max) return min;
 
-    std::uniform_real_distribution<double> dist(min, max);
-    return dist(rng);
+    return DetUniform(min, max)(rng);
 }
 
+// Walker's alias method: O(n) build (Vose), O(1) sampling of an index
+// with probability proportional to its weight.
+class AliasTable {
+private:
+    std::vector<double> prob_;
+    std::vector<uint32_t> alias_;
+
+public:
+    AliasTable() = default;
+
+    explicit AliasTable(const std::vector<double>& weights) {
+        double total = 0.0;
+        for (double w : weights) {
+            if (w < 0.0) throw std::runtime_error("AliasTable: negative weight");
+            total += w;
+        }
+        if (weights.empty() || total <= 0.0) {
+            throw std::runtime_error("AliasTable: weights must have a positive sum");
+        }
+
+        size_t n = weights.size();
+        prob_.resize(n);
+        alias_.resize(n);
+
+        std::vector<double> scaled(n);
+        std::vector<uint32_t> small, large;
+        for (size_t i = 0; i < n; ++i) {
+            scaled[i] = weights[i] * static_cast<double>(n) / total;
+            (scaled[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+        }
+
+        while (!small.empty() && !large.empty()) {
+            uint32_t s = small.back();
+            small.pop_back();
+            uint32_t l = large.back();
+
+            prob_[s] = scaled[s];
+            alias_[s] = l;
+            scaled[l] -= 1.0 - scaled[s];
+            if (scaled[l] < 1.0) {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+        // Leftovers are 1 up to rounding
+        for (uint32_t i : large) { prob_[i] = 1.0; alias_[i] = i; }
+        for (uint32_t i : small) { prob_[i] = 1.0; alias_[i] = i; }
+    }
+
+    size_t size() const { return prob_.size(); }
+
+    size_t sample(std::mt19937_64& rng) const {
+        auto i = static_cast<size_t>(uniform_int(rng, 0, prob_.size() - 1));
+        return uniform01(rng) < prob_[i] ? i : alias_[i];
+    }
+};
+
+// Latency models with a tail, in milliseconds
+
+// Log-normal with the given median; sigma is the shape of the underlying
+// normal (p99.9 = median * exp(3.09 * sigma))
+struct LogNormalLatency {
+    double median_ms;
+    double sigma;
+
+    double sample(std::mt19937_64& rng) const {
+        return median_ms * det_exp(sigma * DetNormal()(rng));
+    }
+};
+
+// Pareto type I with minimum min_ms and tail index alpha
+// (p99.9 = min_ms * 1000^(1/alpha))
+struct ParetoLatency {
+    double min_ms;
+    double alpha;
+
+    double sample(std::mt19937_64& rng) const {
+        return min_ms * det_exp(-det_log(uniform_open01(rng)) / alpha);
+    }
+};
+
+// Histogram of observed latencies: bin i covers [edges[i], edges[i + 1])
+// with weight weights[i]. Picks a bin from an alias table, then a uniform
+// point inside it.
+class EmpiricalLatency {
+private:
+    std::vector<double> edges_;
+    AliasTable bins_;
+
+public:
+    EmpiricalLatency(std::vector<double> edges, const std::vector<double>& weights)
+        : edges_(std::move(edges)),
+          bins_(weights)
+    {
+        if (edges_.size() != weights.size() + 1) {
+            throw std::runtime_error("EmpiricalLatency: need one more edge than bins");
+        }
+        for (size_t i = 1; i < edges_.size(); ++i) {
+            if (edges_[i] < edges_[i - 1]) {
+                throw std::runtime_error("EmpiricalLatency: bin edges must ascend");
+            }
+        }
+    }
+
+    size_t bins() const { return bins_.size(); }
+
+    double sample(std::mt19937_64& rng) const {
+        size_t bin = bins_.sample(rng);
+        return sample_range_f64(rng, edges_[bin], edges_[bin + 1]);
+    }
+};
+
+// A tail latency model plus a cap so a sample always fits the frame's delay_ms
+struct LatencyDistribution {
+    std::variant<LogNormalLatency, ParetoLatency, EmpiricalLatency> model;
+    double cap_ms;
+
+    uint32_t sample(std::mt19937_64& rng) const {
+        double ms = std::visit([&rng](const auto& m) { return m.sample(rng); }, model);
+        return static_cast<uint32_t>(std::llround(std::clamp(ms, 0.0, cap_ms)));
+    }
+};
+
 }
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "config.hpp"
+#include "arrival.hpp"
+#include "engine_factory.hpp"
+#include "oracle_feeds.hpp"
+#include "rng.hpp"
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace sim_core {
+
+// Construction of the servers' random processes from config and seed,
+// shared by the servers and the offline tools so both draw identical paths.
+
+inline ArrivalProcessPtr make_arrival_process(const DexConfig& config) {
+    auto rng = create_labeled_rng(config.server.seed, "DEX_ARRIVALS");
+    const auto& model = config.dex_arrival_model;
+
+    if (model == "uniform") {
+        return std::make_unique<UniformArrivals>(
+            static_cast<double>(config.dex_tick_ms.min),
+            static_cast<double>(config.dex_tick_ms.max),
+            std::move(rng)
+        );
+    }
+
+    if (model == "mmpp") {
+        return std::make_unique<MmppArrivals>(
+            static_cast<double>(config.dex_tick_ms.min),
+            static_cast<double>(config.dex_tick_ms.max),
+            static_cast<double>(config.dex_burst_on_ms),
+            static_cast<double>(config.dex_burst_off_ms),
+            std::move(rng)
+        );
+    }
+
+    if (model == "hawkes") {
+        return std::make_unique<HawkesArrivals>(
+            config.dex_hawkes_base_hz,
+            config.dex_hawkes_alpha_hz,
+            config.dex_hawkes_decay_hz,
+            std::move(rng)
+        );
+    }
+
+    throw std::runtime_error("Unknown dex_arrival_model: " + model);
+}
+
+// Steps per live path under a crash tilt: the tilt's horizon in engine
+// steps. 0 (one endless path) without a tilt.
+inline uint64_t live_path_steps(const CrashTilt& tilt, uint64_t tick_interval_ms) {
+    if (!tilt.enabled()) return 0;
+    return std::max<uint64_t>(tilt.horizon_ms / std::max<uint64_t>(tick_interval_ms, 1), 1);
+}
+
+inline EngineVariant make_dex_engine(const DexConfig& config) {
+    auto engine = make_engine(
+        config.server,
+        config.server.pairs[0],
+        config.dex_tick_ms.min,
+        create_labeled_rng(config.server.seed, "DEX")
+    );
+    split_paths(engine, live_path_steps(config.server.crash_tilt, config.dex_tick_ms.min));
+    return engine;
+}
+
+// Server parameters with a feed's overrides applied
+inline ServerConfig oracle_feed_model(const OracleConfig& config, const OracleFeedConfig& feed) {
+    ServerConfig model = config.server;
+    model.pair_price_models[feed.pair] = feed.price_model;
+    model.price_start = feed.price_start;
+    model.price_decimals = feed.price_decimals;
+    model.ou_peg = feed.ou_peg;
+    return model;
+}
+
+inline EngineVariant make_oracle_engine(const OracleConfig& config, const ServerConfig& model, const std::string& pair) {
+    auto engine = make_engine(
+        model,
+        pair,
+        config.oracle_tick_ms.min,
+        create_labeled_rng(config.server.seed, "ORACLE:" + pair)
+    );
+    split_paths(engine, live_path_steps(model.crash_tilt, config.oracle_tick_ms.min));
+    return engine;
+}
+
+inline OracleFeedSet make_oracle_feed_set(const OracleConfig& config) {
+    return OracleFeedSet(
+        config.oracle_tick_ms,
+        config.oracle_stale_after_ms,
+        create_labeled_rng(config.server.seed, "ORACLE_FEEDS")
+    );
+}
+
+// A fresh feed set with every configured feed added at time 0
+inline OracleFeedSet make_oracle_feeds(const OracleConfig& config) {
+    auto feeds = make_oracle_feed_set(config);
+    for (const auto& feed : config.feeds) {
+        feeds.add_feed(feed.pair, make_oracle_engine(config, oracle_feed_model(config, feed), feed.pair),
+                       feed.oracle_deviation_bps, feed.oracle_heartbeat_ms, 0);
+    }
+    return feeds;
+}
+
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "scenario.hpp"
+#include "work_stealing.hpp"
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace sim_core {
+
+// Offline search for seeds whose DEX and oracle paths are worst by some
+// objective. Each seed is replayed in virtual time with the same arrival
+// process, engines and oracle feed set the servers build from that seed, so
+// a seed found here reproduces when set as `seed:` in both configs.
+
+enum class SearchObjective : uint8_t {
+    OracleLag,    // largest gap between the DEX price and the oracle answer
+    Drawdown,     // largest DEX peak-to-trough drop
+    OutsideBand   // longest stretch with the DEX outside the oracle's deviation band
+};
+
+inline SearchObjective parse_search_objective(const std::string& name) {
+    if (name == "lag") return SearchObjective::OracleLag;
+    if (name == "drawdown") return SearchObjective::Drawdown;
+    if (name == "band") return SearchObjective::OutsideBand;
+    throw std::runtime_error("Unknown search objective: " + name);
+}
+
+inline const char* search_objective_name(SearchObjective objective) {
+    switch (objective) {
+        case SearchObjective::OracleLag: return "lag";
+        case SearchObjective::Drawdown: return "drawdown";
+        case SearchObjective::OutsideBand: return "band";
+    }
+    return "unknown";
+}
+
+struct RunScore {
+    uint64_t seed = 0;
+    double max_lag_bps = 0.0;          // |dex - oracle| / oracle
+    double max_drawdown_pct = 0.0;
+    double max_outside_band_ms = 0.0;
+    uint64_t dex_ticks = 0;
+    uint64_t oracle_updates = 0;
+
+    double score(SearchObjective objective) const {
+        switch (objective) {
+            case SearchObjective::OracleLag: return max_lag_bps;
+            case SearchObjective::Drawdown: return max_drawdown_pct;
+            case SearchObjective::OutsideBand: return max_outside_band_ms;
+        }
+        return 0.0;
+    }
+};
+
+// Runs the DEX pair and its oracle feed for duration_ms of virtual time,
+// ignoring faults and load shedding (they change delivery, not the paths)
+inline RunScore score_seed(const DexConfig& dex_config, const OracleConfig& oracle_config,
+                           uint64_t seed, uint64_t duration_ms) {
+    DexConfig dex = dex_config;
+    OracleConfig oracle = oracle_config;
+    dex.server.seed = seed;
+    oracle.server.seed = seed;
+
+    const std::string& pair = dex.server.pairs[0];
+    auto it = std::find_if(oracle.feeds.begin(), oracle.feeds.end(),
+        [&pair](const OracleFeedConfig& feed) { return feed.pair == pair; });
+    if (it == oracle.feeds.end()) {
+        throw std::runtime_error("Oracle config has no feed for DEX pair " + pair);
+    }
+    auto feed = static_cast<uint32_t>(it - oracle.feeds.begin());
+    double band_bps = static_cast<double>(it->oracle_deviation_bps);
+
+    auto arrivals = make_arrival_process(dex);
+    auto engine = make_dex_engine(dex);
+    auto feeds = make_oracle_feeds(oracle);
+
+    RunScore run;
+    run.seed = seed;
+
+    Price start = current_price(engine);
+    double dex_price = start.to_double();
+    double peak = dex_price;
+    std::optional<double> answer;
+    bool outside = false;
+    double outside_since = 0.0;
+    double next_tick = arrivals->next_interval_ms();
+    auto end = static_cast<double>(duration_ms);
+
+    while (true) {
+        auto next_poll = static_cast<double>(feeds.next_due_ms());
+        double now = std::min(next_tick, next_poll);
+        if (now > end) break;
+
+        if (next_tick <= next_poll) {
+            dex_price = Price{step(engine), start.decimals}.to_double();
+            next_tick += arrivals->next_interval_ms();
+            run.dex_ticks++;
+            peak = std::max(peak, dex_price);
+            run.max_drawdown_pct = std::max(run.max_drawdown_pct, (peak - dex_price) / peak * 100.0);
+        } else {
+            for (const auto& publish : feeds.poll(feeds.next_due_ms())) {
+                if (publish.feed != feed) continue;
+                answer = publish.price.to_double();
+                run.oracle_updates++;
+            }
+        }
+
+        if (!answer.has_value()) continue;
+
+        double gap_bps = std::abs(dex_price - *answer) / *answer * 10000.0;
+        run.max_lag_bps = std::max(run.max_lag_bps, gap_bps);
+        if (gap_bps >= band_bps) {
+            if (!outside) outside_since = now;
+            outside = true;
+            run.max_outside_band_ms = std::max(run.max_outside_band_ms, now - outside_since);
+        } else {
+            outside = false;
+        }
+    }
+
+    if (outside) {
+        run.max_outside_band_ms = std::max(run.max_outside_band_ms, end - outside_since);
+    }
+    return run;
+}
+
+struct SeedSearchOptions {
+    uint64_t first_seed = 0;
+    uint64_t seeds = 1000;
+    uint64_t duration_ms = 3'600'000;
+    SearchObjective objective = SearchObjective::OracleLag;
+    size_t top = 10;
+    unsigned threads = 0;  // 0 = one per core
+};
+
+// Scores every seed in [first_seed, first_seed + seeds) across threads and
+// returns the `top` worst, worst first (ties broken by lower seed)
+inline std::vector<RunScore> search_seeds(const DexConfig& dex, const OracleConfig& oracle,
+                                          const SeedSearchOptions& options) {
+    unsigned workers = worker_count(options.threads, options.seeds);
+
+    auto worse = [objective = options.objective](const RunScore& a, const RunScore& b) {
+        double sa = a.score(objective);
+        double sb = b.score(objective);
+        return sa != sb ? sa > sb : a.seed < b.seed;
+    };
+
+    // Per worker min-heap by badness holding its `top` worst runs
+    std::vector<std::vector<RunScore>> worst(workers);
+    parallel_for_stealing(options.first_seed, options.first_seed + options.seeds, workers,
+        [&](size_t worker, uint64_t seed) {
+            auto& heap = worst[worker];
+            heap.push_back(score_seed(dex, oracle, seed, options.duration_ms));
+            std::push_heap(heap.begin(), heap.end(), worse);
+            if (heap.size() > options.top) {
+                std::pop_heap(heap.begin(), heap.end(), worse);
+                heap.pop_back();
+            }
+        });
+
+    std::vector<RunScore> results;
+    for (auto& heap : worst) {
+        results.insert(results.end(), heap.begin(), heap.end());
+    }
+    std::sort(results.begin(), results.end(), worse);
+    if (results.size() > options.top) results.resize(options.top);
+    return results;
+}
+
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "slot_map.hpp"
+#include "digest.hpp"
+#include <array>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <stdexcept>
+#include <cstdint>
+
+namespace sim_core {
+
+// Subscriber priority, highest first
+enum class Tier : uint8_t {
+    Critical,
+    Normal,
+    Dashboard
+};
+
+constexpr size_t kTierCount = 3;
+
+// Sends granted to each tier per scheduling round while all tiers are backlogged
+constexpr std::array<uint32_t, kTierCount> kTierWeights{8, 3, 1};
+
+inline Tier parse_tier(const std::string& name) {
+    if (name == "critical") return Tier::Critical;
+    if (name == "normal") return Tier::Normal;
+    if (name == "dashboard") return Tier::Dashboard;
+    throw std::runtime_error("Unknown subscriber tier: " + name);
+}
+
+inline const char* tier_name(Tier tier) {
+    switch (tier) {
+        case Tier::Critical: return "critical";
+        case Tier::Normal: return "normal";
+        case Tier::Dashboard: return "dashboard";
+    }
+    return "unknown";
+}
+
+// One serialized frame shared by every subscriber it is queued on.
+// key identifies what the frame supersedes when conflated (the pair);
+// record is the tick it carries, for per-subscriber digests; writes_started
+// counts the subscribers it has been handed to, under the hub's lock.
+struct OutboundFrame {
+    std::string key;
+    std::string payload;
+    std::optional<DigestRecord> record{};
+    mutable uint32_t writes_started = 0;
+};
+
+using FramePtr = std::shared_ptr<const OutboundFrame>;
+
+// Frames waiting for one subscriber. Backed by a vector consumed from the
+// front, reset when empty and compacted once mostly consumed, so an idle
+// subscriber holds no more than a few pointers (std::deque allocates a map
+// and a 512 byte block up front). An index from key to the newest queued
+// frame for it lets conflation replace that frame wherever it sits.
+class SubscriberQueue {
+private:
+    std::vector<FramePtr> frames_;
+    size_t head_ = 0;
+    std::unordered_map<std::string, size_t> newest_;  // key -> position in frames_
+
+public:
+    // With conflate set, a frame for the same key as a queued one replaces
+    // the newest such frame in place instead of queueing behind the others.
+    // Returns true if conflated.
+    bool push(FramePtr frame, bool conflate) {
+        auto it = newest_.find(frame->key);
+        if (it != newest_.end()) {
+            if (conflate) {
+                frames_[it->second] = std::move(frame);
+                return true;
+            }
+            it->second = frames_.size();
+        } else {
+            newest_.emplace(frame->key, frames_.size());
+        }
+        frames_.push_back(std::move(frame));
+        return false;
+    }
+
+    FramePtr pop() {
+        FramePtr frame = std::move(frames_[head_]);
+        auto it = newest_.find(frame->key);
+        if (it != newest_.end() && it->second == head_) {
+            newest_.erase(it);
+        }
+        ++head_;
+        if (head_ == frames_.size()) {
+            frames_.clear();
+            head_ = 0;
+        } else if (head_ >= 64 && head_ * 2 >= frames_.size()) {
+            frames_.erase(frames_.begin(), frames_.begin() + static_cast<ptrdiff_t>(head_));
+            for (auto& entry : newest_) entry.second -= head_;
+            head_ = 0;
+        }
+        return frame;
+    }
+
+    const FramePtr& front() const { return frames_[head_]; }
+    bool empty() const { return head_ == frames_.size(); }
+    size_t size() const { return frames_.size() - head_; }
+};
+
+// Picks the next subscriber with pending frames. Each tier keeps a FIFO of
+// ready subscribers; tiers are served by weighted round robin in priority
+// order, so higher tiers drain first without starving lower ones.
+// push and pop are O(1).
+class TierScheduler {
+private:
+    std::array<std::deque<SlotId>, kTierCount> ready_;
+    std::array<uint32_t, kTierCount> credits_ = kTierWeights;
+
+public:
+    void push(Tier tier, SlotId id) {
+        ready_[static_cast<size_t>(tier)].push_back(id);
+    }
+
+    std::optional<SlotId> pop() {
+        for (int pass = 0; pass < 2; ++pass) {
+            for (size_t t = 0; t < kTierCount; ++t) {
+                if (!ready_[t].empty() && credits_[t] > 0) {
+                    credits_[t]--;
+                    SlotId id = ready_[t].front();
+                    ready_[t].pop_front();
+                    return id;
+                }
+            }
+            credits_ = kTierWeights;
+        }
+        return std::nullopt;
+    }
+
+    size_t size() const {
+        size_t total = 0;
+        for (const auto& q : ready_) total += q.size();
+        return total;
+    }
+
+    bool empty() const { return size() == 0; }
+};
+
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace sim_core {
+
+// Stable handle into a SlotMap. The generation changes every time a slot is
+// reused, so a handle to a removed entry never aliases a newer one.
+struct SlotId {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool valid() const { return index != UINT32_MAX; }
+
+    std::string to_string() const {
+        return std::to_string(index) + "." + std::to_string(generation);
+    }
+
+    friend bool operator==(const SlotId&, const SlotId&) = default;
+};
+
+// Slot map with values stored densely for cache-friendly iteration.
+// insert/erase/get are O(1); erase swaps the last value into the hole.
+template<typename T>
+class SlotMap {
+private:
+    struct Slot {
+        uint32_t generation = 0;
+        uint32_t dense = UINT32_MAX;  // or next free slot when unoccupied
+        bool occupied = false;
+    };
+
+    std::vector<Slot> slots_;
+    std::vector<T> values_;
+    std::vector<uint32_t> dense_to_slot_;
+    uint32_t free_head_ = UINT32_MAX;
+
+public:
+    SlotId insert(T value) {
+        uint32_t index;
+        if (free_head_ != UINT32_MAX) {
+            index = free_head_;
+            free_head_ = slots_[index].dense;
+        } else {
+            index = static_cast<uint32_t>(slots_.size());
+            slots_.emplace_back();
+        }
+
+        Slot& slot = slots_[index];
+        slot.occupied = true;
+        slot.dense = static_cast<uint32_t>(values_.size());
+        values_.push_back(std::move(value));
+        dense_to_slot_.push_back(index);
+
+        return SlotId{index, slot.generation};
+    }
+
+    bool erase(SlotId id) {
+        if (!contains(id)) return false;
+
+        Slot& slot = slots_[id.index];
+        uint32_t hole = slot.dense;
+        uint32_t last = static_cast<uint32_t>(values_.size() - 1);
+
+        if (hole != last) {
+            values_[hole] = std::move(values_[last]);
+            dense_to_slot_[hole] = dense_to_slot_[last];
+            slots_[dense_to_slot_[hole]].dense = hole;
+        }
+        values_.pop_back();
+        dense_to_slot_.pop_back();
+
+        slot.occupied = false;
+        slot.generation++;
+        slot.dense = free_head_;
+        free_head_ = id.index;
+        return true;
+    }
+
+    bool contains(SlotId id) const {
+        return id.index < slots_.size()
+            && slots_[id.index].occupied
+            && slots_[id.index].generation == id.generation;
+    }
+
+    T* get(SlotId id) {
+        return contains(id) ? &values_[slots_[id.index].dense] : nullptr;
+    }
+
+    const T* get(SlotId id) const {
+        return contains(id) ? &values_[slots_[id.index].dense] : nullptr;
+    }
+
+    size_t size() const { return values_.size(); }
+    bool empty() const { return values_.empty(); }
+
+    // Dense access, valid for 0 <= i < size()
+    T& value_at(size_t i) { return values_[i]; }
+    const T& value_at(size_t i) const { return values_[i]; }
+
+    SlotId id_at(size_t i) const {
+        uint32_t index = dense_to_slot_[i];
+        return SlotId{index, slots_[index].generation};
+    }
+};
+
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace sim_core {
+
+// Hierarchical timer wheel (4 levels x 64 slots). Deadlines are absolute
+// ticks. schedule() is O(1); advance() does O(1) work per tick plus each
+// timer's cascades, at most one per level. Timers cannot be cancelled: the
+// owner checks on fire whether the timer is still wanted, and keeps at most
+// one outstanding timer per object so stale ones don't pile up.
+template<typename T>
+class TimerWheel {
+public:
+    static constexpr size_t kLevels = 4;
+    static constexpr size_t kSlotBits = 6;
+    static constexpr size_t kSlots = size_t{1} << kSlotBits;
+    static constexpr uint64_t kMaxDelay = (uint64_t{1} << (kSlotBits * kLevels)) - 1;
+
+private:
+    struct Entry {
+        uint64_t expires;
+        T value;
+    };
+
+    std::array<std::array<std::vector<Entry>, kSlots>, kLevels> slots_;
+    std::vector<Entry> firing_;
+    uint64_t now_ = 0;
+    size_t size_ = 0;
+
+    void place(Entry entry) {
+        uint64_t delta = entry.expires - now_;
+        size_t level = 0;
+        while (level + 1 < kLevels && delta >= (uint64_t{1} << (kSlotBits * (level + 1)))) {
+            level++;
+        }
+        size_t slot = (entry.expires >> (kSlotBits * level)) & (kSlots - 1);
+        slots_[level][slot].push_back(std::move(entry));
+    }
+
+    // Re-places the timers of the current slot at a level into lower levels
+    void cascade(size_t level) {
+        size_t slot = (now_ >> (kSlotBits * level)) & (kSlots - 1);
+        auto entries = std::move(slots_[level][slot]);
+        slots_[level][slot].clear();
+        for (auto& entry : entries) {
+            place(std::move(entry));
+        }
+    }
+
+public:
+    explicit TimerWheel(uint64_t now = 0)
+        : now_(now)
+    {}
+
+    uint64_t now() const { return now_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    // Deadlines in the past fire on the next tick; ones beyond kMaxDelay are clamped
+    void schedule(uint64_t expires, T value) {
+        if (expires <= now_) expires = now_ + 1;
+        if (expires - now_ > kMaxDelay) expires = now_ + kMaxDelay;
+        place(Entry{expires, std::move(value)});
+        size_++;
+    }
+
+    // Moves time forward to tick `to`, calling fire(value) for every timer
+    // that expires on the way, in deadline order. fire may schedule.
+    template<typename Fire>
+    void advance(uint64_t to, Fire&& fire) {
+        while (now_ < to) {
+            now_++;
+            for (size_t level = 1; level < kLevels; ++level) {
+                if ((now_ & ((uint64_t{1} << (kSlotBits * level)) - 1)) != 0) break;
+                cascade(level);
+            }
+
+            auto& slot = slots_[0][now_ & (kSlots - 1)];
+            if (slot.empty()) continue;
+
+            firing_.swap(slot);
+            size_ -= firing_.size();
+            for (auto& entry : firing_) {
+                fire(std::move(entry.value));
+            }
+            firing_.clear();
+        }
+    }
+};
+
+}
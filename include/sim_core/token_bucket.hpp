@@ -0,0 +1,69 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace sim_core {
+
+// Per-subscriber bandwidth cap
+struct BandwidthLimit {
+    uint64_t bytes_per_sec = 0;  // 0 = unlimited
+    uint64_t burst_bytes = 0;    // 0 = one second's worth
+
+    bool unlimited() const { return bytes_per_sec == 0; }
+    uint64_t burst() const { return burst_bytes > 0 ? burst_bytes : bytes_per_sec; }
+};
+
+// Token bucket refilled lazily from the elapsed time whenever it is asked,
+// so it needs no timer of its own. Times are nanoseconds on any monotonic
+// clock. A frame larger than the burst is let through once the bucket is
+// full and leaves it in debt, so oversized frames still flow at the rate.
+class TokenBucket {
+private:
+    BandwidthLimit limit_;
+    double tokens_ = 0.0;
+    int64_t last_ns_ = 0;
+
+    void refill(int64_t now_ns) {
+        if (now_ns <= last_ns_) return;
+        double earned = static_cast<double>(now_ns - last_ns_) * static_cast<double>(limit_.bytes_per_sec) / 1e9;
+        tokens_ = std::min(tokens_ + earned, static_cast<double>(limit_.burst()));
+        last_ns_ = now_ns;
+    }
+
+    double needed(size_t bytes) const {
+        return static_cast<double>(std::min<uint64_t>(bytes, limit_.burst()));
+    }
+
+public:
+    TokenBucket() = default;
+
+    TokenBucket(BandwidthLimit limit, int64_t now_ns)
+        : limit_(limit),
+          tokens_(static_cast<double>(limit.burst())),
+          last_ns_(now_ns)
+    {}
+
+    bool unlimited() const { return limit_.unlimited(); }
+    const BandwidthLimit& limit() const { return limit_; }
+
+    // Takes bytes and returns true if the bucket allows sending them now
+    bool try_consume(size_t bytes, int64_t now_ns) {
+        if (unlimited()) return true;
+        refill(now_ns);
+        if (tokens_ < needed(bytes)) return false;
+        tokens_ -= static_cast<double>(bytes);
+        return true;
+    }
+
+    // Nanoseconds from the last refill until bytes can be sent
+    int64_t wait_ns(size_t bytes) const {
+        if (unlimited()) return 0;
+        double missing = needed(bytes) - tokens_;
+        if (missing <= 0.0) return 0;
+        return static_cast<int64_t>(missing * 1e9 / static_cast<double>(limit_.bytes_per_sec)) + 1;
+    }
+};
+
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <boost/asio.hpp>
+#include <boost/beast/websocket/teardown.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace sim_core {
+
+// TCP socket under a subscriber's websocket stream. Once track_frames() is
+// called it keeps the bytes of the client frame it has read only part of, so
+// a handoff can pass the bytes the websocket layer holds but has not acted on
+// to the replacement, and stop_reads() makes it refuse any further read.
+class TrackedSocket : public boost::asio::ip::tcp::socket {
+public:
+    using Base = boost::asio::ip::tcp::socket;
+
+    // Largest partial frame that can be carried over; it must fit the new
+    // stream's read buffer together with the adopt handshake
+    static constexpr size_t kMaxUnreadBytes = 1024;
+
+private:
+    mutable std::mutex mutex_;
+    bool tracking_ = false;
+    std::string partial_;  // bytes of the incomplete frame, from its header
+    uint64_t skip_ = 0;    // rest of a frame too large to carry
+    std::atomic<bool> reads_stopped_{false};
+
+    // Drops every complete frame from the front of partial_
+    void trim_frames() {
+        while (partial_.size() >= 2) {
+            auto* b = reinterpret_cast<const uint8_t*>(partial_.data());
+            uint64_t length = b[1] & 0x7f;
+            size_t header = 2 + ((b[1] & 0x80) ? 4 : 0);
+            if (length == 126) {
+                header += 2;
+                if (partial_.size() < 4) return;
+                length = (uint64_t{b[2]} << 8) | b[3];
+            } else if (length == 127) {
+                header += 8;
+                if (partial_.size() < 10) return;
+                length = 0;
+                for (int i = 0; i < 8; ++i) length = (length << 8) | b[2 + i];
+            }
+            if (partial_.size() < header) return;
+
+            uint64_t size = header + length;
+            if (partial_.size() >= size) {
+                partial_.erase(0, size);
+            } else if (size > kMaxUnreadBytes) {
+                skip_ = size - partial_.size();
+                partial_.clear();
+                return;
+            } else {
+                return;
+            }
+        }
+    }
+
+    void record(const char* data, size_t n) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!tracking_) return;
+        auto skipped = static_cast<size_t>(std::min<uint64_t>(skip_, n));
+        skip_ -= skipped;
+        partial_.append(data + skipped, n - skipped);
+        trim_frames();
+    }
+
+    template<typename Buffers>
+    void record(const Buffers& buffers, size_t n) {
+        for (auto it = boost::asio::buffer_sequence_begin(buffers);
+             n > 0 && it != boost::asio::buffer_sequence_end(buffers); ++it) {
+            boost::asio::const_buffer buffer(*it);
+            size_t k = std::min(n, buffer.size());
+            record(static_cast<const char*>(buffer.data()), k);
+            n -= k;
+        }
+    }
+
+    template<typename Buffers>
+    struct ReadOp {
+        TrackedSocket& socket;
+        Buffers buffers;
+        bool started = false;
+
+        template<typename Self>
+        void operator()(Self& self, boost::system::error_code ec = {}, size_t n = 0) {
+            if (!started) {
+                started = true;
+                if (socket.reads_stopped_) {
+                    boost::asio::post(socket.get_executor(), [self = std::move(self)]() mutable {
+                        self.complete(boost::asio::error::operation_aborted, 0);
+                    });
+                    return;
+                }
+                socket.Base::async_read_some(buffers, std::move(self));
+                return;
+            }
+            socket.record(buffers, n);
+            self.complete(ec, n);
+        }
+    };
+
+public:
+    using Base::Base;
+
+    explicit TrackedSocket(Base&& socket) : Base(std::move(socket)) {}
+
+    // Starts tracking frame boundaries; seed is the start of a partial frame
+    // handed over with the socket. Call before the first websocket read.
+    void track_frames(std::string_view seed = {}) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (tracking_) return;
+        tracking_ = true;
+        partial_.assign(seed);
+        trim_frames();
+    }
+
+    // Fails this and every later read with operation_aborted
+    void stop_reads(boost::system::error_code& ec) {
+        reads_stopped_ = true;
+        Base::cancel(ec);
+    }
+
+    // Bytes read of the current incomplete frame; nullopt while inside one
+    // too large to carry
+    std::optional<std::string> unread() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (skip_ > 0) return std::nullopt;
+        return partial_;
+    }
+
+    template<typename MutableBuffers, typename ReadToken>
+    auto async_read_some(const MutableBuffers& buffers, ReadToken&& token) {
+        return boost::asio::async_compose<ReadToken, void(boost::system::error_code, size_t)>(
+            ReadOp<MutableBuffers>{*this, buffers}, token, static_cast<Base&>(*this));
+    }
+
+    template<typename MutableBuffers>
+    size_t read_some(const MutableBuffers& buffers, boost::system::error_code& ec) {
+        if (reads_stopped_) {
+            ec = boost::asio::error::operation_aborted;
+            return 0;
+        }
+        size_t n = Base::read_some(buffers, ec);
+        record(buffers, n);
+        return n;
+    }
+
+    template<typename MutableBuffers>
+    size_t read_some(const MutableBuffers& buffers) {
+        boost::system::error_code ec;
+        size_t n = read_some(buffers, ec);
+        if (ec) throw boost::system::system_error(ec, "read_some");
+        return n;
+    }
+};
+
+// Closing handshake teardown, found by the websocket stream through ADL
+inline void teardown(boost::beast::role_type role, TrackedSocket& socket, boost::system::error_code& ec) {
+    boost::beast::websocket::teardown(role, static_cast<TrackedSocket::Base&>(socket), ec);
+}
+
+template<typename TeardownHandler>
+void async_teardown(boost::beast::role_type role, TrackedSocket& socket, TeardownHandler&& handler) {
+    boost::beast::websocket::async_teardown(
+        role, static_cast<TrackedSocket::Base&>(socket), std::forward<TeardownHandler>(handler));
+}
+
+}
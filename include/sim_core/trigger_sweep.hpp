@@ -0,0 +1,266 @@
+#pragma once
+
+#include "scenario.hpp"
+#include "work_stealing.hpp"
+#include "fixed_point.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace sim_core {
+
+// Offline sweep of oracle trigger parameters (deviation_bps x heartbeat_ms)
+// for an oracle that polls the DEX price. Each DEX path (with its poll
+// times) is generated once and replayed against every parameter set; at each
+// poll all sets are evaluated together over parallel arrays, with the same
+// deviation band arithmetic as should_publish.
+
+struct TriggerParams {
+    uint32_t deviation_bps;
+    uint64_t heartbeat_ms;
+};
+
+struct GasModel {
+    uint64_t gas_per_update = 100'000;
+    double gas_price_gwei = 20.0;
+
+    double cost_eth(uint64_t updates) const {
+        return static_cast<double>(updates) * static_cast<double>(gas_per_update) * gas_price_gwei * 1e-9;
+    }
+};
+
+struct TriggerStats {
+    TriggerParams params;
+    uint64_t updates = 0;
+    double updates_per_hour = 0.0;
+    double gas_eth = 0.0;
+    double max_staleness_bps = 0.0;   // largest |dex - answer| / dex
+    double mean_staleness_bps = 0.0;  // time-weighted, from the first update on
+    double max_age_ms = 0.0;          // longest time an answer stood
+};
+
+// DEX ticks and oracle poll times of one seed, over [0, end_ms]
+struct SweepPath {
+    std::vector<double> tick_ms;
+    std::vector<int64_t> price;
+    std::vector<double> poll_ms;
+    double end_ms = 0.0;
+};
+
+// The DEX path the dex server draws for `seed`, polled on the oracle
+// server's poll-interval distribution
+inline SweepPath generate_sweep_path(const DexConfig& dex_config, const OracleConfig& oracle,
+                                     uint64_t seed, uint64_t duration_ms) {
+    DexConfig dex = dex_config;
+    dex.server.seed = seed;
+
+    SweepPath path;
+    path.end_ms = static_cast<double>(duration_ms);
+
+    auto arrivals = make_arrival_process(dex);
+    auto engine = make_dex_engine(dex);
+    path.tick_ms.push_back(0.0);
+    path.price.push_back(current_price(engine).raw);
+    for (double t = arrivals->next_interval_ms(); t <= path.end_ms; t += arrivals->next_interval_ms()) {
+        path.tick_ms.push_back(t);
+        path.price.push_back(step(engine));
+    }
+
+    auto rng = create_labeled_rng(seed, "ORACLE_FEEDS");
+    uint64_t min = std::max<uint64_t>(oracle.oracle_tick_ms.min, 1);
+    uint64_t max = std::max(min, oracle.oracle_tick_ms.max);
+    for (uint64_t t = sample_range(rng, min, max); t <= duration_ms; t += sample_range(rng, min, max)) {
+        path.poll_ms.push_back(static_cast<double>(t));
+    }
+    return path;
+}
+
+class TriggerSweep {
+private:
+    std::vector<TriggerParams> params_;
+    std::vector<int64_t> bps_;
+    std::vector<double> heartbeat_ms_;
+
+    // Per-path state
+    std::vector<int64_t> answer_;
+    std::vector<int64_t> band_;
+    std::vector<double> published_ms_;
+    std::vector<int64_t> fire_;
+
+    // Totals over paths
+    std::vector<uint64_t> updates_;
+    std::vector<double> max_gap_bps_;
+    std::vector<double> gap_area_;
+    std::vector<double> max_age_ms_;
+    double covered_ms_ = 0.0;
+    double total_ms_ = 0.0;
+
+    // Staleness of every answer while the DEX sits at dex over [from, to)
+    void accrue(int64_t dex, double from, double to) {
+        size_t n = params_.size();
+        double scale = 10000.0 / static_cast<double>(dex);
+        double dt = to - from;
+        for (size_t k = 0; k < n; ++k) {
+            double gap = std::abs(static_cast<double>(dex - answer_[k])) * scale;
+            max_gap_bps_[k] = max_gap_bps_[k] < gap ? gap : max_gap_bps_[k];
+            gap_area_[k] += gap * dt;
+        }
+    }
+
+    void poll(int64_t current, double now_ms) {
+        size_t n = params_.size();
+
+        // Trigger mask over all sets, branch-free so it vectorizes; a band
+        // of 0 (never published) always fires
+        for (size_t k = 0; k < n; ++k) {
+            int64_t diff = current - answer_[k];
+            int64_t magnitude = diff < 0 ? -diff : diff;
+            double age = now_ms - published_ms_[k];
+            max_age_ms_[k] = max_age_ms_[k] < age ? age : max_age_ms_[k];
+            fire_[k] = static_cast<int64_t>(magnitude >= band_[k]) | static_cast<int64_t>(age >= heartbeat_ms_[k]);
+        }
+
+        // Publishes are sparse, so the update is a plain loop over the mask
+        for (size_t k = 0; k < n; ++k) {
+            if (!fire_[k]) continue;
+            answer_[k] = current;
+            band_[k] = deviation_band(current, static_cast<uint32_t>(bps_[k]));
+            published_ms_[k] = now_ms;
+            updates_[k]++;
+        }
+    }
+
+public:
+    explicit TriggerSweep(std::vector<TriggerParams> params)
+        : params_(std::move(params))
+    {
+        size_t n = params_.size();
+        for (const auto& p : params_) {
+            bps_.push_back(p.deviation_bps);
+            heartbeat_ms_.push_back(static_cast<double>(p.heartbeat_ms));
+        }
+        answer_.resize(n);
+        band_.resize(n);
+        published_ms_.resize(n);
+        fire_.resize(n);
+        updates_.resize(n);
+        max_gap_bps_.resize(n);
+        gap_area_.resize(n);
+        max_age_ms_.resize(n);
+    }
+
+    const std::vector<TriggerParams>& params() const { return params_; }
+
+    // Replays one path against every parameter set. A DEX tick and a poll
+    // at the same instant: the poll reads the new tick.
+    void run(const SweepPath& path) {
+        total_ms_ += path.end_ms;
+        if (path.poll_ms.empty() || path.price.empty()) return;
+        std::fill(answer_.begin(), answer_.end(), 0);
+        std::fill(band_.begin(), band_.end(), 0);
+        std::fill(published_ms_.begin(), published_ms_.end(), path.poll_ms[0]);
+
+        size_t tick = 0;
+        int64_t dex = path.price[0];
+        while (tick + 1 < path.price.size() && path.tick_ms[tick + 1] <= path.poll_ms[0]) {
+            dex = path.price[++tick];
+        }
+        double last = path.poll_ms[0];
+        poll(dex, last);
+
+        for (size_t p = 1; p < path.poll_ms.size(); ++p) {
+            double now = path.poll_ms[p];
+            while (tick + 1 < path.price.size() && path.tick_ms[tick + 1] <= now) {
+                double at = path.tick_ms[++tick];
+                accrue(dex, last, at);
+                dex = path.price[tick];
+                last = at;
+            }
+            accrue(dex, last, now);
+            last = now;
+            poll(dex, now);
+        }
+
+        while (tick + 1 < path.price.size()) {
+            double at = path.tick_ms[++tick];
+            accrue(dex, last, at);
+            dex = path.price[tick];
+            last = at;
+        }
+        accrue(dex, last, path.end_ms);
+        for (size_t k = 0; k < params_.size(); ++k) {
+            max_age_ms_[k] = std::max(max_age_ms_[k], path.end_ms - published_ms_[k]);
+        }
+        covered_ms_ += path.end_ms - path.poll_ms[0];
+    }
+
+    // Adds another sweep's totals (same parameter sets)
+    void merge(const TriggerSweep& other) {
+        for (size_t k = 0; k < params_.size(); ++k) {
+            updates_[k] += other.updates_[k];
+            max_gap_bps_[k] = std::max(max_gap_bps_[k], other.max_gap_bps_[k]);
+            gap_area_[k] += other.gap_area_[k];
+            max_age_ms_[k] = std::max(max_age_ms_[k], other.max_age_ms_[k]);
+        }
+        covered_ms_ += other.covered_ms_;
+        total_ms_ += other.total_ms_;
+    }
+
+    std::vector<TriggerStats> stats(const GasModel& gas) const {
+        std::vector<TriggerStats> out;
+        double hours = total_ms_ / 3'600'000.0;
+        for (size_t k = 0; k < params_.size(); ++k) {
+            TriggerStats s;
+            s.params = params_[k];
+            s.updates = updates_[k];
+            s.updates_per_hour = hours > 0.0 ? static_cast<double>(updates_[k]) / hours : 0.0;
+            s.gas_eth = gas.cost_eth(updates_[k]);
+            s.max_staleness_bps = max_gap_bps_[k];
+            s.mean_staleness_bps = covered_ms_ > 0.0 ? gap_area_[k] / covered_ms_ : 0.0;
+            s.max_age_ms = max_age_ms_[k];
+            out.push_back(s);
+        }
+        return out;
+    }
+};
+
+struct TriggerSweepOptions {
+    uint64_t first_seed = 0;
+    uint64_t paths = 32;
+    uint64_t duration_ms = 3'600'000;
+    unsigned threads = 0;  // 0 = one per core
+};
+
+// Every combination of the given deviations and heartbeats
+inline std::vector<TriggerParams> trigger_grid(const std::vector<uint32_t>& deviation_bps,
+                                               const std::vector<uint64_t>& heartbeat_ms) {
+    std::vector<TriggerParams> grid;
+    for (auto bps : deviation_bps) {
+        for (auto heartbeat : heartbeat_ms) {
+            grid.push_back(TriggerParams{bps, heartbeat});
+        }
+    }
+    return grid;
+}
+
+// Generates paths for seeds [first_seed, first_seed + paths) across threads
+// and evaluates every parameter set on each
+inline TriggerSweep sweep_triggers(const DexConfig& dex, const OracleConfig& oracle,
+                                   const std::vector<TriggerParams>& params,
+                                   const TriggerSweepOptions& options) {
+    unsigned workers = worker_count(options.threads, options.paths);
+    std::vector<TriggerSweep> sweeps(workers, TriggerSweep(params));
+
+    parallel_for_stealing(options.first_seed, options.first_seed + options.paths, workers,
+        [&](size_t worker, uint64_t seed) {
+            sweeps[worker].run(generate_sweep_path(dex, oracle, seed, options.duration_ms));
+        });
+
+    for (size_t w = 1; w < sweeps.size(); ++w) {
+        sweeps[0].merge(sweeps[w]);
+    }
+    return std::move(sweeps[0]);
+}
+
+}
@@ -2,8 +2,10 @@
 
 #include <string>
 #include <cstdint>
+#include <optional>
 #include <vector>
 #include <nlohmann/json.hpp>
+#include "fixed_point.hpp"
 
 namespace sim_core {
 
@@ -12,19 +14,122 @@ enum class SourceKind {
     Chainlink
 };
 
+// Why an oracle feed published a round
+enum class PublishTrigger : uint8_t {
+    None,
+    First,
+    Deviation,
+    Heartbeat
+};
+
+inline const char* trigger_name(PublishTrigger trigger) {
+    switch (trigger) {
+        case PublishTrigger::First: return "first";
+        case PublishTrigger::Deviation: return "deviation";
+        case PublishTrigger::Heartbeat: return "heartbeat";
+        default: return "none";
+    }
+}
+
 struct PriceMsg {
     uint64_t ts;
     std::string pair;
-    double price;
+    Price price;
     SourceKind source;
     uint64_t src_seq;
     uint32_t delay_ms;
     bool stale;
+    std::optional<double> log_weight{};  // importance-sampling log likelihood ratio
+    std::optional<uint64_t> path{};      // live path the weight belongs to
+    bool path_end = false;               // last tick of that path: log_weight is final
 };
 
+// Compact fixed-size form of a PriceMsg for stored history and binary
+// encoding. The pair is replaced by a per-server feed index.
+struct PriceRecord {
+    uint64_t ts;
+    uint64_t src_seq;
+    int64_t price_raw;
+    uint32_t delay_ms;
+    uint16_t feed;
+    uint8_t decimals;
+    uint8_t flags;
+
+    static constexpr uint8_t kChainlink = 1 << 0;
+    static constexpr uint8_t kStale = 1 << 1;
+    static constexpr size_t kEncodedSize = 32;
+    static constexpr size_t kMaxFeeds = size_t{1} << 16;  // feed index width
+};
+
+static_assert(sizeof(PriceRecord) == PriceRecord::kEncodedSize);
+
+inline PriceRecord to_record(const PriceMsg& msg, uint16_t feed) {
+    uint8_t flags = 0;
+    if (msg.source == SourceKind::Chainlink) flags |= PriceRecord::kChainlink;
+    if (msg.stale) flags |= PriceRecord::kStale;
+
+    return PriceRecord{
+        msg.ts,
+        msg.src_seq,
+        msg.price.raw,
+        msg.delay_ms,
+        feed,
+        msg.price.decimals,
+        flags
+    };
+}
+
+inline PriceMsg from_record(const PriceRecord& record, std::string pair) {
+    return PriceMsg{
+        record.ts,
+        std::move(pair),
+        Price{record.price_raw, record.decimals},
+        (record.flags & PriceRecord::kChainlink) ? SourceKind::Chainlink : SourceKind::Dex,
+        record.src_seq,
+        record.delay_ms,
+        (record.flags & PriceRecord::kStale) != 0
+    };
+}
+
+// Little-endian wire encoding of a PriceRecord, independent of host layout
+inline void encode_record(const PriceRecord& record, uint8_t* out) {
+    auto put = [&out](uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; ++i) {
+            *out++ = static_cast<uint8_t>(value >> (8 * i));
+        }
+    };
+    put(record.ts, 8);
+    put(record.src_seq, 8);
+    put(static_cast<uint64_t>(record.price_raw), 8);
+    put(record.delay_ms, 4);
+    put(record.feed, 2);
+    put(record.decimals, 1);
+    put(record.flags, 1);
+}
+
+inline PriceRecord decode_record(const uint8_t* in) {
+    auto get = [&in](int bytes) {
+        uint64_t value = 0;
+        for (int i = 0; i < bytes; ++i) {
+            value |= static_cast<uint64_t>(*in++) << (8 * i);
+        }
+        return value;
+    };
+    PriceRecord record;
+    record.ts = get(8);
+    record.src_seq = get(8);
+    record.price_raw = static_cast<int64_t>(get(8));
+    record.delay_ms = static_cast<uint32_t>(get(4));
+    record.feed = static_cast<uint16_t>(get(2));
+    record.decimals = static_cast<uint8_t>(get(1));
+    record.flags = static_cast<uint8_t>(get(1));
+    return record;
+}
+
 struct SubscriptionMsg {
     std::string id;
     std::string status;
+    std::string client;
 };
 
 struct PriceSnapshot {
@@ -36,18 +141,27 @@ inline void to_json(nlohmann::json& j, const PriceMsg& p) {
     j = nlohmann::json{
         {"ts", p.ts},
         {"pair", p.pair},
-        {"price", p.price},
+        {"price", p.price.to_double()},
         {"source", p.source == SourceKind::Dex ? "dex" : "chainlink"},
         {"src_seq", p.src_seq},
         {"delay_ms", p.delay_ms},
         {"stale", p.stale}
     };
+    if (p.log_weight.has_value()) {
+        j["log_weight"] = *p.log_weight;
+    }
+    if (p.path.has_value()) {
+        j["path"] = *p.path;
+    }
+    if (p.path_end) {
+        j["path_end"] = true;
+    }
 }
 
 inline void from_json(const nlohmann::json& j, PriceMsg& p) {
     j.at("ts").get_to(p.ts);
     j.at("pair").get_to(p.pair);
-    j.at("price").get_to(p.price);
+    p.price = Price::from_double(j.at("price").get<double>(), j.value("decimals", kDefaultPriceDecimals));
 
     std::string source_str = j.at("source").get<std::string>();
     p.source = (source_str == "dex") ? SourceKind::Dex : SourceKind::Chainlink;
@@ -55,6 +169,13 @@ inline void from_json(const nlohmann::json& j, PriceMsg& p) {
     j.at("src_seq").get_to(p.src_seq);
     j.at("delay_ms").get_to(p.delay_ms);
     j.at("stale").get_to(p.stale);
+    if (j.contains("log_weight")) {
+        p.log_weight = j.at("log_weight").get<double>();
+    }
+    if (j.contains("path")) {
+        p.path = j.at("path").get<uint64_t>();
+    }
+    p.path_end = j.value("path_end", false);
 }
 
 inline void to_json(nlohmann::json& j, const SubscriptionMsg& s) {
@@ -63,6 +184,9 @@ inline void to_json(nlohmann::json& j, const SubscriptionMsg& s) {
         {"id", s.id},
         {"status", s.status}
     };
+    if (!s.client.empty()) {
+        j["client"] = s.client;
+    }
 }
 
 inline void to_json(nlohmann::json& j, const PriceSnapshot& s) {
@@ -89,10 +213,11 @@ struct WsMessage {
         return msg;
     }
 
-    static WsMessage create_subscription(const std::string& id, const std::string& status) {
+    static WsMessage create_subscription(const std::string& id, const std::string& status,
+                                         const std::string& client = "") {
         WsMessage msg;
         msg.type = Type::Subscription;
-        msg.subscription = {id, status};
+        msg.subscription = {id, status, client};
         return msg;
     }
 
@@ -2,14 +2,24 @@
 
 #include <chrono>
 #include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "clock.hpp"
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#endif
 
 namespace sim_core {
 
+// Wall-clock milliseconds since the Unix epoch, from the TSC clock
 inline uint64_t current_time_ms() {
-    using namespace std::chrono;
-    auto now = system_clock::now();
-    auto duration = now.time_since_epoch();
-    return duration_cast<milliseconds>(duration).count();
+    return static_cast<uint64_t>(fast_clock().wall_ns() / 1'000'000);
 }
 
 inline std::pair<std::string, uint16_t> parse_bind_address(const std::string& bind_addr) {
@@ -24,4 +34,64 @@ inline std::pair<std::string, uint16_t> parse_bind_address(const std::string& bi
     return {host, port};
 }
 
+// Decodes a query string component: %XX escapes and '+' for space. Throws
+// std::invalid_argument on a truncated or non-hex escape.
+inline std::string url_decode(std::string_view text) {
+    auto hex = [text](char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        throw std::invalid_argument("Malformed escape in query: " + std::string(text));
+    };
+
+    std::string out;
+    out.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '+') {
+            out += ' ';
+        } else if (text[i] == '%') {
+            if (i + 2 >= text.size()) {
+                throw std::invalid_argument("Malformed escape in query: " + std::string(text));
+            }
+            out += static_cast<char>(hex(text[i + 1]) * 16 + hex(text[i + 2]));
+            i += 2;
+        } else {
+            out += text[i];
+        }
+    }
+    return out;
+}
+
+// Decoded value of key in the query string of a request target, e.g.
+// query_param("/ws/ticks?tier=critical", "tier") == "critical"
+inline std::optional<std::string> query_param(std::string_view target, std::string_view key) {
+    auto q = target.find('?');
+    if (q == std::string_view::npos) return std::nullopt;
+
+    std::string_view query = target.substr(q + 1);
+    while (!query.empty()) {
+        auto amp = query.find('&');
+        std::string_view item = query.substr(0, amp);
+        auto eq = item.find('=');
+        if (url_decode(item.substr(0, eq)) == key) {
+            return url_decode(eq == std::string_view::npos ? std::string_view{} : item.substr(eq + 1));
+        }
+        if (amp == std::string_view::npos) break;
+        query.remove_prefix(amp + 1);
+    }
+    return std::nullopt;
+}
+
+// Bytes currently allocated from the heap, or 0 where the allocator can't tell
+inline size_t heap_bytes_in_use() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    auto info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#elif defined(__APPLE__)
+    return mstats().bytes_used;
+#else
+    return 0;
+#endif
+}
+
 }
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace sim_core {
+
+// Hands out the items of [begin, end) to a fixed set of workers. Each worker
+// owns a contiguous share and takes items from its front; a worker that runs
+// dry steals the back half of another worker's remaining share, so uneven
+// per-item cost still keeps every core busy.
+class WorkStealingRange {
+private:
+    struct alignas(64) Share {
+        std::mutex mutex;
+        uint64_t next = 0;
+        uint64_t end = 0;
+    };
+
+    std::unique_ptr<Share[]> shares_;
+    size_t workers_;
+
+public:
+    WorkStealingRange(uint64_t begin, uint64_t end, size_t workers)
+        : shares_(std::make_unique<Share[]>(std::max<size_t>(workers, 1))),
+          workers_(std::max<size_t>(workers, 1))
+    {
+        uint64_t count = end > begin ? end - begin : 0;
+        for (size_t w = 0; w < workers_; ++w) {
+            shares_[w].next = begin + count * w / workers_;
+            shares_[w].end = begin + count * (w + 1) / workers_;
+        }
+    }
+
+    std::optional<uint64_t> next(size_t worker) {
+        Share& own = shares_[worker];
+        {
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (own.next < own.end) return own.next++;
+        }
+
+        for (size_t i = 1; i < workers_; ++i) {
+            Share& victim = shares_[(worker + i) % workers_];
+            uint64_t from = 0;
+            uint64_t to = 0;
+            {
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                uint64_t left = victim.end - victim.next;
+                if (left == 0) continue;
+                to = victim.end;
+                victim.end -= (left + 1) / 2;
+                from = victim.end;
+            }
+
+            std::lock_guard<std::mutex> lock(own.mutex);
+            own.next = from + 1;
+            own.end = to;
+            return from;
+        }
+        return std::nullopt;
+    }
+};
+
+// Number of workers for `items` items: `threads`, or one per core when 0
+inline unsigned worker_count(unsigned threads, uint64_t items) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    return static_cast<unsigned>(std::min<uint64_t>(threads, std::max<uint64_t>(items, 1)));
+}
+
+// Calls fn(worker, item) for every item of [begin, end) on `workers`
+// threads, the caller being worker 0. The first exception stops the other
+// workers after their current item and is rethrown.
+template<typename Fn>
+void parallel_for_stealing(uint64_t begin, uint64_t end, unsigned workers, Fn&& fn) {
+    WorkStealingRange range(begin, end, workers);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    std::atomic<bool> failed{false};
+
+    auto work = [&](size_t worker) {
+        try {
+            while (!failed.load(std::memory_order_relaxed)) {
+                auto item = range.next(worker);
+                if (!item.has_value()) break;
+                fn(worker, *item);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) error = std::current_exception();
+            failed = true;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t w = 1; w < workers; ++w) {
+        pool.emplace_back(work, w);
+    }
+    work(0);
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+}
@@ -0,0 +1,656 @@
+#pragma once
+
+#include "slot_map.hpp"
+#include "delivery_order.hpp"
+#include "send_scheduler.hpp"
+#include "metrics.hpp"
+#include "load_shedder.hpp"
+#include "utils.hpp"
+#include "timer_wheel.hpp"
+#include "token_bucket.hpp"
+#include "tracked_socket.hpp"
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+#include <spdlog/spdlog.h>
+
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+namespace sim_core {
+
+// A live subscriber socket as passed to a replacement process, with the
+// bytes of a client frame read only in part
+struct HandoffClient {
+    int fd;
+    Tier tier;
+    BandwidthLimit limit{};
+    std::string unread{};
+};
+
+inline uint64_t parse_byte_count(std::string_view name, const std::string& value) {
+    uint64_t n = 0;
+    const char* end = value.data() + value.size();
+    auto [ptr, ec] = std::from_chars(value.data(), end, n);
+    if (ec != std::errc{} || ptr != end) {
+        throw std::invalid_argument("Invalid " + std::string(name) + ": " + value);
+    }
+    return n;
+}
+
+// Bandwidth limit requested in a subscribe URL (?rate=<bytes/s>&burst=<bytes>),
+// falling back to the configured default. Rate and burst are clamped to max
+// where it sets one, so unlimited (0) becomes the max. Throws
+// std::invalid_argument on a value that is not a plain decimal count.
+inline BandwidthLimit parse_bandwidth_limit(std::string_view target, BandwidthLimit fallback, BandwidthLimit max = {}) {
+    BandwidthLimit limit = fallback;
+    if (auto rate = query_param(target, "rate")) {
+        limit.bytes_per_sec = parse_byte_count("rate", *rate);
+    }
+    if (auto burst = query_param(target, "burst")) {
+        limit.burst_bytes = parse_byte_count("burst", *burst);
+    }
+    if (max.bytes_per_sec > 0 && (limit.unlimited() || limit.bytes_per_sec > max.bytes_per_sec)) {
+        limit.bytes_per_sec = max.bytes_per_sec;
+    }
+    if (max.burst_bytes > 0 && limit.burst() > max.burst_bytes) {
+        limit.burst_bytes = max.burst_bytes;
+    }
+    return limit;
+}
+
+// WebSocket subscriber registry shared by the DEX and oracle servers.
+// Broadcasts queue a shared frame on every client, higher tiers first and in
+// a per-tick fair order within a tier, then a TierScheduler hands queued
+// frames to async writes, at most max_in_flight at a time. Once the total
+// backlog reaches conflate_backlog, lower tiers keep only the newest frame
+// per pair, or always while the load mode is degraded. Clients with a
+// bandwidth limit wait out their token bucket on the hub's timer wheel
+// before their next frame is written; their queues always conflate, are
+// capped, and are kept out of the backlog that triggers global conflation.
+class WsHub {
+public:
+    // Plain socket rather than beast::tcp_stream: subscribers need no
+    // per-operation timeouts, and this saves the stream's timers per connection.
+    // The socket tracks partial frames so a handoff can carry them over.
+    using Stream = boost::beast::websocket::stream<TrackedSocket>;
+
+    // Above this many clients /metrics reports one aggregate rank histogram
+    // instead of one per client.
+    static constexpr size_t kMaxLabeledClients = 64;
+
+    // Resolution of the timer wheel (keepalive and throttling)
+    static constexpr uint64_t kTimerTickMs = 10;
+
+    // Frames a bandwidth-limited client may queue; the oldest is dropped beyond it
+    static constexpr size_t kThrottledQueueFrames = 256;
+
+private:
+    struct Client {
+        std::shared_ptr<Stream> ws;
+        Tier tier = Tier::Normal;
+        RankHistogram ranks;
+        SubscriberQueue queue;
+        bool active = false;
+        bool ready = false;      // listed in scheduler_
+        bool in_flight = false;  // async write outstanding
+        bool ping_in_flight = false;
+        bool throttled = false;  // waiting on a throttle timer for tokens
+        bool reads_stopped = false;  // read cancelled for a handoff
+        uint64_t last_activity = 0;  // keepalive tick of the last frame or pong received
+        TokenBucket bucket;
+        RecordDigest digest;  // ticks handed to the socket, in order
+    };
+
+    struct Timer {
+        enum class Kind : uint8_t { Keepalive, Throttle };
+        SlotId id;
+        Kind kind;
+    };
+
+    SlotMap<Client> clients_;
+    DeliveryOrder order_;
+    TierScheduler scheduler_;
+    size_t max_in_flight_;
+    size_t conflate_backlog_;
+    size_t in_flight_ = 0;
+    LoadMode mode_ = LoadMode::Normal;
+    size_t heap_baseline_ = 0;  // heap in use when the last client set started from empty
+    std::array<size_t, kTierCount> backlog_{};
+    size_t throttled_backlog_ = 0;  // queued for bandwidth-limited clients
+
+    // At most one outstanding keepalive and one throttle timer per client.
+    // Keepalive is disabled with 0 ticks.
+    TimerWheel<Timer> timers_;
+    uint64_t ping_ticks_ = 0;
+    uint64_t idle_ticks_ = 0;
+    int64_t epoch_ns_ = fast_clock().monotonic_ns();
+
+    // While handing off no writes, pings or evictions start and no clients join
+    bool handing_off_ = false;
+    size_t pending_read_stops_ = 0;
+
+    mutable std::mutex mutex_;
+
+    int64_t now_ns() const {
+        return fast_clock().monotonic_ns() - epoch_ns_;
+    }
+
+    uint64_t now_tick() const {
+        return static_cast<uint64_t>(now_ns()) / (kTimerTickMs * 1000000);
+    }
+
+    bool keepalive_enabled() const { return ping_ticks_ > 0 || idle_ticks_ > 0; }
+
+    void schedule_keepalive(SlotId id, const Client& client, uint64_t now) {
+        uint64_t next = UINT64_MAX;
+        if (ping_ticks_ > 0) {
+            uint64_t ping_at = client.last_activity + ping_ticks_;
+            next = ping_at > now ? ping_at : now + ping_ticks_;
+        }
+        if (idle_ticks_ > 0) {
+            next = std::min(next, client.last_activity + idle_ticks_);
+        }
+        timers_.schedule(next, Timer{id, Timer::Kind::Keepalive});
+    }
+
+    void on_timer(const Timer& timer, uint64_t now) {
+        if (timer.kind == Timer::Kind::Keepalive) {
+            on_keepalive_timer(timer.id, now);
+        } else if (Client* client = clients_.get(timer.id)) {
+            client->throttled = false;
+            mark_ready(timer.id, *client);
+        }
+    }
+
+    void on_keepalive_timer(SlotId id, uint64_t now) {
+        Client* client = clients_.get(id);
+        if (client == nullptr) return;
+        if (handing_off_) {
+            schedule_keepalive(id, *client, now);
+            return;
+        }
+
+        uint64_t idle = now - client->last_activity;
+        if (idle_ticks_ > 0 && idle >= idle_ticks_) {
+            spdlog::info("Evicting idle client {}", id.to_string());
+            close_socket(client->ws);
+            erase_locked(id);
+            get_metrics().ws_idle_evictions++;
+            return;
+        }
+
+        if (ping_ticks_ > 0 && idle >= ping_ticks_ && !client->ping_in_flight) {
+            client->ping_in_flight = true;
+            auto ws = client->ws;
+            boost::asio::dispatch(ws->get_executor(), [this, id, ws] {
+                ws->async_ping({}, [this, id, ws](boost::beast::error_code ec) {
+                    on_ping(id, ec);
+                });
+            });
+            get_metrics().ws_pings_sent++;
+        }
+
+        schedule_keepalive(id, *client, now);
+    }
+
+    void on_ping(SlotId id, boost::beast::error_code ec) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (Client* client = clients_.get(id)) {
+            client->ping_in_flight = false;
+            if (ec) {
+                erase_locked(id);
+            }
+        }
+    }
+
+    static void close_socket(const std::shared_ptr<Stream>& ws) {
+        boost::asio::dispatch(ws->get_executor(), [ws] {
+            boost::beast::error_code ec;
+            ws->next_layer().close(ec);
+        });
+    }
+
+    size_t total_backlog() const {
+        size_t total = 0;
+        for (size_t b : backlog_) total += b;
+        return total;
+    }
+
+    size_t& backlog_of(const Client& client) {
+        return client.bucket.unlimited() ? backlog_[static_cast<size_t>(client.tier)] : throttled_backlog_;
+    }
+
+    void mark_ready(SlotId id, Client& client) {
+        if (!client.ready && !client.in_flight && !client.throttled && !client.queue.empty()) {
+            client.ready = true;
+            scheduler_.push(client.tier, id);
+        }
+    }
+
+    // Starts writes for scheduled clients until the in-flight limit is hit
+    void pump() {
+        while (in_flight_ < max_in_flight_ && !handing_off_) {
+            auto id = scheduler_.pop();
+            if (!id) return;
+
+            Client* client = clients_.get(*id);
+            if (client == nullptr) continue;
+
+            client->ready = false;
+
+            if (!client->bucket.unlimited()) {
+                size_t bytes = client->queue.front()->payload.size();
+                if (!client->bucket.try_consume(bytes, now_ns())) {
+                    // Same effect as a slow link: frames wait in the queue
+                    int64_t wait_ticks = client->bucket.wait_ns(bytes) / static_cast<int64_t>(kTimerTickMs * 1000000) + 1;
+                    client->throttled = true;
+                    timers_.schedule(now_tick() + static_cast<uint64_t>(wait_ticks), Timer{*id, Timer::Kind::Throttle});
+                    get_metrics().ws_sends_throttled++;
+                    continue;
+                }
+            }
+
+            client->in_flight = true;
+            in_flight_++;
+            backlog_of(*client)--;
+
+            // Writes are started on the stream's own executor, which may be
+            // another I/O thread than the ticker's
+            auto frame = client->queue.pop();
+            if (frame->record) client->digest.add(*frame->record);
+            client->ranks.record(frame->writes_started++);
+
+            auto ws = client->ws;
+            boost::asio::dispatch(ws->get_executor(), [this, id = *id, ws, frame = std::move(frame)]() mutable {
+                const std::string& payload = frame->payload;
+                ws->async_write(
+                    boost::asio::buffer(payload),
+                    [this, id, ws, frame = std::move(frame)](boost::beast::error_code ec, size_t) {
+                        on_write(id, ec);
+                    });
+            });
+        }
+    }
+
+    void on_write(SlotId id, boost::beast::error_code ec) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        in_flight_--;
+
+        if (Client* client = clients_.get(id)) {
+            client->in_flight = false;
+            if (ec) {
+                spdlog::warn("Failed to send to client {}: {}", id.to_string(), ec.message());
+                erase_locked(id);
+            } else {
+                mark_ready(id, *client);
+            }
+        }
+        pump();
+    }
+
+    void erase_locked(SlotId id) {
+        if (const Client* client = clients_.get(id)) {
+            backlog_of(*client) -= client->queue.size();
+            clients_.erase(id);
+        }
+    }
+
+public:
+    WsHub(SendOrder order, std::mt19937_64 rng, size_t max_in_flight = 64, size_t conflate_backlog = 1024)
+        : order_(order, std::move(rng)),
+          max_in_flight_(std::max<size_t>(max_in_flight, 1)),
+          conflate_backlog_(conflate_backlog)
+    {}
+
+    // Registers a client; it receives broadcasts once activate() is called,
+    // so the handshake reply can be written first without interleaving.
+    // Returns an invalid id for dashboard clients while shedding.
+    SlotId add(std::shared_ptr<Stream> ws, Tier tier = Tier::Normal, BandwidthLimit limit = {}) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (handing_off_) {
+            return SlotId{};
+        }
+        if (mode_ == LoadMode::Shedding && tier == Tier::Dashboard) {
+            get_metrics().ws_clients_shed++;
+            return SlotId{};
+        }
+        if (clients_.empty()) {
+            heap_baseline_ = heap_bytes_in_use();
+        }
+        ws->next_layer().track_frames();
+        Client client;
+        client.ws = std::move(ws);
+        client.tier = tier;
+        if (!limit.unlimited()) {
+            client.bucket = TokenBucket(limit, now_ns());
+        }
+        return clients_.insert(std::move(client));
+    }
+
+    // Call on the client's executor. Pongs count as activity for keepalive.
+    void activate(SlotId id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Client* client = clients_.get(id);
+        if (client == nullptr) return;
+
+        client->active = true;
+        if (keepalive_enabled()) {
+            uint64_t now = now_tick();
+            client->last_activity = now;
+            client->ws->control_callback([this, id](boost::beast::websocket::frame_type kind, boost::beast::string_view) {
+                if (kind == boost::beast::websocket::frame_type::pong) {
+                    touch(id);
+                }
+            });
+            schedule_keepalive(id, *client, now);
+        }
+    }
+
+    // Records that a frame was received from the client
+    void touch(SlotId id) {
+        if (!keepalive_enabled()) return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (Client* client = clients_.get(id)) {
+            client->last_activity = now_tick();
+        }
+    }
+
+    // Pings clients quiet for ping_interval_ms, closes ones quiet for
+    // idle_timeout_ms; 0 disables either. Driven by run_timers().
+    void set_keepalive(uint64_t ping_interval_ms, uint64_t idle_timeout_ms) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ping_ticks_ = (ping_interval_ms + kTimerTickMs - 1) / kTimerTickMs;
+        idle_ticks_ = (idle_timeout_ms + kTimerTickMs - 1) / kTimerTickMs;
+    }
+
+    // Fires due keepalive and throttle timers, then resumes sends
+    void advance_timers() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t now = now_tick();
+        timers_.advance(now, [this, now](const Timer& timer) { on_timer(timer, now); });
+        pump();
+    }
+
+    // A session whose read was cancelled for a handoff ends here too; its
+    // client stays registered so the socket can be handed over
+    void remove(SlotId id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (const Client* client = clients_.get(id); client != nullptr && client->reads_stopped) return;
+        erase_locked(id);
+    }
+
+    // Degraded modes conflate lower tiers regardless of backlog; shedding
+    // also closes every dashboard client with "try again later".
+    void set_load_mode(LoadMode mode) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        mode_ = mode;
+        if (mode != LoadMode::Shedding) return;
+
+        std::vector<SlotId> shed;
+        for (size_t i = 0; i < clients_.size(); ++i) {
+            if (clients_.value_at(i).tier == Tier::Dashboard) {
+                shed.push_back(clients_.id_at(i));
+            }
+        }
+        for (SlotId id : shed) {
+            const Client* client = clients_.get(id);
+            auto ws = client->ws;
+            if (client->ping_in_flight) {
+                // only one control frame may be outstanding
+                close_socket(ws);
+            } else {
+                boost::asio::dispatch(ws->get_executor(), [ws] {
+                    ws->async_close(boost::beast::websocket::close_code::try_again_later,
+                        [ws](boost::beast::error_code) {});
+                });
+            }
+            erase_locked(id);
+            get_metrics().ws_clients_shed++;
+        }
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return clients_.size();
+    }
+
+    // Queues payload on every active client. key names the stream the frame
+    // belongs to (the pair) and decides what conflation may replace; record,
+    // if given, is folded into each client's digest as the frame is sent.
+    void broadcast(const std::string& key, std::string payload, std::optional<DigestRecord> record = std::nullopt) {
+        auto frame = std::make_shared<const OutboundFrame>(OutboundFrame{key, std::move(payload), record});
+
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        bool loaded = mode_ != LoadMode::Normal || total_backlog() >= conflate_backlog_;
+        const auto& order = order_.next_round(clients_.size());
+
+        for (size_t t = 0; t < kTierCount; ++t) {
+            auto tier = static_cast<Tier>(t);
+            bool conflate = loaded && tier != Tier::Critical;
+
+            for (uint32_t slot : order) {
+                auto& client = clients_.value_at(slot);
+                if (!client.active || client.tier != tier) continue;
+
+                // A throttled client falls behind by choice, so it only
+                // ever loses its own frames
+                bool limited = !client.bucket.unlimited();
+                if (client.queue.push(frame, conflate || limited)) {
+                    get_metrics().ws_frames_conflated++;
+                } else if (limited && client.queue.size() > kThrottledQueueFrames) {
+                    client.queue.pop();
+                    get_metrics().ws_frames_conflated++;
+                } else {
+                    backlog_of(client)++;
+                }
+                mark_ready(clients_.id_at(slot), client);
+            }
+        }
+
+        pump();
+    }
+
+    // Nothing queued and no write outstanding
+    bool drained() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return in_flight_ == 0 && total_backlog() == 0 && throttled_backlog_ == 0;
+    }
+
+    // Handoff, in order: freeze_for_handoff() stops new writes, pings and
+    // clients; once writes_idle(), stop_reads() cancels every session's read
+    // on its own executor so this process consumes no more input; once
+    // reads_stopped(), handoff_clients() lists the sockets to pass on.
+    void freeze_for_handoff() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        handing_off_ = true;
+    }
+
+    // No frame or ping is partly written
+    bool writes_idle() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (in_flight_ > 0) return false;
+        for (size_t i = 0; i < clients_.size(); ++i) {
+            if (clients_.value_at(i).ping_in_flight) return false;
+        }
+        return true;
+    }
+
+    void stop_reads() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < clients_.size(); ++i) {
+            auto& client = clients_.value_at(i);
+            if (!client.active || client.reads_stopped) continue;
+            client.reads_stopped = true;
+            pending_read_stops_++;
+            // posted: dispatch could run it inline while mutex_ is held
+            auto ws = client.ws;
+            boost::asio::post(ws->get_executor(), [this, ws] {
+                boost::beast::error_code ec;
+                ws->next_layer().stop_reads(ec);
+                std::lock_guard<std::mutex> lock(mutex_);
+                pending_read_stops_--;
+            });
+        }
+    }
+
+    bool reads_stopped() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pending_read_stops_ == 0;
+    }
+
+    // Duplicated socket fds, tiers, limits and partly read frames of clients
+    // whose reads were stopped and that are between frames they write and
+    // not inside one too large to carry, for passing to a replacement process
+    std::vector<HandoffClient> handoff_clients() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<HandoffClient> out;
+        for (size_t i = 0; i < clients_.size(); ++i) {
+            const auto& client = clients_.value_at(i);
+            if (!client.reads_stopped || client.in_flight || client.ping_in_flight) continue;
+            auto unread = client.ws->next_layer().unread();
+            if (!unread.has_value()) continue;
+            out.push_back(HandoffClient{
+                ::dup(client.ws->next_layer().native_handle()), client.tier, client.bucket.limit(), std::move(*unread)
+            });
+        }
+        return out;
+    }
+
+    // Resumes after a failed handoff. Clients whose reads were stopped have
+    // no session left, so they are closed and reconnect.
+    void abort_handoff() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<SlotId> stopped;
+        for (size_t i = 0; i < clients_.size(); ++i) {
+            if (clients_.value_at(i).reads_stopped) stopped.push_back(clients_.id_at(i));
+        }
+        for (SlotId id : stopped) {
+            close_socket(clients_.get(id)->ws);
+            erase_locked(id);
+        }
+        handing_off_ = false;
+        pump();
+    }
+
+    size_t backlog() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return total_backlog();
+    }
+
+    // Per-client digest of the ticks sent so far; conflated frames are not
+    // sent and so not included. Part of the /digest body.
+    nlohmann::json digests() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        nlohmann::json out = nlohmann::json::array();
+        for (size_t i = 0; i < clients_.size(); ++i) {
+            const auto& client = clients_.value_at(i);
+            out.push_back({{"client", clients_.id_at(i).to_string()}, {"tier", tier_name(client.tier)},
+                           {"ticks", client.digest.records}, {"digest", digest_hex(client.digest.value())}});
+        }
+        return out;
+    }
+
+    // Prometheus delivery-rank histogram, labeled by client id, and per-tier backlog
+    std::string to_prometheus() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::ostringstream oss;
+
+        oss << "# HELP ws_delivery_rank Position at which a frame's write to a client started among its subscribers (0 = first)\n";
+        oss << "# TYPE ws_delivery_rank histogram\n";
+
+        auto write = [&oss](const std::string& labels, const RankHistogram& ranks) {
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i < RankHistogram::kBuckets; ++i) {
+                cumulative += ranks.buckets[i];
+                oss << "ws_delivery_rank_bucket{" << labels << "le=\"" << RankHistogram::upper_bound(i)
+                    << "\"} " << cumulative << "\n";
+            }
+            std::string plain = labels.empty() ? "" : "{" + labels.substr(0, labels.size() - 1) + "}";
+            oss << "ws_delivery_rank_sum" << plain << " " << ranks.sum << "\n";
+            oss << "ws_delivery_rank_count" << plain << " " << ranks.count << "\n";
+        };
+
+        if (clients_.size() <= kMaxLabeledClients) {
+            for (size_t i = 0; i < clients_.size(); ++i) {
+                write("client=\"" + clients_.id_at(i).to_string() + "\",", clients_.value_at(i).ranks);
+            }
+        } else {
+            RankHistogram total;
+            for (size_t i = 0; i < clients_.size(); ++i) {
+                const auto& ranks = clients_.value_at(i).ranks;
+                for (size_t b = 0; b < RankHistogram::kBuckets; ++b) {
+                    total.buckets[b] += ranks.buckets[b];
+                }
+                total.sum += ranks.sum;
+                total.count += ranks.count;
+            }
+            write("", total);
+        }
+
+        oss << "\n# HELP ws_connections Connected subscribers\n";
+        oss << "# TYPE ws_connections gauge\n";
+        oss << "ws_connections " << clients_.size() << "\n";
+
+        // Heap growth since the subscriber count was last zero, per subscriber.
+        // Approximate: it includes queued frames and anything else allocated since.
+        if (!clients_.empty()) {
+            size_t heap = heap_bytes_in_use();
+            size_t grown = heap > heap_baseline_ ? heap - heap_baseline_ : 0;
+            oss << "\n# HELP ws_connection_bytes Approximate heap bytes per subscriber connection\n";
+            oss << "# TYPE ws_connection_bytes gauge\n";
+            oss << "ws_connection_bytes " << grown / clients_.size() << "\n";
+        }
+
+        if (clients_.size() <= kMaxLabeledClients) {
+            oss << "\n# HELP ws_stream_digest_ticks Ticks folded into the client's stream digest\n";
+            oss << "# TYPE ws_stream_digest_ticks counter\n";
+            for (size_t i = 0; i < clients_.size(); ++i) {
+                oss << "ws_stream_digest_ticks{client=\"" << clients_.id_at(i).to_string() << "\"} "
+                    << clients_.value_at(i).digest.records << "\n";
+            }
+            oss << "\n# HELP ws_stream_digest_info XXH64 of the ticks sent to the client so far\n";
+            oss << "# TYPE ws_stream_digest_info gauge\n";
+            for (size_t i = 0; i < clients_.size(); ++i) {
+                oss << "ws_stream_digest_info{client=\"" << clients_.id_at(i).to_string() << "\",digest=\""
+                    << digest_hex(clients_.value_at(i).digest.value()) << "\"} 1\n";
+            }
+        }
+
+        oss << "\n# HELP ws_send_backlog Frames queued for subscribers, by tier\n";
+        oss << "# TYPE ws_send_backlog gauge\n";
+        for (size_t t = 0; t < kTierCount; ++t) {
+            oss << "ws_send_backlog{tier=\"" << tier_name(static_cast<Tier>(t)) << "\"} " << backlog_[t] << "\n";
+        }
+
+        oss << "\n# HELP ws_send_backlog_throttled Frames queued for bandwidth-limited subscribers\n";
+        oss << "# TYPE ws_send_backlog_throttled gauge\n";
+        oss << "ws_send_backlog_throttled " << throttled_backlog_ << "\n";
+
+        oss << "\n";
+        return oss.str();
+    }
+};
+
+// Drives the hub's timer wheel
+inline boost::asio::awaitable<void> run_timers(WsHub& hub) {
+    auto executor = co_await boost::asio::this_coro::executor;
+    boost::asio::steady_timer timer(executor);
+    auto next = std::chrono::steady_clock::now();
+
+    while (true) {
+        next += std::chrono::milliseconds(WsHub::kTimerTickMs);
+        timer.expires_at(next);
+        co_await timer.async_wait(boost::asio::use_awaitable);
+        hub.advance_timers();
+    }
+}
+
+}
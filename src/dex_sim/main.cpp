@@ -1,9 +1,16 @@
 #include <sim_core/types.hpp>
 #include <sim_core/config.hpp>
 #include <sim_core/rng.hpp>
-#include <sim_core/gbm_engine.hpp>
+#include <sim_core/engine_factory.hpp>
+#include <sim_core/scenario.hpp>
+#include <sim_core/fault_pipeline.hpp>
 #include <sim_core/metrics.hpp>
 #include <sim_core/utils.hpp>
+#include <sim_core/ws_hub.hpp>
+#include <sim_core/io_pool.hpp>
+#include <sim_core/handoff.hpp>
+#include <sim_core/history_stream.hpp>
+#include <sim_core/digest.hpp>
 
 #include <boost/asio.hpp>
 #include <boost/beast.hpp>
@@ -11,12 +18,15 @@
 #include <spdlog/sinks/stdout_color_sinks.h>
 
 #include <memory>
+#include <array>
 #include <mutex>
 #include <vector>
-#include <set>
 #include <fstream>
 #include <chrono>
 #include <optional>
+#include <atomic>
+#include <functional>
+#include <utility>
 
 namespace asio = boost::asio;
 namespace beast = boost::beast;
@@ -27,20 +37,42 @@ using tcp = asio::ip::tcp;
 class DexState {
 private:
     sim_core::DexConfig config_;
-    std::unique_ptr<sim_core::PriceEngine> price_engine_;
+    sim_core::EngineVariant price_engine_;
+    uint64_t next_seq_ = 0;
     mutable std::mutex price_engine_mutex_;
 
     std::optional<sim_core::PriceMsg> last_price_;
     mutable std::mutex last_price_mutex_;
 
-    std::set<std::shared_ptr<websocket::stream<beast::tcp_stream>>> clients_;
-    std::mutex clients_mutex_;
+    sim_core::WsHub hub_;
+
+    sim_core::LoadShedder load_;
+    mutable std::mutex load_mutex_;
+
+    std::atomic<bool> paused_{false};
+
+    sim_core::RunHistory history_;
+    sim_core::StreamDigest digest_;
+
+    // Arrival and fault state owned by the ticker coroutine; both are only
+    // touched on the ticker context, which also serves handoffs
+    std::function<nlohmann::json()> save_ticker_;
+    nlohmann::json resumed_ticker_;
 
 public:
-    explicit DexState(sim_core::DexConfig config, std::unique_ptr<sim_core::PriceEngine> engine)
+    explicit DexState(sim_core::DexConfig config, sim_core::EngineVariant engine)
         : config_(std::move(config))
         , price_engine_(std::move(engine))
-    {}
+        , hub_(sim_core::parse_send_order(config_.server.ws_send_order),
+               sim_core::create_labeled_rng(config_.server.seed, "DEX_SEND_ORDER"),
+               config_.server.ws_max_in_flight,
+               config_.server.ws_conflate_backlog)
+        , load_(config_.server.load_shed)
+        , history_(config_.server.pairs, config_.server.history_rows)
+        , digest_(config_.server.pairs, config_.server.digest_checkpoint_ticks)
+    {
+        hub_.set_keepalive(config_.server.ws_ping_interval_ms, config_.server.ws_idle_timeout_ms);
+    }
 
     const sim_core::DexConfig& config() const { return config_; }
 
@@ -49,102 +81,199 @@ public:
             std::lock_guard<std::mutex> lock(last_price_mutex_);
             last_price_ = msg;
         }
+        history_.record_tick(msg, 0);
+        auto record = digest_.record(msg, 0);
 
         spdlog::info("price_tick source={} pair={} price={:.4f} seq={} delay_ms={} stale={}",
             msg.source == sim_core::SourceKind::Dex ? "dex" : "chainlink",
-            msg.pair, msg.price, msg.src_seq, msg.delay_ms, msg.stale);
+            msg.pair, msg.price.to_double(), msg.src_seq, msg.delay_ms, msg.stale);
 
         auto ws_msg = sim_core::WsMessage::create_price(msg);
         std::string json_str = ws_msg.to_json_string();
 
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        for (auto& client : clients_) {
-            try {
-                client->write(asio::buffer(json_str));
-            } catch (const std::exception& e) {
-                spdlog::warn("Failed to broadcast to client: {}", e.what());
-            }
+        hub_.broadcast(msg.pair, std::move(json_str), record);
+    }
+
+    sim_core::WsHub& hub() { return hub_; }
+
+    sim_core::RunHistory& history() { return history_; }
+
+    const sim_core::StreamDigest& digest() const { return digest_; }
+
+    // Feeds a ticker lag sample to the load shedder and applies mode changes
+    sim_core::LoadMode update_load(double lag_ms) {
+        std::lock_guard<std::mutex> lock(load_mutex_);
+        size_t backlog = hub_.backlog();
+        if (load_.update(lag_ms, backlog)) {
+            auto mode = load_.mode();
+            hub_.set_load_mode(mode);
+            spdlog::set_level(mode == sim_core::LoadMode::Normal ? spdlog::level::info : spdlog::level::warn);
+            spdlog::warn("load_mode={} ticker_lag_ms={:.1f} backlog={}",
+                sim_core::load_mode_name(mode), load_.lag_ms(), backlog);
         }
+        return load_.mode();
     }
 
-    void add_client(std::shared_ptr<websocket::stream<beast::tcp_stream>> client) {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        clients_.insert(client);
+    sim_core::LoadMode load_mode() const {
+        std::lock_guard<std::mutex> lock(load_mutex_);
+        return load_.mode();
     }
 
-    void remove_client(std::shared_ptr<websocket::stream<beast::tcp_stream>> client) {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        clients_.erase(client);
+    std::string load_metrics() const {
+        std::lock_guard<std::mutex> lock(load_mutex_);
+        return load_.to_prometheus();
     }
 
     sim_core::PriceMsg generate_tick(uint64_t ts, uint64_t seq, uint32_t delay_ms, bool stale) {
         std::lock_guard<std::mutex> lock(price_engine_mutex_);
-        return price_engine_->next_tick(ts, seq, sim_core::SourceKind::Dex, delay_ms, stale);
+        next_seq_ = seq + 1;
+        return sim_core::next_tick(price_engine_, ts, seq, sim_core::SourceKind::Dex, delay_ms, stale);
     }
 
     std::optional<sim_core::PriceMsg> get_last_price() const {
         std::lock_guard<std::mutex> lock(last_price_mutex_);
         return last_price_;
     }
+
+    uint64_t next_seq() const {
+        std::lock_guard<std::mutex> lock(price_engine_mutex_);
+        return next_seq_;
+    }
+
+    bool paused() const { return paused_; }
+
+    // Registered by the ticker so a handoff snapshot includes its state
+    void set_ticker_save(std::function<nlohmann::json()> save) { save_ticker_ = std::move(save); }
+
+    // Ticker state from a handoff, or null; taken once at ticker start
+    nlohmann::json take_resumed_ticker() { return std::exchange(resumed_ticker_, nullptr); }
+
+    // Stops ticking and returns the state a replacement process resumes from
+    nlohmann::json pause_for_handoff() {
+        paused_ = true;
+        nlohmann::json j;
+        {
+            std::lock_guard<std::mutex> lock(price_engine_mutex_);
+            j["seq"] = next_seq_;
+            j["engine"] = sim_core::save_engine(price_engine_);
+        }
+        auto last = get_last_price();
+        j["last"] = last.has_value() ? nlohmann::json(*last) : nlohmann::json(nullptr);
+        if (last.has_value()) {
+            j["last"]["decimals"] = last->price.decimals;
+        }
+        j["digest"] = digest_.save();
+        j["ticker"] = save_ticker_ ? save_ticker_() : nlohmann::json(nullptr);
+        return j;
+    }
+
+    void resume_after_handoff() { paused_ = false; }
+
+    void restore(const nlohmann::json& j) {
+        std::lock_guard<std::mutex> lock(price_engine_mutex_);
+        next_seq_ = j.at("seq").get<uint64_t>();
+        sim_core::restore_engine(price_engine_, j.at("engine"));
+        if (!j.at("last").is_null()) {
+            std::lock_guard<std::mutex> last_lock(last_price_mutex_);
+            last_price_ = j.at("last").get<sim_core::PriceMsg>();
+        }
+        digest_.restore(j.at("digest"));
+        resumed_ticker_ = j.at("ticker");
+    }
 };
 
-asio::awaitable<void> run_price_ticker(std::shared_ptr<DexState> state) {
+// Ticks run against absolute deadlines so lateness can be measured. In normal
+// mode a late tick re-anchors the schedule (no catch-up); when degraded, overdue
+// ticks are generated back to back in one wake-up, up to kMaxTickBatch.
+template<typename Faults>
+asio::awaitable<void> run_price_ticker(std::shared_ptr<DexState> state, Faults faults) {
+    constexpr int kMaxTickBatch = 32;
+
     auto executor = co_await asio::this_coro::executor;
     const auto& config = state->config();
 
-    auto rng = sim_core::create_labeled_rng(config.server.seed, "DEX_TICKER");
-    uint64_t seq = 0;
-    auto last_tick_time = std::chrono::steady_clock::now();
-
+    auto arrivals = sim_core::make_arrival_process(config);
+    double gap_ms = 0.0;
+    if (auto resumed = state->take_resumed_ticker(); !resumed.is_null()) {
+        arrivals->restore(resumed.at("arrivals"));
+        faults.restore(resumed.at("faults"));
+        gap_ms = resumed.at("gap_ms").get<double>();
+    } else {
+        gap_ms = arrivals->next_interval_ms();
+    }
+    state->set_ticker_save([&arrivals, &faults, &gap_ms] {
+        return nlohmann::json{{"arrivals", arrivals->save()}, {"faults", faults.save()}, {"gap_ms", gap_ms}};
+    });
+
+    uint64_t seq = state->next_seq();
+    auto start = sim_core::steady_now();
+    auto deadline = start;
+    auto mode = sim_core::LoadMode::Normal;
+    int batch = 0;
+    asio::steady_timer timer(executor);
+
+    // gap_ms is drawn after each tick, so a pause keeps the pending gap
     while (true) {
-        uint64_t tick_ms = sim_core::sample_range(rng, config.dex_tick_ms.min, config.dex_tick_ms.max);
+        deadline += std::chrono::microseconds(static_cast<int64_t>(gap_ms * 1000.0));
 
-        if (config.dex_burst_mode) {
-            bool burst_on = sim_core::happens(rng, 0.5);
-            if (burst_on) {
-                tick_ms = std::min(tick_ms, config.dex_burst_on_ms);
-            } else {
-                tick_ms = std::max(tick_ms, config.dex_burst_off_ms);
-            }
+        bool overdue = sim_core::steady_now() >= deadline;
+        if (mode != sim_core::LoadMode::Normal && overdue && batch < kMaxTickBatch) {
+            batch++;
+        } else {
+            batch = 0;
+            timer.expires_at(deadline);
+            co_await timer.async_wait(asio::use_awaitable);
         }
 
-        asio::steady_timer timer(executor, std::chrono::milliseconds(tick_ms));
-        co_await timer.async_wait(asio::use_awaitable);
-
-        auto now = std::chrono::steady_clock::now();
-        uint64_t ts = sim_core::current_time_ms();
+        if (state->paused()) {
+            timer.expires_after(std::chrono::milliseconds(10));
+            co_await timer.async_wait(asio::use_awaitable);
+            deadline = sim_core::steady_now();
+            continue;
+        }
 
-        uint32_t delay_ms = static_cast<uint32_t>(
-            sim_core::sample_range(rng, config.dex_latency_ms.min, config.dex_latency_ms.max)
-        );
+        auto now = sim_core::steady_now();
+        double lag_ms = std::chrono::duration<double, std::milli>(now - deadline).count();
+        mode = state->update_load(lag_ms);
+        if (mode == sim_core::LoadMode::Normal && now > deadline) {
+            deadline = now;
+        }
 
-        auto elapsed_since_last = std::chrono::duration_cast<std::chrono::milliseconds>(
-            now - last_tick_time
-        ).count();
-        bool stale = static_cast<uint64_t>(elapsed_since_last) > config.dex_stale_after_ms;
+        auto now_ms = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            now - start
+        ).count());
+        uint64_t ts = sim_core::current_time_ms();
 
-        auto msg = state->generate_tick(ts, seq, delay_ms, stale);
+        auto msg = state->generate_tick(ts, seq++, 0, false);
 
         sim_core::get_metrics().price_ticks_generated++;
 
-        if (sim_core::happens(rng, config.dex_p_drop)) {
-            sim_core::get_metrics().ws_frames_dropped++;
-            seq++;
-            last_tick_time = now;
-            continue;
-        }
+        faults.process(std::move(msg), now_ms, [&state](const sim_core::PriceMsg& frame) {
+            state->broadcast_price(frame);
+        });
 
-        state->broadcast_price(msg);
-        sim_core::get_metrics().ws_frames_sent++;
-        seq++;
+        gap_ms = arrivals->next_interval_ms();
+    }
+}
 
-        if (sim_core::happens(rng, config.dex_p_dup)) {
-            state->broadcast_price(msg);
-            sim_core::get_metrics().ws_frames_duplicated++;
+// Reads and discards client frames until the connection closes, marking the
+// client active for keepalive. Reads go through a small in-frame scratch
+// buffer, so an idle subscriber holds no heap read buffer.
+asio::awaitable<void> run_websocket_session(
+    std::shared_ptr<sim_core::WsHub::Stream> ws,
+    std::shared_ptr<DexState> state,
+    sim_core::SlotId client_id)
+{
+    try {
+        std::array<char, 64> scratch;
+        while (true) {
+            co_await ws->async_read_some(asio::buffer(scratch), asio::use_awaitable);
+            state->hub().touch(client_id);
         }
-
-        last_tick_time = now;
+    } catch (const std::exception& e) {
     }
+
+    state->hub().remove(client_id);
 }
 
 asio::awaitable<void> handle_websocket_session(
@@ -152,8 +281,35 @@ asio::awaitable<void> handle_websocket_session(
     std::shared_ptr<DexState> state,
     std::optional<http::request<http::string_body>> initial_req = std::nullopt)
 {
+    std::shared_ptr<sim_core::WsHub::Stream> ws;
+    sim_core::SlotId client_id;
+
+    // Bad subscribe parameters are refused with a 400 before the upgrade
+    auto tier = sim_core::Tier::Normal;
+    const auto& server = state->config().server;
+    auto limit = sim_core::parse_bandwidth_limit("", server.ws_client_limit, server.ws_client_max_limit);
+    if (initial_req.has_value()) {
+        std::string bad_params;
+        try {
+            std::string target(initial_req->target());
+            if (auto name = sim_core::query_param(target, "tier")) {
+                tier = sim_core::parse_tier(*name);
+            }
+            limit = sim_core::parse_bandwidth_limit(target, server.ws_client_limit, server.ws_client_max_limit);
+        } catch (const std::exception& e) {
+            bad_params = e.what();
+        }
+        if (!bad_params.empty()) {
+            beast::error_code ec;
+            auto res = sim_core::bad_request(*initial_req, "dex-sim", bad_params);
+            res.keep_alive(false);
+            co_await http::async_write(socket, res, asio::redirect_error(asio::use_awaitable, ec));
+            co_return;
+        }
+    }
+
     try {
-        auto ws = std::make_shared<websocket::stream<beast::tcp_stream>>(std::move(socket));
+        ws = std::make_shared<sim_core::WsHub::Stream>(std::move(socket));
 
         if (initial_req.has_value()) {
             co_await ws->async_accept(*initial_req, asio::use_awaitable);
@@ -161,19 +317,24 @@ asio::awaitable<void> handle_websocket_session(
             co_await ws->async_accept(asio::use_awaitable);
         }
 
-        state->add_client(ws);
+        client_id = state->hub().add(ws, tier, limit);
+        if (!client_id.valid()) {
+            co_await ws->async_close(websocket::close_code::try_again_later, asio::use_awaitable);
+            co_return;
+        }
 
-        auto sub_msg = sim_core::WsMessage::create_subscription("dex_ticks", "subscribed");
+        auto sub_msg = sim_core::WsMessage::create_subscription("dex_ticks", "subscribed", client_id.to_string());
         std::string sub_json = sub_msg.to_json_string();
         co_await ws->async_write(asio::buffer(sub_json), asio::use_awaitable);
 
-        beast::flat_buffer buffer;
-        while (true) {
-            co_await ws->async_read(buffer, asio::use_awaitable);
-            buffer.clear();
-        }
+        state->hub().activate(client_id);
     } catch (const std::exception& e) {
+        state->hub().remove(client_id);
+        co_return;
     }
+
+    auto executor = ws->get_executor();
+    asio::co_spawn(executor, run_websocket_session(std::move(ws), state, client_id), asio::detached);
 }
 
 http::message_generator handle_http_request(
@@ -226,11 +387,22 @@ http::message_generator handle_http_request(
     std::string target(req.target());
 
     if (target == "/healthz") {
-        return ok_text("OK");
+        auto mode = state->load_mode();
+        if (mode == sim_core::LoadMode::Normal) {
+            return ok_text("OK");
+        }
+        return ok_text(std::string("DEGRADED ") + sim_core::load_mode_name(mode));
     }
 
     if (target == "/metrics") {
-        return ok_text(sim_core::get_metrics().to_prometheus());
+        return ok_text(sim_core::get_metrics().to_prometheus() + state->hub().to_prometheus() + state->load_metrics()
+            + state->digest().to_prometheus());
+    }
+
+    if (target == "/digest") {
+        auto j = state->digest().to_json();
+        j["clients"] = state->hub().digests();
+        return ok_json(j.dump());
     }
 
     if (target == "/prices/snapshot") {
@@ -284,17 +456,38 @@ asio::awaitable<void> handle_http_session(
             co_await http::async_read(stream, buffer, req, asio::use_awaitable);
 
             if (websocket::is_upgrade(req)) {
+                // spawned rather than awaited so this frame, its buffer and the
+                // tcp_stream timers are released for the life of the subscriber
                 auto raw_socket = stream.release_socket();
-                co_await handle_websocket_session(
-                    std::move(raw_socket),
-                    state,
-                    std::move(req)
+                auto executor = raw_socket.get_executor();
+                asio::co_spawn(
+                    executor,
+                    handle_websocket_session(std::move(raw_socket), state, std::move(req)),
+                    asio::detached
                 );
                 co_return;
             }
 
-            auto response = handle_http_request(std::move(req), state);
-            co_await beast::async_write(stream, std::move(response), asio::use_awaitable);
+            // History and export bodies are encoded and written a chunk at a time
+            std::unique_ptr<sim_core::ChunkSource> source;
+            std::string bad_params;
+            if (state->history().enabled()) {
+                try {
+                    source = sim_core::open_history_stream(std::string(req.target()), state->history());
+                } catch (const std::invalid_argument& e) {
+                    bad_params = e.what();
+                }
+            }
+
+            if (source) {
+                co_await sim_core::async_write_chunked(stream, req, "dex-sim", *source);
+                if (req.version() < 11) break;
+            } else if (!bad_params.empty()) {
+                co_await http::async_write(stream, sim_core::bad_request(req, "dex-sim", bad_params), asio::use_awaitable);
+            } else {
+                auto response = handle_http_request(std::move(req), state);
+                co_await beast::async_write(stream, std::move(response), asio::use_awaitable);
+            }
 
             if (!req.keep_alive()) {
                 break;
@@ -332,34 +525,76 @@ int main(int argc, char* argv[]) {
         spdlog::info("  WS:     ws://{}/ws/ticks", config.server.http_bind);
         spdlog::info("  HTTP:   http://{}/prices/snapshot", config.server.http_bind);
         spdlog::info("  Metrics: http://{}/metrics", config.server.http_bind);
-        spdlog::info("  Model:  {}", config.server.price_model);
+        spdlog::info("  Model:  {}", config.server.model_for(config.server.pairs[0]));
         spdlog::info("  Seed:   {}", config.server.seed);
+        if (config.server.crash_tilt.enabled()) {
+            const auto& tilt = config.server.crash_tilt;
+            spdlog::warn("  Importance sampling: crash_drop={} over {} ms, jump_scale={}, jump_mean_shift={} "
+                "(paths restart every horizon, ticks carry path and log_weight)",
+                tilt.crash_drop, tilt.horizon_ms, tilt.jump_intensity_scale, tilt.jump_mean_shift);
+        }
+        spdlog::info("  Arrivals: {}", config.dex_arrival_model);
 
-        auto rng = sim_core::create_labeled_rng(config.server.seed, "DEX");
-        auto engine = std::make_unique<sim_core::GbmPriceEngine>(
-            config.server.pairs[0],
-            config.server.price_start,
-            config.server.gbm_mu,
-            config.server.gbm_sigma,
-            config.dex_tick_ms.min,
-            std::move(rng)
-        );
+        std::optional<sim_core::Handoff> handoff;
+        if (!config.server.handoff_socket.empty()) {
+            handoff = sim_core::request_handoff(config.server.handoff_socket);
+        }
+
+        auto engine = sim_core::make_dex_engine(config);
 
         auto state = std::make_shared<DexState>(std::move(config), std::move(engine));
+        if (handoff.has_value()) {
+            state->restore(handoff->state);
+        }
 
         auto [host, port] = sim_core::parse_bind_address(state->config().server.http_bind);
 
-        asio::io_context ioc;
+        sim_core::IoPool pool(state->config().server.io_threads);
+        tcp::endpoint endpoint(asio::ip::make_address(host), port);
 
-        tcp::acceptor acceptor(ioc, tcp::endpoint(asio::ip::make_address(host), port));
+        auto acceptors = sim_core::open_listeners(pool, endpoint, handoff);
 
-        asio::co_spawn(ioc, run_price_ticker(state), asio::detached);
+        if (handoff.has_value()) {
+            sim_core::adopt_clients(*handoff, pool, state->hub(), [&state](auto& ioc, auto ws, auto id) {
+                asio::co_spawn(ioc, run_websocket_session(std::move(ws), state, id), asio::detached);
+            });
+            sim_core::complete_handoff(*handoff);
+            spdlog::info("  Took over {} listeners and {} clients, resuming at seq {}",
+                handoff->listener_fds.size(), handoff->client_fds.size(), state->next_seq());
+        }
+
+        sim_core::dispatch_fault_pipeline(
+            sim_core::dex_fault_config(state->config()),
+            sim_core::create_labeled_rng(state->config().server.seed, "DEX_TICKER"),
+            [&](auto faults) {
+                faults.set_history(&state->history());
+                asio::co_spawn(pool.ticker_context(), run_price_ticker(state, std::move(faults)), asio::detached);
+            }
+        );
+
+        asio::co_spawn(pool.ticker_context(), sim_core::run_timers(state->hub()), asio::detached);
 
-        asio::co_spawn(ioc, listen(acceptor, state), asio::detached);
+        for (auto& acceptor : acceptors) {
+            asio::co_spawn(acceptor.get_executor(), listen(acceptor, state), asio::detached);
+        }
+
+        if (!state->config().server.handoff_socket.empty()) {
+            asio::co_spawn(
+                pool.ticker_context(),
+                sim_core::serve_handoff(state->config().server.handoff_socket, state, acceptors),
+                asio::detached
+            );
+        }
 
+        spdlog::info("  I/O threads: {}", pool.io_contexts().size());
+        if (sim_core::fast_clock().uses_tsc()) {
+            spdlog::info("  Clock: TSC at {:.3f} GHz", sim_core::fast_clock().tsc_ghz());
+        } else {
+            spdlog::info("  Clock: clock_gettime (no invariant TSC)");
+        }
         spdlog::info("🚀 DEX server ready");
 
-        ioc.run();
+        pool.run();
 
     } catch (const std::exception& e) {
         spdlog::error("Fatal error: {}", e.what());
@@ -1,9 +1,17 @@
 #include <sim_core/types.hpp>
 #include <sim_core/config.hpp>
 #include <sim_core/rng.hpp>
-#include <sim_core/gbm_engine.hpp>
+#include <sim_core/engine_factory.hpp>
+#include <sim_core/oracle_feeds.hpp>
+#include <sim_core/scenario.hpp>
+#include <sim_core/fault_pipeline.hpp>
 #include <sim_core/metrics.hpp>
 #include <sim_core/utils.hpp>
+#include <sim_core/ws_hub.hpp>
+#include <sim_core/io_pool.hpp>
+#include <sim_core/handoff.hpp>
+#include <sim_core/history_stream.hpp>
+#include <sim_core/digest.hpp>
 
 #include <boost/asio.hpp>
 #include <boost/beast.hpp>
@@ -11,11 +19,15 @@
 #include <spdlog/sinks/stdout_color_sinks.h>
 
 #include <memory>
+#include <array>
 #include <mutex>
 #include <vector>
-#include <set>
+#include <unordered_map>
 #include <optional>
+#include <atomic>
 #include <chrono>
+#include <functional>
+#include <utility>
 
 namespace asio = boost::asio;
 namespace beast = boost::beast;
@@ -26,192 +38,258 @@ using tcp = asio::ip::tcp;
 class OracleState {
 private:
     sim_core::OracleConfig config_;
-    std::unique_ptr<sim_core::PriceEngine> price_engine_;
-    mutable std::mutex price_engine_mutex_;
+    sim_core::OracleFeedSet feeds_;
+    mutable std::mutex feeds_mutex_;
 
-    std::optional<sim_core::PriceMsg> last_price_;
+    std::unordered_map<std::string, uint32_t> feed_by_pair_;
+    std::vector<std::optional<sim_core::PriceMsg>> last_prices_;
     mutable std::mutex last_price_mutex_;
 
-    std::optional<double> last_published_price_;
-    mutable std::mutex last_published_price_mutex_;
+    sim_core::WsHub hub_;
 
-    std::optional<std::chrono::steady_clock::time_point> last_publish_time_;
-    mutable std::mutex last_publish_time_mutex_;
+    sim_core::LoadShedder load_;
+    mutable std::mutex load_mutex_;
 
-    std::set<std::shared_ptr<websocket::stream<beast::tcp_stream>>> clients_;
-    std::mutex clients_mutex_;
+    std::atomic<bool> paused_{false};
+
+    sim_core::RunHistory history_;
+    sim_core::StreamDigest digest_;
+
+    // Fault state owned by the ticker coroutine, only touched on the ticker
+    // context, which also serves handoffs
+    std::function<nlohmann::json()> save_faults_;
+    nlohmann::json resumed_faults_;
+
+    static std::vector<std::string> feed_pairs(const sim_core::OracleFeedSet& feeds) {
+        std::vector<std::string> pairs;
+        for (uint32_t feed = 0; feed < feeds.size(); ++feed) {
+            pairs.push_back(feeds.pair(feed));
+        }
+        return pairs;
+    }
 
 public:
-    explicit OracleState(sim_core::OracleConfig config, std::unique_ptr<sim_core::PriceEngine> engine)
+    explicit OracleState(sim_core::OracleConfig config, sim_core::OracleFeedSet feeds)
         : config_(std::move(config))
-        , price_engine_(std::move(engine))
-    {}
+        , feeds_(std::move(feeds))
+        , last_prices_(feeds_.size())
+        , hub_(sim_core::parse_send_order(config_.server.ws_send_order),
+               sim_core::create_labeled_rng(config_.server.seed, "ORACLE_SEND_ORDER"),
+               config_.server.ws_max_in_flight,
+               config_.server.ws_conflate_backlog)
+        , load_(config_.server.load_shed)
+        , history_(feed_pairs(feeds_), config_.server.history_rows)
+        , digest_(feed_pairs(feeds_), config_.server.digest_checkpoint_ticks)
+    {
+        hub_.set_keepalive(config_.server.ws_ping_interval_ms, config_.server.ws_idle_timeout_ms);
+        for (uint32_t feed = 0; feed < feeds_.size(); ++feed) {
+            feed_by_pair_[feeds_.pair(feed)] = feed;
+        }
+    }
 
     const sim_core::OracleConfig& config() const { return config_; }
 
     void broadcast_price(const sim_core::PriceMsg& msg) {
         {
             std::lock_guard<std::mutex> lock(last_price_mutex_);
-            last_price_ = msg;
+            last_prices_[feed_by_pair_.at(msg.pair)] = msg;
         }
+        uint32_t feed = feed_by_pair_.at(msg.pair);
+        history_.record_tick(msg, feed);
+        auto record = digest_.record(msg, feed);
 
         spdlog::info("price_tick source={} pair={} price={:.4f} seq={} delay_ms={} stale={}",
             msg.source == sim_core::SourceKind::Chainlink ? "chainlink" : "dex",
-            msg.pair, msg.price, msg.src_seq, msg.delay_ms, msg.stale);
+            msg.pair, msg.price.to_double(), msg.src_seq, msg.delay_ms, msg.stale);
 
         auto ws_msg = sim_core::WsMessage::create_price(msg);
         std::string json_str = ws_msg.to_json_string();
 
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        for (auto& client : clients_) {
-            try {
-                client->write(asio::buffer(json_str));
-            } catch (const std::exception& e) {
-                spdlog::warn("Failed to broadcast to client: {}", e.what());
-            }
-        }
+        hub_.broadcast(msg.pair, std::move(json_str), record);
     }
 
-    void add_client(std::shared_ptr<websocket::stream<beast::tcp_stream>> client) {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        clients_.insert(client);
+    sim_core::WsHub& hub() { return hub_; }
+
+    sim_core::RunHistory& history() { return history_; }
+
+    sim_core::StreamDigest& digest() { return digest_; }
+
+    // Feeds a ticker lag sample to the load shedder and applies mode changes
+    sim_core::LoadMode update_load(double lag_ms) {
+        std::lock_guard<std::mutex> lock(load_mutex_);
+        size_t backlog = hub_.backlog();
+        if (load_.update(lag_ms, backlog)) {
+            auto mode = load_.mode();
+            hub_.set_load_mode(mode);
+            spdlog::set_level(mode == sim_core::LoadMode::Normal ? spdlog::level::info : spdlog::level::warn);
+            spdlog::warn("load_mode={} ticker_lag_ms={:.1f} backlog={}",
+                sim_core::load_mode_name(mode), load_.lag_ms(), backlog);
+        }
+        return load_.mode();
     }
 
-    void remove_client(std::shared_ptr<websocket::stream<beast::tcp_stream>> client) {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        clients_.erase(client);
+    sim_core::LoadMode load_mode() const {
+        std::lock_guard<std::mutex> lock(load_mutex_);
+        return load_.mode();
     }
 
-    sim_core::PriceMsg generate_tick(uint64_t ts, uint64_t seq, uint32_t delay_ms, bool stale) {
-        std::lock_guard<std::mutex> lock(price_engine_mutex_);
-        return price_engine_->next_tick(ts, seq, sim_core::SourceKind::Chainlink, delay_ms, stale);
+    std::string load_metrics() const {
+        std::lock_guard<std::mutex> lock(load_mutex_);
+        return load_.to_prometheus();
     }
 
-    std::optional<sim_core::PriceMsg> get_last_price() const {
-        std::lock_guard<std::mutex> lock(last_price_mutex_);
-        return last_price_;
+    uint64_t next_due_ms() const {
+        std::lock_guard<std::mutex> lock(feeds_mutex_);
+        return feeds_.next_due_ms();
     }
 
-    bool should_publish(double current_price, std::chrono::steady_clock::time_point now) {
-        std::lock_guard<std::mutex> price_lock(last_published_price_mutex_);
-        std::lock_guard<std::mutex> time_lock(last_publish_time_mutex_);
+    std::vector<sim_core::OracleFeedSet::Publish> poll_feeds(uint64_t now_ms) {
+        std::lock_guard<std::mutex> lock(feeds_mutex_);
+        return feeds_.poll(now_ms);
+    }
 
-        if (!last_published_price_.has_value()) {
-            return true;
-        }
+    const std::string& pair(uint32_t feed) const {
+        return feeds_.pair(feed);
+    }
 
-        double last_price = last_published_price_.value();
+    bool paused() const { return paused_; }
 
-        double deviation = std::abs((current_price - last_price) / last_price);
-        uint32_t deviation_bps = static_cast<uint32_t>(deviation * 10000.0);
+    // Registered by the ticker so a handoff snapshot includes its faults
+    void set_faults_save(std::function<nlohmann::json()> save) { save_faults_ = std::move(save); }
 
-        if (deviation_bps >= config_.oracle_deviation_bps) {
-            spdlog::info("Deviation trigger: {} bps (threshold: {})",
-                deviation_bps, config_.oracle_deviation_bps);
-            return true;
-        }
+    // Fault state from a handoff, or null; taken once at ticker start
+    nlohmann::json take_resumed_faults() { return std::exchange(resumed_faults_, nullptr); }
 
-        if (last_publish_time_.has_value()) {
-            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                now - last_publish_time_.value()
-            ).count();
+    // Stops publishing and returns the state a replacement resumes from
+    nlohmann::json pause_for_handoff() {
+        paused_ = true;
 
-            if (static_cast<uint64_t>(elapsed) >= config_.oracle_heartbeat_ms) {
-                spdlog::info("Heartbeat trigger: {} ms (threshold: {})",
-                    elapsed, config_.oracle_heartbeat_ms);
-                return true;
+        std::lock_guard<std::mutex> feeds_lock(feeds_mutex_);
+        std::lock_guard<std::mutex> last_lock(last_price_mutex_);
+        auto last = nlohmann::json::array();
+        for (const auto& price : last_prices_) {
+            if (price.has_value()) {
+                nlohmann::json saved = *price;
+                saved["decimals"] = price->price.decimals;
+                last.push_back(std::move(saved));
             }
         }
-
-        return false;
+        return nlohmann::json{
+            {"feeds", feeds_.save()},
+            {"last", last},
+            {"digest", digest_.save()},
+            {"faults", save_faults_ ? save_faults_() : nlohmann::json(nullptr)}
+        };
     }
 
-    void mark_published(double price, std::chrono::steady_clock::time_point now) {
-        {
-            std::lock_guard<std::mutex> lock(last_published_price_mutex_);
-            last_published_price_ = price;
-        }
+    void resume_after_handoff() { paused_ = false; }
+
+    // Feed state is restored on the feed set before it is moved in
+    void restore(const nlohmann::json& j) {
         {
-            std::lock_guard<std::mutex> lock(last_publish_time_mutex_);
-            last_publish_time_ = now;
+            std::lock_guard<std::mutex> lock(last_price_mutex_);
+            for (const auto& saved : j.at("last")) {
+                auto msg = saved.get<sim_core::PriceMsg>();
+                if (auto it = feed_by_pair_.find(msg.pair); it != feed_by_pair_.end()) {
+                    last_prices_[it->second] = std::move(msg);
+                }
+            }
         }
+        digest_.restore(j.at("digest"));
+        resumed_faults_ = j.at("faults");
     }
 
-    std::optional<double> get_last_published_price() const {
-        std::lock_guard<std::mutex> lock(last_published_price_mutex_);
-        return last_published_price_;
+    std::vector<sim_core::PriceMsg> get_last_prices() const {
+        std::lock_guard<std::mutex> lock(last_price_mutex_);
+        std::vector<sim_core::PriceMsg> prices;
+        for (const auto& price : last_prices_) {
+            if (price.has_value()) {
+                prices.push_back(*price);
+            }
+        }
+        return prices;
     }
 };
 
-asio::awaitable<void> run_price_ticker(std::shared_ptr<OracleState> state) {
+template<typename Faults>
+asio::awaitable<void> run_price_ticker(std::shared_ptr<OracleState> state, Faults faults) {
     auto executor = co_await asio::this_coro::executor;
-    const auto& config = state->config();
 
-    auto rng = sim_core::create_labeled_rng(config.server.seed, "ORACLE_TICKER");
-    uint64_t seq = 0;
-    auto last_tick_time = std::chrono::steady_clock::now();
+    if (auto resumed = state->take_resumed_faults(); !resumed.is_null()) {
+        faults.restore(resumed);
+    }
+    state->set_faults_save([&faults] { return faults.save(); });
 
-    while (true) {
-        uint64_t tick_ms = sim_core::sample_range(rng, config.oracle_tick_ms.min, config.oracle_tick_ms.max);
+    auto start = sim_core::steady_now();
+    asio::steady_timer timer(executor);
 
-        asio::steady_timer timer(executor, std::chrono::milliseconds(tick_ms));
+    while (true) {
+        auto due = start + std::chrono::milliseconds(state->next_due_ms());
+        timer.expires_at(due);
         co_await timer.async_wait(asio::use_awaitable);
 
-        auto now = std::chrono::steady_clock::now();
-        uint64_t ts = sim_core::current_time_ms();
-
-        uint32_t delay_ms = static_cast<uint32_t>(
-            sim_core::sample_range(rng, config.oracle_ws_jitter_ms.min, config.oracle_ws_jitter_ms.max)
-        );
-
-        auto elapsed_since_last = std::chrono::duration_cast<std::chrono::milliseconds>(
-            now - last_tick_time
-        ).count();
-        bool stale = static_cast<uint64_t>(elapsed_since_last) > config.oracle_stale_after_ms;
-
-        auto msg = state->generate_tick(ts, seq, delay_ms, stale);
-        double current_price = msg.price;
-
-        bool should_pub = state->should_publish(current_price, now);
-
-        if (!should_pub) {
-            auto last_pub = state->get_last_published_price();
-            if (last_pub.has_value()) {
-                double dev_bps = std::abs((current_price - last_pub.value()) / last_pub.value()) * 10000.0;
-                spdlog::debug(
-                    "Price check: current={:.4f}, last_published={:.4f}, deviation={:.2f} bps (threshold={})",
-                    current_price, last_pub.value(), dev_bps, config.oracle_deviation_bps
-                );
-            }
-        }
-
-        if (!should_pub) {
-            last_tick_time = now;
+        if (state->paused()) {
+            timer.expires_after(std::chrono::milliseconds(10));
+            co_await timer.async_wait(asio::use_awaitable);
             continue;
         }
 
-        sim_core::get_metrics().price_ticks_generated++;
+        auto now = sim_core::steady_now();
+        state->update_load(std::chrono::duration<double, std::milli>(now - due).count());
 
-        if (sim_core::happens(rng, config.oracle_p_drop)) {
-            sim_core::get_metrics().ws_frames_dropped++;
-            state->mark_published(msg.price, now);
-            seq++;
-            last_tick_time = now;
-            continue;
-        }
-
-        state->broadcast_price(msg);
-        state->mark_published(msg.price, now);
-        sim_core::get_metrics().ws_frames_sent++;
-        seq++;
+        auto now_ms = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            now - start
+        ).count());
+        uint64_t ts = sim_core::current_time_ms();
 
-        if (sim_core::happens(rng, config.oracle_p_dup)) {
-            state->broadcast_price(msg);
-            sim_core::get_metrics().ws_frames_duplicated++;
+        for (const auto& publish : state->poll_feeds(now_ms)) {
+            spdlog::debug("{} trigger: pair={} price={:.4f}",
+                sim_core::trigger_name(publish.trigger), state->pair(publish.feed), publish.price.to_double());
+
+            sim_core::PriceMsg msg{
+                ts,
+                state->pair(publish.feed),
+                publish.price,
+                sim_core::SourceKind::Chainlink,
+                publish.seq,
+                0,
+                publish.stale,
+                publish.log_weight,
+                publish.path,
+                publish.path_end
+            };
+            state->history().rounds.append(sim_core::OracleRound{
+                ts, publish.seq, publish.price.raw, publish.feed, publish.price.decimals,
+                publish.trigger, publish.stale
+            });
+
+            sim_core::get_metrics().price_ticks_generated++;
+
+            faults.process(std::move(msg), now_ms, [&state](const sim_core::PriceMsg& frame) {
+                state->broadcast_price(frame);
+            }, publish.feed);
         }
+    }
+}
 
-        last_tick_time = now;
+// Reads and discards client frames until the connection closes, marking the
+// client active for keepalive. Reads go through a small in-frame scratch
+// buffer, so an idle subscriber holds no heap read buffer.
+asio::awaitable<void> run_websocket_session(
+    std::shared_ptr<sim_core::WsHub::Stream> ws,
+    std::shared_ptr<OracleState> state,
+    sim_core::SlotId client_id)
+{
+    try {
+        std::array<char, 64> scratch;
+        while (true) {
+            co_await ws->async_read_some(asio::buffer(scratch), asio::use_awaitable);
+            state->hub().touch(client_id);
+        }
+    } catch (const std::exception& e) {
     }
+
+    state->hub().remove(client_id);
 }
 
 asio::awaitable<void> handle_websocket_session(
@@ -219,8 +297,35 @@ asio::awaitable<void> handle_websocket_session(
     std::shared_ptr<OracleState> state,
     std::optional<http::request<http::string_body>> initial_req = std::nullopt)
 {
+    std::shared_ptr<sim_core::WsHub::Stream> ws;
+    sim_core::SlotId client_id;
+
+    // Bad subscribe parameters are refused with a 400 before the upgrade
+    auto tier = sim_core::Tier::Normal;
+    const auto& server = state->config().server;
+    auto limit = sim_core::parse_bandwidth_limit("", server.ws_client_limit, server.ws_client_max_limit);
+    if (initial_req.has_value()) {
+        std::string bad_params;
+        try {
+            std::string target(initial_req->target());
+            if (auto name = sim_core::query_param(target, "tier")) {
+                tier = sim_core::parse_tier(*name);
+            }
+            limit = sim_core::parse_bandwidth_limit(target, server.ws_client_limit, server.ws_client_max_limit);
+        } catch (const std::exception& e) {
+            bad_params = e.what();
+        }
+        if (!bad_params.empty()) {
+            beast::error_code ec;
+            auto res = sim_core::bad_request(*initial_req, "oracle-sim", bad_params);
+            res.keep_alive(false);
+            co_await http::async_write(socket, res, asio::redirect_error(asio::use_awaitable, ec));
+            co_return;
+        }
+    }
+
     try {
-        auto ws = std::make_shared<websocket::stream<beast::tcp_stream>>(std::move(socket));
+        ws = std::make_shared<sim_core::WsHub::Stream>(std::move(socket));
 
         if (initial_req.has_value()) {
             co_await ws->async_accept(*initial_req, asio::use_awaitable);
@@ -228,19 +333,24 @@ asio::awaitable<void> handle_websocket_session(
             co_await ws->async_accept(asio::use_awaitable);
         }
 
-        state->add_client(ws);
+        client_id = state->hub().add(ws, tier, limit);
+        if (!client_id.valid()) {
+            co_await ws->async_close(websocket::close_code::try_again_later, asio::use_awaitable);
+            co_return;
+        }
 
-        auto sub_msg = sim_core::WsMessage::create_subscription("oracle_prices", "subscribed");
+        auto sub_msg = sim_core::WsMessage::create_subscription("oracle_prices", "subscribed", client_id.to_string());
         std::string sub_json = sub_msg.to_json_string();
         co_await ws->async_write(asio::buffer(sub_json), asio::use_awaitable);
 
-        beast::flat_buffer buffer;
-        while (true) {
-            co_await ws->async_read(buffer, asio::use_awaitable);
-            buffer.clear();
-        }
+        state->hub().activate(client_id);
     } catch (const std::exception& e) {
+        state->hub().remove(client_id);
+        co_return;
     }
+
+    auto executor = ws->get_executor();
+    asio::co_spawn(executor, run_websocket_session(std::move(ws), state, client_id), asio::detached);
 }
 
 http::message_generator handle_http_request(
@@ -282,18 +392,27 @@ http::message_generator handle_http_request(
     std::string target(req.target());
 
     if (target == "/healthz") {
-        return ok_text("OK");
+        auto mode = state->load_mode();
+        if (mode == sim_core::LoadMode::Normal) {
+            return ok_text("OK");
+        }
+        return ok_text(std::string("DEGRADED ") + sim_core::load_mode_name(mode));
     }
 
     if (target == "/metrics") {
-        return ok_text(sim_core::get_metrics().to_prometheus());
+        return ok_text(sim_core::get_metrics().to_prometheus() + state->hub().to_prometheus() + state->load_metrics()
+            + state->digest().to_prometheus());
+    }
+
+    if (target == "/digest") {
+        auto j = state->digest().to_json();
+        j["clients"] = state->hub().digests();
+        return ok_json(j.dump());
     }
 
     if (target == "/oracle/snapshot") {
         sim_core::PriceSnapshot snapshot;
-        if (auto price = state->get_last_price()) {
-            snapshot.prices.push_back(*price);
-        }
+        snapshot.prices = state->get_last_prices();
         snapshot.server_time = sim_core::current_time_ms();
 
         nlohmann::json j = snapshot;
@@ -318,17 +437,38 @@ asio::awaitable<void> handle_http_session(
             co_await http::async_read(stream, buffer, req, asio::use_awaitable);
 
             if (websocket::is_upgrade(req)) {
+                // spawned rather than awaited so this frame, its buffer and the
+                // tcp_stream timers are released for the life of the subscriber
                 auto raw_socket = stream.release_socket();
-                co_await handle_websocket_session(
-                    std::move(raw_socket),
-                    state,
-                    std::move(req)
+                auto executor = raw_socket.get_executor();
+                asio::co_spawn(
+                    executor,
+                    handle_websocket_session(std::move(raw_socket), state, std::move(req)),
+                    asio::detached
                 );
                 co_return;
             }
 
-            auto response = handle_http_request(std::move(req), state);
-            co_await beast::async_write(stream, std::move(response), asio::use_awaitable);
+            // History and export bodies are encoded and written a chunk at a time
+            std::unique_ptr<sim_core::ChunkSource> source;
+            std::string bad_params;
+            if (state->history().enabled()) {
+                try {
+                    source = sim_core::open_history_stream(std::string(req.target()), state->history());
+                } catch (const std::invalid_argument& e) {
+                    bad_params = e.what();
+                }
+            }
+
+            if (source) {
+                co_await sim_core::async_write_chunked(stream, req, "oracle-sim", *source);
+                if (req.version() < 11) break;
+            } else if (!bad_params.empty()) {
+                co_await http::async_write(stream, sim_core::bad_request(req, "oracle-sim", bad_params), asio::use_awaitable);
+            } else {
+                auto response = handle_http_request(std::move(req), state);
+                co_await beast::async_write(stream, std::move(response), asio::use_awaitable);
+            }
 
             if (!req.keep_alive()) {
                 break;
@@ -366,36 +506,87 @@ int main(int argc, char* argv[]) {
         spdlog::info("  WS:     ws://{}/ws/prices", config.server.http_bind);
         spdlog::info("  HTTP:   http://{}/oracle/snapshot", config.server.http_bind);
         spdlog::info("  Metrics: http://{}/metrics", config.server.http_bind);
-        spdlog::info("  Model:  {}", config.server.price_model);
+        spdlog::info("  Model:  {}", config.server.model_for(config.server.pairs[0]));
         spdlog::info("  Seed:   {}", config.server.seed);
+        if (config.server.crash_tilt.enabled()) {
+            const auto& tilt = config.server.crash_tilt;
+            spdlog::warn("  Importance sampling: crash_drop={} over {} ms, jump_scale={}, jump_mean_shift={} "
+                "(paths restart every horizon, ticks carry path and log_weight)",
+                tilt.crash_drop, tilt.horizon_ms, tilt.jump_intensity_scale, tilt.jump_mean_shift);
+        }
         spdlog::info("  Deviation threshold: {} bps", config.oracle_deviation_bps);
         spdlog::info("  Heartbeat: {} ms", config.oracle_heartbeat_ms);
 
-        auto rng = sim_core::create_labeled_rng(config.server.seed, "ORACLE");
-        auto engine = std::make_unique<sim_core::GbmPriceEngine>(
-            config.server.pairs[0],
-            config.server.price_start,
-            config.server.gbm_mu,
-            config.server.gbm_sigma,
-            config.oracle_tick_ms.min,
-            std::move(rng)
-        );
+        std::optional<sim_core::Handoff> handoff;
+        if (!config.server.handoff_socket.empty()) {
+            handoff = sim_core::request_handoff(config.server.handoff_socket);
+        }
+
+        auto feeds = sim_core::make_oracle_feed_set(config);
+        for (const auto& feed : config.feeds) {
+            auto model = sim_core::oracle_feed_model(config, feed);
+            auto engine = sim_core::make_oracle_engine(config, model, feed.pair);
+            feeds.add_feed(feed.pair, std::move(engine), feed.oracle_deviation_bps, feed.oracle_heartbeat_ms, 0);
+        }
+        size_t resumed = 0;
+        if (handoff.has_value()) {
+            resumed = feeds.restore(handoff->state.at("feeds"), 0);
+        }
+        spdlog::info("  Feeds:  {}", feeds.size());
 
-        auto state = std::make_shared<OracleState>(std::move(config), std::move(engine));
+        auto state = std::make_shared<OracleState>(std::move(config), std::move(feeds));
+        if (handoff.has_value()) {
+            state->restore(handoff->state);
+        }
 
         auto [host, port] = sim_core::parse_bind_address(state->config().server.http_bind);
 
-        asio::io_context ioc;
+        sim_core::IoPool pool(state->config().server.io_threads);
+        tcp::endpoint endpoint(asio::ip::make_address(host), port);
+
+        auto acceptors = sim_core::open_listeners(pool, endpoint, handoff);
 
-        tcp::acceptor acceptor(ioc, tcp::endpoint(asio::ip::make_address(host), port));
+        if (handoff.has_value()) {
+            sim_core::adopt_clients(*handoff, pool, state->hub(), [&state](auto& ioc, auto ws, auto id) {
+                asio::co_spawn(ioc, run_websocket_session(std::move(ws), state, id), asio::detached);
+            });
+            sim_core::complete_handoff(*handoff);
+            spdlog::info("  Took over {} listeners, {} clients and {} feeds",
+                handoff->listener_fds.size(), handoff->client_fds.size(), resumed);
+        }
 
-        asio::co_spawn(ioc, run_price_ticker(state), asio::detached);
+        sim_core::dispatch_fault_pipeline(
+            sim_core::oracle_fault_config(state->config()),
+            sim_core::create_labeled_rng(state->config().server.seed, "ORACLE_TICKER"),
+            [&](auto faults) {
+                faults.set_history(&state->history());
+                asio::co_spawn(pool.ticker_context(), run_price_ticker(state, std::move(faults)), asio::detached);
+            }
+        );
 
-        asio::co_spawn(ioc, listen(acceptor, state), asio::detached);
+        asio::co_spawn(pool.ticker_context(), sim_core::run_timers(state->hub()), asio::detached);
 
+        for (auto& acceptor : acceptors) {
+            asio::co_spawn(acceptor.get_executor(), listen(acceptor, state), asio::detached);
+        }
+
+        if (!state->config().server.handoff_socket.empty()) {
+            asio::co_spawn(
+                pool.ticker_context(),
+                sim_core::serve_handoff(state->config().server.handoff_socket, state, acceptors),
+                asio::detached
+            );
+        }
+
+        spdlog::info("  I/O threads: {}", pool.io_contexts().size());
+        if (sim_core::fast_clock().uses_tsc()) {
+            spdlog::info("  Clock: TSC at {:.3f} GHz", sim_core::fast_clock().tsc_ghz());
+        } else {
+            spdlog::info("  Clock: clock_gettime (no invariant TSC)");
+        }
         spdlog::info("🚀 Oracle server ready");
 
-        ioc.run();
+        pool.run();
 
     } catch (const std::exception& e) {
         spdlog::error("Fatal error: {}", e.what());
@@ -0,0 +1,114 @@
+#include <sim_core/config.hpp>
+#include <sim_core/seed_search.hpp>
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+// Headless search for the seeds that produce the worst DEX/oracle paths.
+//
+//   seed-search [--dex configs/dex.yaml] [--oracle configs/oracle.yaml]
+//               [--objective lag|drawdown|band] [--seeds 10000] [--first-seed 0]
+//               [--duration-ms 3600000] [--top 10] [--threads 0] [--json out.json]
+
+namespace {
+
+struct Args {
+    std::string dex_config = "configs/dex.yaml";
+    std::string oracle_config = "configs/oracle.yaml";
+    std::string json_path;
+    sim_core::SeedSearchOptions options;
+};
+
+Args parse_args(int argc, char* argv[]) {
+    Args args;
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (i + 1 >= argc) {
+            throw std::runtime_error("Missing value for " + flag);
+        }
+        std::string value = argv[++i];
+
+        if (flag == "--dex") args.dex_config = value;
+        else if (flag == "--oracle") args.oracle_config = value;
+        else if (flag == "--json") args.json_path = value;
+        else if (flag == "--objective") args.options.objective = sim_core::parse_search_objective(value);
+        else if (flag == "--seeds") args.options.seeds = std::stoull(value);
+        else if (flag == "--first-seed") args.options.first_seed = std::stoull(value);
+        else if (flag == "--duration-ms") args.options.duration_ms = std::stoull(value);
+        else if (flag == "--top") args.options.top = std::stoul(value);
+        else if (flag == "--threads") args.options.threads = static_cast<unsigned>(std::stoul(value));
+        else throw std::runtime_error("Unknown flag " + flag);
+    }
+    return args;
+}
+
+nlohmann::json to_json(const sim_core::RunScore& run, sim_core::SearchObjective objective) {
+    return nlohmann::json{
+        {"seed", run.seed},
+        {"score", run.score(objective)},
+        {"max_lag_bps", run.max_lag_bps},
+        {"max_drawdown_pct", run.max_drawdown_pct},
+        {"max_outside_band_ms", run.max_outside_band_ms},
+        {"dex_ticks", run.dex_ticks},
+        {"oracle_updates", run.oracle_updates}
+    };
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        auto console = spdlog::stderr_color_mt("console");
+        spdlog::set_default_logger(console);
+        spdlog::set_level(spdlog::level::info);
+
+        auto args = parse_args(argc, argv);
+        auto dex = sim_core::load_dex_config(args.dex_config);
+        auto oracle = sim_core::load_oracle_config(args.oracle_config);
+        const auto& options = args.options;
+
+        spdlog::info("🔎 Seed search: {} seeds from {}, {} ms each, objective={}",
+            options.seeds, options.first_seed, options.duration_ms,
+            sim_core::search_objective_name(options.objective));
+
+        auto started = std::chrono::steady_clock::now();
+        auto worst = sim_core::search_seeds(dex, oracle, options);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        spdlog::info("  Done in {:.2f}s ({:.0f} seeds/s)", elapsed, static_cast<double>(options.seeds) / elapsed);
+
+        std::printf("%-12s %14s %12s %16s %18s\n", "seed", "score", "lag_bps", "drawdown_pct", "outside_band_ms");
+        for (const auto& run : worst) {
+            std::printf("%-12llu %14.3f %12.2f %16.3f %18.0f\n",
+                static_cast<unsigned long long>(run.seed), run.score(options.objective),
+                run.max_lag_bps, run.max_drawdown_pct, run.max_outside_band_ms);
+        }
+
+        if (!args.json_path.empty()) {
+            auto out = nlohmann::json::array();
+            for (const auto& run : worst) {
+                out.push_back(to_json(run, options.objective));
+            }
+            std::ofstream file(args.json_path);
+            if (!file) {
+                throw std::runtime_error("Cannot write " + args.json_path);
+            }
+            file << out.dump(2) << "\n";
+        }
+
+        if (!worst.empty()) {
+            spdlog::info("  Replay: set `seed: {}` in {} and {}", worst.front().seed, args.dex_config, args.oracle_config);
+        }
+
+    } catch (const std::exception& e) {
+        spdlog::error("Fatal error: {}", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include <sim_core/config.hpp>
+#include <sim_core/trigger_sweep.hpp>
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Evaluates oracle trigger parameters over shared DEX paths.
+//
+//   trigger-sweep [--dex configs/dex.yaml] [--oracle configs/oracle.yaml]
+//                 [--deviation-bps 10,25,50,100,200] [--heartbeat-ms 60000,600000,3600000,86400000]
+//                 [--paths 32] [--first-seed 0] [--duration-ms 3600000] [--threads 0]
+//                 [--gas-per-update 100000] [--gas-price-gwei 20] [--json out.json]
+
+namespace {
+
+struct Args {
+    std::string dex_config = "configs/dex.yaml";
+    std::string oracle_config = "configs/oracle.yaml";
+    std::string json_path;
+    std::vector<uint32_t> deviation_bps{10, 25, 50, 100, 200};
+    std::vector<uint64_t> heartbeat_ms{60000, 600000, 3600000, 86400000};
+    sim_core::TriggerSweepOptions options;
+    sim_core::GasModel gas;
+};
+
+template<typename T>
+std::vector<T> parse_list(const std::string& value) {
+    std::vector<T> out;
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        out.push_back(static_cast<T>(std::stoull(item)));
+    }
+    if (out.empty()) {
+        throw std::runtime_error("Empty list: " + value);
+    }
+    return out;
+}
+
+Args parse_args(int argc, char* argv[]) {
+    Args args;
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (i + 1 >= argc) {
+            throw std::runtime_error("Missing value for " + flag);
+        }
+        std::string value = argv[++i];
+
+        if (flag == "--dex") args.dex_config = value;
+        else if (flag == "--oracle") args.oracle_config = value;
+        else if (flag == "--json") args.json_path = value;
+        else if (flag == "--deviation-bps") args.deviation_bps = parse_list<uint32_t>(value);
+        else if (flag == "--heartbeat-ms") args.heartbeat_ms = parse_list<uint64_t>(value);
+        else if (flag == "--paths") args.options.paths = std::stoull(value);
+        else if (flag == "--first-seed") args.options.first_seed = std::stoull(value);
+        else if (flag == "--duration-ms") args.options.duration_ms = std::stoull(value);
+        else if (flag == "--threads") args.options.threads = static_cast<unsigned>(std::stoul(value));
+        else if (flag == "--gas-per-update") args.gas.gas_per_update = std::stoull(value);
+        else if (flag == "--gas-price-gwei") args.gas.gas_price_gwei = std::stod(value);
+        else throw std::runtime_error("Unknown flag " + flag);
+    }
+    return args;
+}
+
+nlohmann::json to_json(const sim_core::TriggerStats& s) {
+    return nlohmann::json{
+        {"deviation_bps", s.params.deviation_bps},
+        {"heartbeat_ms", s.params.heartbeat_ms},
+        {"updates", s.updates},
+        {"updates_per_hour", s.updates_per_hour},
+        {"gas_eth", s.gas_eth},
+        {"max_staleness_bps", s.max_staleness_bps},
+        {"mean_staleness_bps", s.mean_staleness_bps},
+        {"max_age_ms", s.max_age_ms}
+    };
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        auto console = spdlog::stderr_color_mt("console");
+        spdlog::set_default_logger(console);
+        spdlog::set_level(spdlog::level::info);
+
+        auto args = parse_args(argc, argv);
+        auto dex = sim_core::load_dex_config(args.dex_config);
+        auto oracle = sim_core::load_oracle_config(args.oracle_config);
+        auto grid = sim_core::trigger_grid(args.deviation_bps, args.heartbeat_ms);
+        const auto& options = args.options;
+
+        spdlog::info("📐 Trigger sweep: {} parameter sets over {} paths of {} ms",
+            grid.size(), options.paths, options.duration_ms);
+
+        auto started = std::chrono::steady_clock::now();
+        auto sweep = sim_core::sweep_triggers(dex, oracle, grid, options);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        spdlog::info("  Done in {:.2f}s", elapsed);
+
+        auto stats = sweep.stats(args.gas);
+        std::printf("%8s %12s %10s %10s %12s %14s %15s %12s\n", "dev_bps", "heartbeat_ms", "updates",
+            "per_hour", "gas_eth", "max_stale_bps", "mean_stale_bps", "max_age_ms");
+        for (const auto& s : stats) {
+            std::printf("%8u %12llu %10llu %10.1f %12.6f %14.2f %15.2f %12.0f\n",
+                s.params.deviation_bps, static_cast<unsigned long long>(s.params.heartbeat_ms),
+                static_cast<unsigned long long>(s.updates), s.updates_per_hour, s.gas_eth,
+                s.max_staleness_bps, s.mean_staleness_bps, s.max_age_ms);
+        }
+
+        if (!args.json_path.empty()) {
+            auto out = nlohmann::json::array();
+            for (const auto& s : stats) {
+                out.push_back(to_json(s));
+            }
+            std::ofstream file(args.json_path);
+            if (!file) {
+                throw std::runtime_error("Cannot write " + args.json_path);
+            }
+            file << out.dump(2) << "\n";
+        }
+
+    } catch (const std::exception& e) {
+        spdlog::error("Fatal error: {}", e.what());
+        return 1;
+    }
+
+    return 0;
+}
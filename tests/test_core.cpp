@@ -5,18 +5,43 @@
 #include <sim_core/config.hpp>
 #include <sim_core/rng.hpp>
 #include <sim_core/gbm_engine.hpp>
+#include <sim_core/ou_engine.hpp>
+#include <sim_core/engine_factory.hpp>
+#include <sim_core/arrival.hpp>
+#include <sim_core/oracle_feeds.hpp>
+#include <sim_core/fault_pipeline.hpp>
+#include <sim_core/slot_map.hpp>
+#include <sim_core/delivery_order.hpp>
+#include <sim_core/send_scheduler.hpp>
+#include <sim_core/load_shedder.hpp>
+#include <sim_core/io_pool.hpp>
+#include <sim_core/handoff.hpp>
+#include <sim_core/timer_wheel.hpp>
+#include <sim_core/token_bucket.hpp>
 #include <sim_core/metrics.hpp>
 #include <sim_core/utils.hpp>
+#include <sim_core/clock.hpp>
+#include <sim_core/path_generator.hpp>
+#include <sim_core/seed_search.hpp>
+#include <sim_core/trigger_sweep.hpp>
+#include <sim_core/columnar_export.hpp>
+#include <sim_core/history_stream.hpp>
+#include <sim_core/digest.hpp>
 
 #include <gtest/gtest.h>
 #include <nlohmann/json.hpp>
 
+#include <thread>
+#include <bit>
+#include <tuple>
+#include <fstream>
+
 // Test: PriceMsg JSON serialization
 TEST(TypesTest, PriceMsgSerialization) {
     sim_core::PriceMsg msg{
         .ts = 1234567890,
         .pair = "ETH/USD",
-        .price = 3500.50,
+        .price = sim_core::Price::from_double(3500.50),
         .source = sim_core::SourceKind::Dex,
         .src_seq = 42,
         .delay_ms = 10,
@@ -39,7 +64,7 @@ TEST(TypesTest, WsMessageCreation) {
     sim_core::PriceMsg price_msg{
         .ts = 1000,
         .pair = "ETH/USD",
-        .price = 3500.0,
+        .price = sim_core::Price::from_double(3500.0),
         .source = sim_core::SourceKind::Chainlink,
         .src_seq = 1,
         .delay_ms = 5,
@@ -138,7 +163,7 @@ TEST(GbmEngineTest, Determinism) {
         auto tick1 = engine1.next_tick(i * 1000, i, sim_core::SourceKind::Dex, 0, false);
         auto tick2 = engine2.next_tick(i * 1000, i, sim_core::SourceKind::Dex, 0, false);
 
-        EXPECT_DOUBLE_EQ(tick1.price, tick2.price);
+        EXPECT_EQ(tick1.price, tick2.price);
         EXPECT_EQ(tick1.pair, tick2.pair);
         EXPECT_EQ(tick1.source, tick2.source);
     }
@@ -152,8 +177,8 @@ TEST(GbmEngineTest, PriceMovement) {
     std::vector<double> prices;
     for (int i = 0; i < 100; ++i) {
         auto tick = engine.next_tick(i * 1000, i, sim_core::SourceKind::Dex, 0, false);
-        prices.push_back(tick.price);
-        EXPECT_GT(tick.price, 0.0);  // Price must be positive
+        prices.push_back(tick.price.to_double());
+        EXPECT_GT(tick.price.raw, 0);  // Price must be positive
     }
 
     // Prices should vary (not all the same)
@@ -171,10 +196,10 @@ TEST(GbmEngineTest, CurrentPrice) {
     auto rng = sim_core::create_labeled_rng(42, "TEST");
     sim_core::GbmPriceEngine engine("ETH/USD", 3500.0, 0.0, 2.0, 1000, std::move(rng));
 
-    EXPECT_DOUBLE_EQ(engine.current_price(), 3500.0);
+    EXPECT_EQ(engine.current_price(), sim_core::Price::from_double(3500.0));
 
     auto tick = engine.next_tick(1000, 0, sim_core::SourceKind::Dex, 0, false);
-    EXPECT_DOUBLE_EQ(engine.current_price(), tick.price);
+    EXPECT_EQ(engine.current_price(), tick.price);
 }
 
 TEST(GbmEngineTest, Pair) {
@@ -184,6 +209,1998 @@ TEST(GbmEngineTest, Pair) {
     EXPECT_EQ(engine.pair(), "BTC/USD");
 }
 
+// Test: OU Price Engine
+TEST(OuEngineTest, RevertsToPeg) {
+    auto rng = sim_core::create_labeled_rng(42, "TEST");
+    // Start 10% below peg with a 1-minute reversion time scale
+    sim_core::OuPriceEngine engine("USDC/USD", 0.90, 1.0, 525960.0, 0.05,
+                                   0.0, 0.0, 0.0, 1000, std::move(rng));
+
+    for (int i = 0; i < 600; ++i) {
+        engine.next_tick(i * 1000, i, sim_core::SourceKind::Dex, 0, false);
+    }
+    EXPECT_NEAR(engine.current_price().to_double(), 1.0, 0.005);
+}
+
+TEST(OuEngineTest, Determinism) {
+    sim_core::OuPriceEngine engine1("USDC/USD", 1.0, 1.0, 8766.0, 0.05, 10.0, -0.05, 0.02,
+                                    1000, sim_core::create_labeled_rng(42, "TEST"));
+    sim_core::OuPriceEngine engine2("USDC/USD", 1.0, 1.0, 8766.0, 0.05, 10.0, -0.05, 0.02,
+                                    1000, sim_core::create_labeled_rng(42, "TEST"));
+
+    for (int i = 0; i < 100; ++i) {
+        auto tick1 = engine1.next_tick(i * 1000, i, sim_core::SourceKind::Dex, 0, false);
+        auto tick2 = engine2.next_tick(i * 1000, i, sim_core::SourceKind::Dex, 0, false);
+        EXPECT_EQ(tick1.price, tick2.price);
+    }
+}
+
+TEST(OuEngineTest, DepegJumps) {
+    auto rng = sim_core::create_labeled_rng(42, "TEST");
+    // ~1 jump per second of -10%, tiny diffusion
+    sim_core::OuPriceEngine engine("USDC/USD", 1.0, 1.0, 8766.0, 0.001, 3600.0, -0.1, 0.0,
+                                   1000, std::move(rng));
+
+    double min_price = 1.0;
+    for (int i = 0; i < 20; ++i) {
+        auto tick = engine.next_tick(i * 1000, i, sim_core::SourceKind::Dex, 0, false);
+        min_price = std::min(min_price, tick.price.to_double());
+    }
+    EXPECT_LT(min_price, 0.95);
+}
+
+TEST(EngineFactoryTest, SelectsModelPerPair) {
+    sim_core::ServerConfig config{};
+    config.price_model = "gbm";
+    config.pair_price_models["USDC/USD"] = "ou";
+    config.price_start = 1.0;
+    config.gbm_sigma = 2.0;
+    config.ou_peg = 1.0;
+    config.ou_theta = 8766.0;
+    config.ou_sigma = 0.05;
+
+    auto gbm = sim_core::make_engine(config, "ETH/USD", 1000, sim_core::create_labeled_rng(42, "TEST"));
+    auto ou = sim_core::make_engine(config, "USDC/USD", 1000, sim_core::create_labeled_rng(42, "TEST"));
+
+    EXPECT_TRUE(std::holds_alternative<sim_core::GbmPriceEngine>(gbm));
+    EXPECT_TRUE(std::holds_alternative<sim_core::OuPriceEngine>(ou));
+
+    config.price_model = "heston";
+    EXPECT_THROW(sim_core::make_engine(config, "ETH/USD", 1000, sim_core::create_labeled_rng(42, "TEST")),
+                 std::runtime_error);
+}
+
+TEST(EngineFactoryTest, BatchMatchesSingleSteps) {
+    sim_core::ServerConfig config{};
+    config.price_model = "gbm";
+    config.pair_price_models["USDC/USD"] = "ou";
+    config.price_start = 1.0;
+    config.price_decimals = 8;
+    config.gbm_sigma = 2.0;
+    config.ou_peg = 1.0;
+    config.ou_theta = 8766.0;
+    config.ou_sigma = 0.05;
+    config.jump_lambda = 100.0;
+    config.jump_mu = -0.05;
+    config.jump_sigma = 0.02;
+
+    for (const std::string pair : {"ETH/USD", "USDC/USD"}) {
+        auto single = sim_core::make_engine(config, pair, 1000, sim_core::create_labeled_rng(42, "TEST"));
+        auto batch = sim_core::make_engine(config, pair, 1000, sim_core::create_labeled_rng(42, "TEST"));
+
+        std::vector<int64_t> out(257);
+        sim_core::next_ticks(batch, out);
+
+        for (size_t i = 0; i < out.size(); ++i) {
+            EXPECT_EQ(sim_core::step(single), out[i]) << pair << " tick " << i;
+        }
+        EXPECT_EQ(sim_core::current_price(single), sim_core::current_price(batch));
+    }
+}
+
+TEST(EngineFactoryTest, VirtualAdapter) {
+    sim_core::ServerConfig config{};
+    config.price_model = "gbm";
+    config.price_start = 3500.0;
+    config.price_decimals = 8;
+    config.gbm_sigma = 2.0;
+
+    sim_core::PriceEnginePtr engine = sim_core::make_price_engine(
+        config, "ETH/USD", 1000, sim_core::create_labeled_rng(42, "TEST"));
+    sim_core::GbmPriceEngine direct("ETH/USD", 3500.0, 0.0, 2.0, 1000, sim_core::create_labeled_rng(42, "TEST"));
+
+    EXPECT_EQ(engine->pair(), "ETH/USD");
+    for (int i = 0; i < 10; ++i) {
+        auto tick = engine->next_tick(i, i, sim_core::SourceKind::Dex, 0, false);
+        EXPECT_EQ(tick.price, direct.next_tick(i, i, sim_core::SourceKind::Dex, 0, false).price);
+    }
+}
+
+TEST(EngineFactoryTest, SaveRestoreContinuesStream) {
+    sim_core::ServerConfig config{};
+    config.price_model = "jump";
+    config.pair_price_models["USDC/USD"] = "ou";
+    config.price_start = 1.0;
+    config.price_decimals = 6;
+    config.gbm_sigma = 2.0;
+    config.ou_peg = 1.0;
+    config.ou_theta = 8766.0;
+    config.ou_sigma = 0.05;
+    config.jump_lambda = 100.0;
+    config.jump_mu = -0.05;
+    config.jump_sigma = 0.02;
+    config.crash_tilt.crash_drop = 0.3;
+    config.crash_tilt.horizon_ms = 40'000;
+
+    for (const std::string pair : {"ETH/USD", "USDC/USD"}) {
+        auto original = sim_core::make_engine(config, pair, 1000, sim_core::create_labeled_rng(42, "TEST"));
+        sim_core::split_paths(original, 40);
+        for (int i = 0; i < 57; ++i) sim_core::step(original);
+
+        // A replacement built from another seed picks up mid-path
+        auto resumed = sim_core::make_engine(config, pair, 1000, sim_core::create_labeled_rng(7, "TEST"));
+        sim_core::split_paths(resumed, 40);
+        sim_core::restore_engine(resumed, nlohmann::json::parse(sim_core::save_engine(original).dump()));
+
+        for (int i = 0; i < 100; ++i) {
+            auto expected = sim_core::next_tick(original, i, i, sim_core::SourceKind::Dex, 0, false);
+            auto tick = sim_core::next_tick(resumed, i, i, sim_core::SourceKind::Dex, 0, false);
+            ASSERT_EQ(tick.price, expected.price) << pair << " tick " << i;
+            EXPECT_EQ(tick.log_weight, expected.log_weight);
+            EXPECT_EQ(tick.path, expected.path);
+        }
+
+        auto other = config;
+        other.price_decimals = 8;
+        auto rescaled = sim_core::make_engine(other, pair, 1000, sim_core::create_labeled_rng(7, "TEST"));
+        EXPECT_THROW(sim_core::restore_engine(rescaled, sim_core::save_engine(original)), std::runtime_error);
+    }
+
+    auto gbm = sim_core::make_engine(config, "ETH/USD", 1000, sim_core::create_labeled_rng(42, "TEST"));
+    auto ou = sim_core::make_engine(config, "USDC/USD", 1000, sim_core::create_labeled_rng(42, "TEST"));
+    EXPECT_THROW(sim_core::restore_engine(ou, sim_core::save_engine(gbm)), std::runtime_error);
+}
+
+// Test: Arrival processes
+TEST(ArrivalTest, UniformBounds) {
+    sim_core::UniformArrivals arrivals(10.0, 100.0, sim_core::create_labeled_rng(42, "TEST"));
+    for (int i = 0; i < 1000; ++i) {
+        double gap = arrivals.next_interval_ms();
+        EXPECT_GE(gap, 10.0);
+        EXPECT_LE(gap, 100.0);
+    }
+}
+
+TEST(ArrivalTest, MmppMeanRate) {
+    // Equal-length regimes at 10ms and 100ms mean gaps -> ~0.055 ticks/ms overall
+    sim_core::MmppArrivals arrivals(10.0, 100.0, 2000.0, 2000.0, sim_core::create_labeled_rng(42, "TEST"));
+
+    double total_ms = 0.0;
+    const int n = 200000;
+    for (int i = 0; i < n; ++i) {
+        total_ms += arrivals.next_interval_ms();
+    }
+    EXPECT_NEAR(n / total_ms, 0.055, 0.005);
+}
+
+TEST(ArrivalTest, HawkesStationaryRate) {
+    // Stationary rate is mu / (1 - alpha / beta) = 10 / 0.5 = 20 Hz
+    sim_core::HawkesArrivals arrivals(10.0, 5.0, 10.0, sim_core::create_labeled_rng(42, "TEST"));
+
+    double total_ms = 0.0;
+    const int n = 200000;
+    for (int i = 0; i < n; ++i) {
+        total_ms += arrivals.next_interval_ms();
+    }
+    EXPECT_NEAR(n / (total_ms / 1000.0), 20.0, 1.0);
+}
+
+TEST(ArrivalTest, HawkesRejectsExplosiveParams) {
+    EXPECT_THROW(sim_core::HawkesArrivals(10.0, 12.0, 10.0, sim_core::create_labeled_rng(42, "TEST")),
+                 std::invalid_argument);
+}
+
+TEST(ArrivalTest, SaveRestoreContinuesGaps) {
+    auto make = [](uint64_t seed) {
+        std::vector<sim_core::ArrivalProcessPtr> out;
+        out.push_back(std::make_unique<sim_core::UniformArrivals>(10.0, 100.0, sim_core::create_labeled_rng(seed, "TEST")));
+        out.push_back(std::make_unique<sim_core::MmppArrivals>(10.0, 100.0, 2000.0, 2000.0, sim_core::create_labeled_rng(seed, "TEST")));
+        out.push_back(std::make_unique<sim_core::HawkesArrivals>(10.0, 5.0, 10.0, sim_core::create_labeled_rng(seed, "TEST")));
+        return out;
+    };
+
+    auto original = make(42);
+    auto resumed = make(7);
+    for (size_t k = 0; k < original.size(); ++k) {
+        for (int i = 0; i < 333; ++i) original[k]->next_interval_ms();
+        resumed[k]->restore(nlohmann::json::parse(original[k]->save().dump()));
+        for (int i = 0; i < 1000; ++i) {
+            ASSERT_EQ(resumed[k]->next_interval_ms(), original[k]->next_interval_ms()) << "process " << k;
+        }
+    }
+
+    EXPECT_THROW(original[0]->restore(nlohmann::json{{"rng", "not a state"}}), std::runtime_error);
+}
+
+// Test: Oracle triggers and multi-feed runtime
+TEST(OracleFeedsTest, ShouldPublish) {
+    using sim_core::PublishTrigger;
+    auto price = [](double value) { return sim_core::Price::from_double(value); };
+
+    EXPECT_EQ(sim_core::should_publish(price(3500.0), std::nullopt, 5, 0, 3600000), PublishTrigger::First);
+    // 5 bps of 3500 is exactly 1.75
+    EXPECT_EQ(sim_core::should_publish(price(3501.75), price(3500.0), 5, 0, 3600000), PublishTrigger::Deviation);
+    EXPECT_EQ(sim_core::should_publish(price(3501.74999999), price(3500.0), 5, 0, 3600000), PublishTrigger::None);
+    EXPECT_EQ(sim_core::should_publish(price(3498.25), price(3500.0), 5, 0, 3600000), PublishTrigger::Deviation);
+    EXPECT_EQ(sim_core::should_publish(price(3501.70), price(3500.0), 5, 3600000, 3600000), PublishTrigger::Heartbeat);
+}
+
+TEST(OracleFeedsTest, DeviationMaskMatchesScalar) {
+    std::vector<int64_t> last{350000000000, 350000000000, 350000000000, 350000000000, 0};
+    std::vector<int64_t> current{350000000000, 350175000000, 349825000000, 350174999999, 100000000};
+    std::vector<int64_t> band;
+    for (size_t i = 0; i < last.size(); ++i) {
+        band.push_back(i + 1 < last.size() ? sim_core::deviation_band(last[i], 5) : 0);
+    }
+    std::vector<uint8_t> mask(current.size());
+
+    sim_core::deviation_mask(current.data(), last.data(), band.data(), mask.data(), current.size());
+
+    EXPECT_EQ(mask, (std::vector<uint8_t>{0, 1, 1, 0, 1}));
+    for (size_t i = 0; i + 1 < last.size(); ++i) {
+        EXPECT_EQ(mask[i] != 0, sim_core::deviation_exceeded(current[i], last[i], 5));
+    }
+}
+
+TEST(OracleFeedsTest, ThousandsOfFeeds) {
+    sim_core::OracleFeedSet feeds({1000, 3600}, 2000, sim_core::create_labeled_rng(42, "TEST"));
+    const uint32_t n = 5000;
+    for (uint32_t i = 0; i < n; ++i) {
+        sim_core::GbmPriceEngine engine(
+            "SYN" + std::to_string(i) + "/USD", 100.0, 0.0, 2.0, 1000,
+            sim_core::create_labeled_rng(42, std::to_string(i)));
+        feeds.add_feed("SYN" + std::to_string(i) + "/USD", std::move(engine), 10, 60000, 0);
+    }
+    EXPECT_EQ(feeds.size(), n);
+
+    // Every feed publishes once on its first poll, then only on triggers
+    std::vector<uint64_t> publishes(n, 0);
+    uint64_t now = 0;
+    while (now < 120000) {
+        now = feeds.next_due_ms();
+        for (const auto& publish : feeds.poll(now)) {
+            EXPECT_EQ(publish.seq, publishes[publish.feed]);
+            publishes[publish.feed]++;
+        }
+    }
+
+    for (uint32_t i = 0; i < n; ++i) {
+        // first publish plus at least one heartbeat within two minutes
+        EXPECT_GE(publishes[i], 2u);
+    }
+}
+
+TEST(OracleFeedsTest, HeartbeatFiresWithoutDeviation) {
+    sim_core::OracleFeedSet feeds({1000, 1000}, 2000, sim_core::create_labeled_rng(42, "TEST"));
+    // Zero volatility: only first publish and heartbeats
+    feeds.add_feed("ETH/USD", sim_core::GbmPriceEngine(
+        "ETH/USD", 3500.0, 0.0, 0.0, 1000, sim_core::create_labeled_rng(42, "TEST")), 5, 5000, 0);
+
+    std::vector<sim_core::PublishTrigger> triggers;
+    for (uint64_t now = 1000; now <= 11000; now += 1000) {
+        for (const auto& publish : feeds.poll(now)) {
+            triggers.push_back(publish.trigger);
+        }
+    }
+
+    ASSERT_EQ(triggers.size(), 3u);
+    EXPECT_EQ(triggers[0], sim_core::PublishTrigger::First);
+    EXPECT_EQ(triggers[1], sim_core::PublishTrigger::Heartbeat);
+    EXPECT_EQ(triggers[2], sim_core::PublishTrigger::Heartbeat);
+}
+
+TEST(OracleFeedsTest, SaveRestoreContinuesPublishes) {
+    auto make = [](uint64_t seed) {
+        sim_core::OracleFeedSet feeds({500, 1500}, 2000, sim_core::create_labeled_rng(seed, "TEST"));
+        for (const std::string pair : {"ETH/USD", "BTC/USD", "SOL/USD"}) {
+            feeds.add_feed(pair, sim_core::GbmPriceEngine(
+                pair, 100.0, 0.0, 2.0, 1000, sim_core::create_labeled_rng(seed, pair)), 10, 5000, 0);
+        }
+        return feeds;
+    };
+
+    // Publishes up to until, timed relative to offset
+    uint64_t last_poll = 0;
+    auto run = [&last_poll](sim_core::OracleFeedSet& feeds, uint64_t until, uint64_t offset) {
+        std::vector<std::tuple<uint32_t, uint64_t, int64_t, uint64_t>> out;
+        while (feeds.next_due_ms() < until) {
+            last_poll = feeds.next_due_ms();
+            for (const auto& publish : feeds.poll(last_poll)) {
+                out.emplace_back(publish.feed, publish.seq, publish.price.raw, last_poll - offset);
+            }
+        }
+        return out;
+    };
+
+    auto original = make(42);
+    run(original, 30'000, 0);
+    uint64_t paused_at = last_poll;
+    auto saved = nlohmann::json::parse(original.save().dump());
+    auto expected = run(original, 90'000, paused_at);
+    ASSERT_GT(expected.size(), 10u);
+
+    // Resumes as of the original's last poll, on the new process's clock
+    auto resumed = make(7);
+    EXPECT_EQ(resumed.restore(saved, 0), 3u);
+    EXPECT_EQ(run(resumed, 90'000 - paused_at, 0), expected);
+}
+
+// Test: Fixed-point prices
+TEST(FixedPointTest, RoundTrip) {
+    auto price = sim_core::Price::from_double(3500.12345678);
+    EXPECT_EQ(price.raw, 350012345678);
+    EXPECT_EQ(price.decimals, 8);
+    EXPECT_DOUBLE_EQ(price.to_double(), 3500.12345678);
+
+    auto wei = sim_core::Price::from_double(1.000000000000000001, 18);
+    EXPECT_EQ(wei.raw, 1000000000000000000);
+
+    EXPECT_THROW(sim_core::Price::from_double(1.0, 19), std::invalid_argument);
+
+    // Out of int64 range is rejected rather than wrapped
+    EXPECT_THROW(sim_core::Price::from_double(9.3, 18), std::out_of_range);
+    EXPECT_THROW(sim_core::Price::from_double(3500.0, 16), std::out_of_range);
+    EXPECT_THROW(sim_core::Price::from_double(std::nan(""), 8), std::out_of_range);
+    EXPECT_NO_THROW(sim_core::Price::from_double(-9.2, 18));
+
+    // Configs need headroom above price_start
+    EXPECT_NO_THROW(sim_core::check_price_scale("ETH/USD", 3500.0, 3500.0, 8));
+    EXPECT_THROW(sim_core::check_price_scale("ETH/USD", 3500.0, 3500.0, 16), std::runtime_error);
+    EXPECT_THROW(sim_core::check_price_scale("USDC/USD", 1.0, 1.0, 18), std::runtime_error);
+    EXPECT_NO_THROW(sim_core::check_price_scale("USDC/USD", 1.0, 1.0, 15));
+    EXPECT_THROW(sim_core::check_price_scale("USDC/USD", 1.0, 1e9, 8), std::runtime_error);  // OU peg
+}
+
+TEST(FixedPointTest, DeviationBandIsExact) {
+    // floor(|dp / p| * 10000) >= bps  <=>  |dp| >= ceil(p * bps / 10000)
+    EXPECT_EQ(sim_core::deviation_band(350000000000, 5), 175000000);
+    EXPECT_EQ(sim_core::deviation_band(10001, 1), 2);
+    EXPECT_EQ(sim_core::deviation_band(10000, 1), 1);
+    EXPECT_EQ(sim_core::deviation_band(0, 50), 0);
+
+    // No overflow near the top of the int64 range
+    int64_t big = INT64_MAX / 2;
+    EXPECT_EQ(sim_core::deviation_band(big, 10000), big);
+}
+
+TEST(FixedPointTest, RecordBinaryRoundTrip) {
+    sim_core::PriceMsg msg{
+        .ts = 1699123456789,
+        .pair = "ETH/USD",
+        .price = sim_core::Price::from_double(3500.5),
+        .source = sim_core::SourceKind::Chainlink,
+        .src_seq = 42,
+        .delay_ms = 17,
+        .stale = true
+    };
+
+    auto record = sim_core::to_record(msg, 3);
+    uint8_t bytes[sim_core::PriceRecord::kEncodedSize];
+    sim_core::encode_record(record, bytes);
+    auto decoded = sim_core::from_record(sim_core::decode_record(bytes), "ETH/USD");
+
+    EXPECT_EQ(bytes[0], 1699123456789 & 0xff);
+    EXPECT_EQ(decoded.ts, msg.ts);
+    EXPECT_EQ(decoded.price, msg.price);
+    EXPECT_EQ(decoded.source, msg.source);
+    EXPECT_EQ(decoded.src_seq, msg.src_seq);
+    EXPECT_EQ(decoded.delay_ms, msg.delay_ms);
+    EXPECT_EQ(decoded.stale, msg.stale);
+
+    nlohmann::json j = decoded;
+    EXPECT_DOUBLE_EQ(j["price"], 3500.5);
+}
+
+// Test: Fault pipeline
+namespace {
+
+sim_core::PriceMsg make_tick(uint64_t seq) {
+    return sim_core::PriceMsg{
+        .ts = seq,
+        .pair = "ETH/USD",
+        .price = sim_core::Price::from_double(3500.0),
+        .source = sim_core::SourceKind::Dex,
+        .src_seq = seq,
+        .delay_ms = 0,
+        .stale = false
+    };
+}
+
+}
+
+TEST(FaultPipelineTest, CleanConfigSelectsNoOpStages) {
+    sim_core::FaultConfig clean{{0, 0}, {0, 0}, 0.0, 0.0, 0.0, 0};
+    bool dispatched = false;
+
+    sim_core::dispatch_fault_pipeline(clean, sim_core::create_labeled_rng(42, "TEST"), [&](auto faults) {
+        using Expected = sim_core::FaultPipeline<sim_core::NoDelay, sim_core::NoDrop, sim_core::NoDup,
+                                                 sim_core::NoReorder, sim_core::NoStaleness>;
+        EXPECT_TRUE((std::is_same_v<decltype(faults), Expected>));
+        dispatched = true;
+
+        std::vector<uint64_t> seqs;
+        for (uint64_t i = 0; i < 100; ++i) {
+            faults.process(make_tick(i), i * 10, [&](const sim_core::PriceMsg& m) { seqs.push_back(m.src_seq); });
+        }
+        ASSERT_EQ(seqs.size(), 100u);
+        EXPECT_TRUE(std::is_sorted(seqs.begin(), seqs.end()));
+    });
+    EXPECT_TRUE(dispatched);
+}
+
+TEST(FaultPipelineTest, ChaosStages) {
+    sim_core::get_metrics().reset();
+    sim_core::FaultConfig chaos{{8, 45}, {0, 30}, 0.1, 0.1, 0.1, 250};
+
+    std::vector<sim_core::PriceMsg> frames;
+    sim_core::dispatch_fault_pipeline(chaos, sim_core::create_labeled_rng(42, "TEST"), [&](auto faults) {
+        for (uint64_t i = 0; i < 10000; ++i) {
+            // every 100th tick arrives after a 300ms gap
+            uint64_t now = i * 10 + (i / 100) * 300;
+            faults.process(make_tick(i), now, [&](const sim_core::PriceMsg& m) { frames.push_back(m); });
+        }
+    });
+
+    auto& metrics = sim_core::get_metrics();
+    EXPECT_GT(metrics.ws_frames_dropped.load(), 800u);
+    EXPECT_GT(metrics.ws_frames_duplicated.load(), 700u);
+    EXPECT_GT(metrics.ws_frames_reordered.load(), 700u);
+
+    size_t out_of_order = 0;
+    size_t stale = 0;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        EXPECT_GE(frames[i].delay_ms, 8u);
+        EXPECT_LE(frames[i].delay_ms, 75u);
+        if (i > 0 && frames[i].src_seq < frames[i - 1].src_seq) out_of_order++;
+        if (frames[i].stale) stale++;
+    }
+    EXPECT_GT(out_of_order, 0u);
+    EXPECT_GT(stale, 0u);
+    EXPECT_LT(stale, 200u);
+    metrics.reset();
+}
+
+TEST(FaultPipelineTest, ReorderStaysWithinStream) {
+    sim_core::get_metrics().reset();
+    sim_core::FaultConfig reorder{{0, 0}, {0, 0}, 0.0, 0.0, 0.3, 0};
+
+    // Two interleaved streams; a frame held on one is only released by the
+    // next frame of the same stream
+    std::vector<std::vector<uint64_t>> seqs(2);
+    size_t cross_stream = 0;
+    sim_core::dispatch_fault_pipeline(reorder, sim_core::create_labeled_rng(42, "TEST"), [&](auto faults) {
+        for (uint64_t i = 0; i < 2000; ++i) {
+            uint32_t stream = static_cast<uint32_t>(i % 2);
+            faults.process(make_tick(i), i * 10, [&](const sim_core::PriceMsg& m) {
+                if (m.src_seq % 2 != stream) cross_stream++;
+                seqs[m.src_seq % 2].push_back(m.src_seq);
+            }, stream);
+        }
+    });
+
+    EXPECT_EQ(cross_stream, 0u);
+    EXPECT_GT(sim_core::get_metrics().ws_frames_reordered.load(), 400u);
+    for (uint32_t stream = 0; stream < 2; ++stream) {
+        const auto& out = seqs[stream];
+        EXPECT_GE(out.size(), 999u);  // at most the last frame still held
+        size_t swapped = 0;
+        for (size_t i = 1; i < out.size(); ++i) {
+            if (out[i] < out[i - 1]) {
+                EXPECT_EQ(out[i - 1] - out[i], 2u);  // adjacent frames of this stream
+                swapped++;
+            }
+        }
+        EXPECT_GT(swapped, 100u);
+    }
+    sim_core::get_metrics().reset();
+}
+
+TEST(FaultPipelineTest, SaveRestoreKeepsHeldFrames) {
+    sim_core::FaultConfig chaos{{8, 45}, {0, 30}, 0.05, 0.1, 0.3, 0, sim_core::BurstLossConfig{0.05, 0.25, 0.8}};
+
+    auto tick = [](uint64_t i) {
+        auto msg = make_tick(i);
+        msg.price = sim_core::Price{350012345 + static_cast<int64_t>(i), 5};
+        return msg;
+    };
+
+    nlohmann::json saved;
+    std::vector<sim_core::PriceMsg> expected;
+    sim_core::dispatch_fault_pipeline(chaos, sim_core::create_labeled_rng(42, "TEST"), [&](auto faults) {
+        for (uint64_t i = 0; i < 500; ++i) {
+            faults.process(tick(i), i, [](const sim_core::PriceMsg&) {}, static_cast<uint32_t>(i % 3));
+        }
+        saved = nlohmann::json::parse(faults.save().dump());
+        for (uint64_t i = 500; i < 1000; ++i) {
+            faults.process(tick(i), i, [&](const sim_core::PriceMsg& m) { expected.push_back(m); },
+                static_cast<uint32_t>(i % 3));
+        }
+    });
+    EXPECT_FALSE(saved.at("held").empty());
+
+    std::vector<sim_core::PriceMsg> frames;
+    sim_core::dispatch_fault_pipeline(chaos, sim_core::create_labeled_rng(7, "TEST"), [&](auto faults) {
+        faults.restore(saved);
+        for (uint64_t i = 500; i < 1000; ++i) {
+            faults.process(tick(i), i, [&](const sim_core::PriceMsg& m) { frames.push_back(m); },
+                static_cast<uint32_t>(i % 3));
+        }
+    });
+
+    ASSERT_EQ(frames.size(), expected.size());
+    for (size_t i = 0; i < frames.size(); ++i) {
+        EXPECT_EQ(frames[i].src_seq, expected[i].src_seq);
+        EXPECT_EQ(frames[i].delay_ms, expected[i].delay_ms);
+        EXPECT_EQ(frames[i].price, expected[i].price);
+    }
+}
+
+// Test: Fair delivery
+TEST(SlotMapTest, GenerationsInvalidateStaleIds) {
+    sim_core::SlotMap<int> map;
+    auto a = map.insert(1);
+    auto b = map.insert(2);
+    auto c = map.insert(3);
+
+    EXPECT_TRUE(map.erase(a));
+    EXPECT_FALSE(map.erase(a));
+    EXPECT_EQ(map.size(), 2u);
+    EXPECT_EQ(*map.get(b), 2);
+    EXPECT_EQ(*map.get(c), 3);
+
+    // reused slot gets a new generation, old handle stays dead
+    auto d = map.insert(4);
+    EXPECT_EQ(d.index, a.index);
+    EXPECT_NE(d.generation, a.generation);
+    EXPECT_EQ(map.get(a), nullptr);
+    EXPECT_EQ(*map.get(d), 4);
+
+    for (size_t i = 0; i < map.size(); ++i) {
+        EXPECT_EQ(*map.get(map.id_at(i)), map.value_at(i));
+    }
+}
+
+TEST(DeliveryOrderTest, RotateGivesEveryClientEachRank) {
+    const size_t n = 7;
+    sim_core::DeliveryOrder order(sim_core::SendOrder::Rotate, sim_core::create_labeled_rng(42, "TEST"));
+
+    std::vector<std::vector<int>> rank_counts(n, std::vector<int>(n, 0));
+    for (size_t round = 0; round < n; ++round) {
+        const auto& perm = order.next_round(n);
+        for (size_t rank = 0; rank < n; ++rank) {
+            rank_counts[perm[rank]][rank]++;
+        }
+    }
+    for (size_t client = 0; client < n; ++client) {
+        for (size_t rank = 0; rank < n; ++rank) {
+            EXPECT_EQ(rank_counts[client][rank], 1);
+        }
+    }
+}
+
+TEST(DeliveryOrderTest, ShuffleIsPermutation) {
+    sim_core::DeliveryOrder order(sim_core::SendOrder::Shuffle, sim_core::create_labeled_rng(42, "TEST"));
+
+    std::vector<int> first(10, 0);
+    for (int round = 0; round < 1000; ++round) {
+        auto perm = order.next_round(10);
+        first[perm[0]]++;
+        std::sort(perm.begin(), perm.end());
+        for (uint32_t i = 0; i < 10; ++i) {
+            ASSERT_EQ(perm[i], i);
+        }
+    }
+    for (int count : first) {
+        EXPECT_GT(count, 50);
+    }
+    EXPECT_THROW(sim_core::parse_send_order("fifo"), std::runtime_error);
+}
+
+TEST(DeliveryOrderTest, RankHistogramBuckets) {
+    sim_core::RankHistogram hist;
+    for (uint32_t rank : {0u, 1u, 2u, 3u, 4u, 63u, 64u, 1000u}) {
+        hist.record(rank);
+    }
+    EXPECT_EQ(hist.buckets[0], 1u);
+    EXPECT_EQ(hist.buckets[1], 1u);
+    EXPECT_EQ(hist.buckets[2], 2u);
+    EXPECT_EQ(hist.buckets[3], 1u);
+    EXPECT_EQ(hist.buckets[6], 1u);
+    EXPECT_EQ(hist.buckets[7], 2u);
+    EXPECT_EQ(hist.count, 8u);
+    EXPECT_EQ(sim_core::RankHistogram::upper_bound(2), "3");
+    EXPECT_EQ(sim_core::RankHistogram::upper_bound(7), "+Inf");
+}
+
+TEST(DeliveryOrderTest, RankRecordedWhenWriteStarts) {
+    namespace asio = boost::asio;
+    namespace websocket = boost::beast::websocket;
+    using tcp = asio::ip::tcp;
+
+    asio::io_context ioc;
+    tcp::acceptor acceptor(ioc, tcp::endpoint(asio::ip::make_address("127.0.0.1"), 0));
+    std::vector<std::unique_ptr<websocket::stream<tcp::socket>>> peers;
+    auto connect = [&] {
+        peers.push_back(std::make_unique<websocket::stream<tcp::socket>>(ioc));
+        auto& peer = *peers.back();
+        std::thread handshake([&] {
+            peer.next_layer().connect(acceptor.local_endpoint());
+            peer.handshake("127.0.0.1", "/ws/ticks");
+        });
+        auto server = std::make_shared<sim_core::WsHub::Stream>(acceptor.accept());
+        server->accept();
+        handshake.join();
+        return server;
+    };
+
+    // One write at a time, always conflating below critical
+    sim_core::WsHub hub(sim_core::SendOrder::Rotate, std::mt19937_64(1), 1, 0);
+    auto critical = hub.add(connect(), sim_core::Tier::Critical);
+    auto normal = hub.add(connect(), sim_core::Tier::Normal);
+    hub.activate(critical);
+    hub.activate(normal);
+
+    for (int i = 0; i < 10; ++i) {
+        hub.broadcast("ETH/USD", std::to_string(i));
+    }
+    while (!hub.drained()) ioc.run_one();
+
+    // The normal client was written only the last frame; the nine it lost to
+    // conflation are not ranked, and only that frame had a second writer
+    std::string metrics = hub.to_prometheus();
+    auto value_of = [&](const std::string& metric, sim_core::SlotId id) {
+        std::string prefix = metric + "{client=\"" + id.to_string() + "\"} ";
+        auto at = metrics.find(prefix);
+        return at == std::string::npos ? -1 : std::stoi(metrics.substr(at + prefix.size()));
+    };
+    EXPECT_EQ(value_of("ws_delivery_rank_count", critical), 10);
+    EXPECT_EQ(value_of("ws_delivery_rank_count", normal), 1);
+    EXPECT_EQ(value_of("ws_delivery_rank_sum", critical) + value_of("ws_delivery_rank_sum", normal), 1);
+}
+
+TEST(SendSchedulerTest, WeightedTiersDrainHigherFirst) {
+    sim_core::TierScheduler scheduler;
+    for (uint32_t i = 0; i < 100; ++i) {
+        scheduler.push(sim_core::Tier::Critical, sim_core::SlotId{i, 0});
+        scheduler.push(sim_core::Tier::Normal, sim_core::SlotId{100 + i, 0});
+        scheduler.push(sim_core::Tier::Dashboard, sim_core::SlotId{200 + i, 0});
+    }
+
+    // first round: 8 critical, 3 normal, 1 dashboard, in that order
+    std::vector<uint32_t> round;
+    for (int i = 0; i < 12; ++i) {
+        round.push_back(scheduler.pop()->index / 100);
+    }
+    EXPECT_EQ(round, (std::vector<uint32_t>{0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 2}));
+
+    // lower tiers are never starved, and take over once critical is empty
+    std::array<int, sim_core::kTierCount> served{};
+    while (auto id = scheduler.pop()) {
+        served[id->index / 100]++;
+    }
+    EXPECT_EQ(served[0], 92);
+    EXPECT_EQ(served[1], 97);
+    EXPECT_EQ(served[2], 99);
+    EXPECT_TRUE(scheduler.empty());
+    EXPECT_THROW(sim_core::parse_tier("vip"), std::runtime_error);
+}
+
+TEST(SendSchedulerTest, ConflationKeepsNewestPerPair) {
+    auto frame = [](const std::string& key, const std::string& payload) {
+        return std::make_shared<const sim_core::OutboundFrame>(sim_core::OutboundFrame{key, payload});
+    };
+
+    sim_core::SubscriberQueue queue;
+    EXPECT_FALSE(queue.push(frame("ETH/USD", "1"), true));
+    EXPECT_TRUE(queue.push(frame("ETH/USD", "2"), true));
+    EXPECT_FALSE(queue.push(frame("BTC/USD", "3"), true));
+    EXPECT_FALSE(queue.push(frame("BTC/USD", "4"), false));
+    EXPECT_EQ(queue.size(), 3u);
+
+    EXPECT_EQ(queue.pop()->payload, "2");
+    EXPECT_EQ(queue.pop()->payload, "3");
+    EXPECT_EQ(queue.pop()->payload, "4");
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(SendSchedulerTest, ConflationReplacesInterleavedPairs) {
+    auto frame = [](const std::string& key, const std::string& payload) {
+        return std::make_shared<const sim_core::OutboundFrame>(sim_core::OutboundFrame{key, payload});
+    };
+
+    // ETH, BTC, ETH... each conflates onto its own pair's queued frame
+    sim_core::SubscriberQueue queue;
+    EXPECT_FALSE(queue.push(frame("ETH/USD", "e1"), true));
+    EXPECT_FALSE(queue.push(frame("BTC/USD", "b1"), true));
+    for (int i = 2; i <= 50; ++i) {
+        EXPECT_TRUE(queue.push(frame("ETH/USD", "e" + std::to_string(i)), true));
+        EXPECT_TRUE(queue.push(frame("BTC/USD", "b" + std::to_string(i)), true));
+    }
+    EXPECT_EQ(queue.size(), 2u);
+
+    // Only the newest frame for a pair is replaced, never an older one ahead of it
+    EXPECT_FALSE(queue.push(frame("ETH/USD", "e51"), false));
+    EXPECT_TRUE(queue.push(frame("ETH/USD", "e52"), true));
+    EXPECT_EQ(queue.pop()->payload, "e50");
+    EXPECT_EQ(queue.pop()->payload, "b50");
+    EXPECT_EQ(queue.pop()->payload, "e52");
+    EXPECT_TRUE(queue.empty());
+    EXPECT_FALSE(queue.push(frame("ETH/USD", "e53"), true));
+    EXPECT_EQ(queue.pop()->payload, "e53");
+
+    // Positions stay right across compaction
+    const std::array<std::string, 3> keys{"ETH/USD", "BTC/USD", "SOL/USD"};
+    for (int i = 0; i < 99; ++i) {
+        queue.push(frame(keys[i % 3], std::to_string(i)), false);
+    }
+    for (int i = 0; i < 70; ++i) {
+        ASSERT_EQ(queue.pop()->payload, std::to_string(i));
+    }
+    for (int k = 0; k < 3; ++k) {
+        EXPECT_TRUE(queue.push(frame(keys[k], "new" + std::to_string(k)), true));
+    }
+    std::vector<std::string> rest;
+    while (!queue.empty()) rest.push_back(queue.pop()->payload);
+    ASSERT_EQ(rest.size(), 29u);
+    EXPECT_EQ(rest[26], "new0");
+    EXPECT_EQ(rest[27], "new1");
+    EXPECT_EQ(rest[28], "new2");
+    EXPECT_EQ(rest[25], "95");
+}
+
+TEST(SendSchedulerTest, QueueKeepsOrderAcrossCompaction) {
+    sim_core::SubscriberQueue queue;
+    int next_in = 0;
+    int next_out = 0;
+
+    // stays partly full, so the consumed prefix gets compacted away
+    for (int round = 0; round < 50; ++round) {
+        for (int i = 0; i < 30; ++i, ++next_in) {
+            queue.push(std::make_shared<const sim_core::OutboundFrame>(
+                sim_core::OutboundFrame{"ETH/USD", std::to_string(next_in)}), false);
+        }
+        for (int i = 0; i < 25; ++i, ++next_out) {
+            ASSERT_EQ(queue.pop()->payload, std::to_string(next_out));
+        }
+    }
+    EXPECT_EQ(queue.size(), static_cast<size_t>(next_in - next_out));
+    while (!queue.empty()) {
+        ASSERT_EQ(queue.pop()->payload, std::to_string(next_out++));
+    }
+    EXPECT_EQ(next_out, next_in);
+}
+
+// Test: Load shedding
+TEST(LoadShedderTest, EscalatesOnLagAndRecoversWithHysteresis) {
+    sim_core::LoadShedder shedder({50.0, 250.0, 1000, 5000, 20});
+    using sim_core::LoadMode;
+
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_FALSE(shedder.update(5.0, 10));
+    }
+    EXPECT_EQ(shedder.mode(), LoadMode::Normal);
+
+    // a single late tick is smoothed away
+    EXPECT_FALSE(shedder.update(100.0, 10));
+    EXPECT_EQ(shedder.mode(), LoadMode::Normal);
+
+    // sustained lag degrades, heavier lag sheds
+    int samples = 0;
+    while (shedder.mode() == LoadMode::Normal && samples++ < 100) {
+        shedder.update(120.0, 10);
+    }
+    EXPECT_EQ(shedder.mode(), LoadMode::Degraded);
+    while (shedder.mode() == LoadMode::Degraded && samples++ < 200) {
+        shedder.update(400.0, 10);
+    }
+    EXPECT_EQ(shedder.mode(), LoadMode::Shedding);
+
+    // backlog alone escalates too
+    sim_core::LoadShedder by_backlog({50.0, 250.0, 1000, 5000, 20});
+    EXPECT_TRUE(by_backlog.update(0.0, 6000));
+    EXPECT_EQ(by_backlog.mode(), LoadMode::Shedding);
+
+    // lag between the recover and enter thresholds holds the current mode
+    for (int i = 0; i < 200; ++i) {
+        shedder.update(200.0, 10);
+    }
+    EXPECT_EQ(shedder.mode(), LoadMode::Shedding);
+
+    // recovery steps down one level at a time
+    std::vector<LoadMode> seen;
+    for (int i = 0; i < 400; ++i) {
+        if (shedder.update(0.0, 0)) seen.push_back(shedder.mode());
+    }
+    EXPECT_EQ(seen, (std::vector<LoadMode>{LoadMode::Degraded, LoadMode::Normal}));
+}
+
+TEST(IoPoolTest, ReusePortAcceptorsShareEndpoint) {
+    sim_core::IoPool pool(3);
+    auto contexts = pool.io_contexts();
+    ASSERT_EQ(contexts.size(), 3u);
+    EXPECT_TRUE(pool.reuse_port());
+
+    auto first = sim_core::open_acceptor(*contexts[0],
+        boost::asio::ip::tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0), true);
+    auto endpoint = first.local_endpoint();
+
+    std::vector<boost::asio::ip::tcp::acceptor> rest;
+    for (size_t i = 1; i < contexts.size(); ++i) {
+        EXPECT_NO_THROW(rest.push_back(sim_core::open_acceptor(*contexts[i], endpoint, true)));
+    }
+
+    sim_core::IoPool single(1);
+    EXPECT_FALSE(single.reuse_port());
+    EXPECT_EQ(single.io_contexts().front(), &single.ticker_context());
+}
+
+// Test: Handoff
+TEST(HandoffTest, PassesStateAndDescriptors) {
+    int conn[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, conn), 0);
+
+    int listener_pipe[2];
+    int client_pipe[2];
+    ASSERT_EQ(::pipe(listener_pipe), 0);
+    ASSERT_EQ(::pipe(client_pipe), 0);
+
+    nlohmann::json state{{"seq", 42}};
+    sim_core::send_handoff(conn[0], state, {listener_pipe[1]}, {{client_pipe[1], sim_core::Tier::Critical, {2048, 512}}});
+
+    auto handoff = sim_core::receive_handoff(conn[1]);
+    EXPECT_EQ(handoff.state["seq"], 42);
+    ASSERT_EQ(handoff.listener_fds.size(), 1u);
+    ASSERT_EQ(handoff.client_fds.size(), 1u);
+    EXPECT_EQ(handoff.client_tiers[0], sim_core::Tier::Critical);
+    EXPECT_EQ(handoff.client_limits[0].bytes_per_sec, 2048u);
+    EXPECT_EQ(handoff.client_limits[0].burst_bytes, 512u);
+
+    // received descriptors refer to the same pipes
+    ASSERT_EQ(::write(handoff.client_fds[0], "x", 1), 1);
+    char c = 0;
+    ASSERT_EQ(::read(client_pipe[0], &c, 1), 1);
+    EXPECT_EQ(c, 'x');
+
+    sim_core::complete_handoff(handoff);
+    boost::asio::io_context ioc;
+    boost::asio::local::stream_protocol::socket old_side(ioc, boost::asio::local::stream_protocol(), ::dup(conn[0]));
+    bool acked = false;
+    boost::asio::co_spawn(ioc, [&]() -> boost::asio::awaitable<void> {
+        acked = co_await sim_core::async_await_handoff_ack(old_side, std::chrono::milliseconds(1000));
+    }, boost::asio::detached);
+    ioc.run();
+    EXPECT_TRUE(acked);
+
+    for (int fd : {conn[0], listener_pipe[0], listener_pipe[1], client_pipe[0], client_pipe[1],
+                   handoff.listener_fds[0], handoff.client_fds[0]}) {
+        ::close(fd);
+    }
+}
+
+TEST(HandoffTest, AckTimeoutDoesNotBlock) {
+    namespace asio = boost::asio;
+    int conn[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, conn), 0);
+
+    asio::io_context ioc;
+    asio::local::stream_protocol::socket old_side(ioc, asio::local::stream_protocol(), conn[0]);
+    std::optional<bool> acked;
+    asio::co_spawn(ioc, [&]() -> asio::awaitable<void> {
+        acked = co_await sim_core::async_await_handoff_ack(old_side, std::chrono::milliseconds(100));
+    }, asio::detached);
+
+    // other work on the same thread runs while the ack is awaited
+    bool ticked = false;
+    asio::steady_timer timer(ioc, std::chrono::milliseconds(10));
+    timer.async_wait([&](boost::system::error_code) { ticked = !acked.has_value(); });
+    ioc.run();
+
+    EXPECT_TRUE(ticked);
+    ASSERT_TRUE(acked.has_value());
+    EXPECT_FALSE(*acked);
+    ::close(conn[1]);
+}
+
+TEST(HandoffTest, HubStopsReadsBeforeHandingOver) {
+    namespace asio = boost::asio;
+    namespace websocket = boost::beast::websocket;
+    using tcp = asio::ip::tcp;
+
+    asio::io_context ioc;
+    tcp::acceptor acceptor(ioc, tcp::endpoint(asio::ip::make_address("127.0.0.1"), 0));
+    websocket::stream<tcp::socket> client(ioc);
+    std::thread handshake([&] {
+        client.next_layer().connect(acceptor.local_endpoint());
+        client.handshake("127.0.0.1", "/ws/ticks");
+    });
+    auto server = std::make_shared<sim_core::WsHub::Stream>(acceptor.accept());
+    server->accept();
+    handshake.join();
+
+    sim_core::WsHub hub(sim_core::SendOrder::Rotate, std::mt19937_64(1));
+    auto id = hub.add(server);
+    hub.activate(id);
+
+    // the session a server runs per subscriber: read until error, then remove
+    bool session_ended = false;
+    asio::co_spawn(ioc, [&]() -> asio::awaitable<void> {
+        std::array<char, 64> scratch;
+        try {
+            while (true) co_await server->async_read_some(asio::buffer(scratch), asio::use_awaitable);
+        } catch (const std::exception&) {
+        }
+        session_ended = true;
+        hub.remove(id);
+    }, asio::detached);
+    ioc.poll();
+
+    hub.freeze_for_handoff();
+    EXPECT_FALSE(hub.add(server).valid());  // no joins mid-handoff
+    EXPECT_TRUE(hub.writes_idle());
+    hub.stop_reads();
+    while (!hub.reads_stopped() || !session_ended) ioc.run_one();
+    EXPECT_EQ(hub.size(), 1u);  // kept for the new process
+
+    auto clients = hub.handoff_clients();
+    ASSERT_EQ(clients.size(), 1u);
+
+    // input sent now is left for the new process
+    client.write(asio::buffer(std::string("to new")));
+    ioc.poll();
+    auto adopted = sim_core::adopt_websocket(ioc, clients[0].fd);
+    boost::beast::flat_buffer buffer;
+    adopted->read(buffer);
+    EXPECT_EQ(boost::beast::buffers_to_string(buffer.data()), "to new");
+
+    hub.abort_handoff();
+    EXPECT_EQ(hub.size(), 0u);
+}
+
+TEST(HandoffTest, CarriesPartlyReadFrame) {
+    namespace asio = boost::asio;
+    namespace websocket = boost::beast::websocket;
+    using tcp = asio::ip::tcp;
+
+    asio::io_context ioc;
+    tcp::acceptor acceptor(ioc, tcp::endpoint(asio::ip::make_address("127.0.0.1"), 0));
+    websocket::stream<tcp::socket> client(ioc);
+    std::thread handshake([&] {
+        client.next_layer().connect(acceptor.local_endpoint());
+        client.handshake("127.0.0.1", "/ws/ticks");
+    });
+    auto server = std::make_shared<sim_core::WsHub::Stream>(acceptor.accept());
+    server->accept();
+    handshake.join();
+
+    sim_core::WsHub hub(sim_core::SendOrder::Rotate, std::mt19937_64(1));
+    auto id = hub.add(server);
+    hub.activate(id);
+
+    bool session_ended = false;
+    asio::co_spawn(ioc, [&]() -> asio::awaitable<void> {
+        std::array<char, 64> scratch;
+        try {
+            while (true) co_await server->async_read_some(asio::buffer(scratch), asio::use_awaitable);
+        } catch (const std::exception&) {
+        }
+        session_ended = true;
+    }, asio::detached);
+
+    // a masked text frame the client has sent only the first bytes of
+    std::string payload = "split frame";
+    std::string frame = {'\x81', static_cast<char>(0x80 | payload.size()), 1, 2, 3, 4};
+    for (size_t i = 0; i < payload.size(); ++i) frame += static_cast<char>(payload[i] ^ frame[2 + i % 4]);
+    asio::write(client.next_layer(), asio::buffer(frame.data(), 5));
+    while (server->next_layer().unread()->size() < 5) ioc.run_one();
+
+    hub.freeze_for_handoff();
+    hub.stop_reads();
+    while (!hub.reads_stopped() || !session_ended) ioc.run_one();
+
+    auto clients = hub.handoff_clients();
+    ASSERT_EQ(clients.size(), 1u);
+    EXPECT_EQ(clients[0].unread, frame.substr(0, 5));
+
+    asio::write(client.next_layer(), asio::buffer(frame.data() + 5, frame.size() - 5));
+    auto adopted = sim_core::adopt_websocket(ioc, clients[0].fd, clients[0].unread);
+    boost::beast::flat_buffer buffer;
+    adopted->read(buffer);
+    EXPECT_EQ(boost::beast::buffers_to_string(buffer.data()), payload);
+
+    client.write(asio::buffer(std::string("next")));
+    buffer.clear();
+    adopted->read(buffer);
+    EXPECT_EQ(boost::beast::buffers_to_string(buffer.data()), "next");
+    EXPECT_EQ(adopted->next_layer().unread(), std::string());
+
+    // a frame too large to carry keeps its client from being handed over
+    sim_core::TrackedSocket socket(ioc);
+    socket.track_frames(std::string{'\x82', '\xfe', '\x10', '\x00', 1, 2, 3, 4});
+    EXPECT_FALSE(socket.unread().has_value());
+
+    hub.abort_handoff();
+}
+
+TEST(HandoffTest, AdoptedWebsocketContinuesStream) {
+    namespace asio = boost::asio;
+    namespace websocket = boost::beast::websocket;
+    using tcp = asio::ip::tcp;
+
+    asio::io_context ioc;
+    tcp::acceptor acceptor(ioc, tcp::endpoint(asio::ip::make_address("127.0.0.1"), 0));
+    auto endpoint = acceptor.local_endpoint();
+
+    websocket::stream<tcp::socket> client(ioc);
+    std::thread handshake([&] {
+        client.next_layer().connect(endpoint);
+        client.handshake("127.0.0.1", "/ws/ticks");
+    });
+
+    // original server side: accept, upgrade, then hand the fd over
+    int fd;
+    {
+        sim_core::WsHub::Stream server(acceptor.accept());
+        server.accept();
+        handshake.join();
+        server.write(asio::buffer(std::string("before")));
+        fd = ::dup(server.next_layer().native_handle());
+    }
+
+    auto adopted = sim_core::adopt_websocket(ioc, fd);
+    adopted->write(asio::buffer(std::string("after")));
+
+    boost::beast::flat_buffer buffer;
+    client.read(buffer);
+    EXPECT_EQ(boost::beast::buffers_to_string(buffer.data()), "before");
+    buffer.clear();
+    client.read(buffer);
+    EXPECT_EQ(boost::beast::buffers_to_string(buffer.data()), "after");
+}
+
+// Test: Timer wheel fires every timer exactly on its deadline
+TEST(TimerWheelTest, MatchesBruteForce) {
+    sim_core::TimerWheel<uint32_t> wheel(1000);
+    std::vector<uint64_t> deadlines;
+    std::mt19937_64 rng(7);
+
+    // Spread delays over all levels, including wrap-around of the low slots
+    for (uint32_t i = 0; i < 2000; ++i) {
+        uint64_t delay = 1 + rng() % (uint64_t{1} << (6 * (1 + i % 3)));
+        deadlines.push_back(1000 + delay);
+        wheel.schedule(1000 + delay, i);
+    }
+    EXPECT_EQ(wheel.size(), 2000u);
+
+    std::vector<bool> fired(deadlines.size(), false);
+    uint64_t now = 1000;
+    while (!wheel.empty()) {
+        now += 1 + rng() % 50;
+        wheel.advance(now, [&](uint32_t i) {
+            EXPECT_FALSE(fired[i]);
+            EXPECT_EQ(deadlines[i], wheel.now());
+            fired[i] = true;
+            // Re-arming from inside fire lands on a later tick
+            if (i % 10 == 0) {
+                deadlines.push_back(wheel.now() + 70);
+                fired.push_back(false);
+                wheel.schedule(wheel.now() + 70, static_cast<uint32_t>(deadlines.size() - 1));
+            }
+        });
+    }
+    for (size_t i = 0; i < fired.size(); ++i) {
+        EXPECT_TRUE(fired[i]) << i;
+    }
+
+    // Past deadlines fire on the next tick
+    wheel.schedule(now - 5, 99);
+    uint32_t late = 0;
+    wheel.advance(now + 1, [&](uint32_t i) { late = i; });
+    EXPECT_EQ(late, 99u);
+}
+
+// Test: Token bucket enforces rate and burst with lazy refill
+TEST(TokenBucketTest, RateAndBurst) {
+    constexpr int64_t kMs = 1000000;
+    sim_core::TokenBucket bucket({1000, 300}, 0);
+
+    // Burst is available up front, then sends wait for refill
+    EXPECT_TRUE(bucket.try_consume(200, 0));
+    EXPECT_TRUE(bucket.try_consume(100, 0));
+    EXPECT_FALSE(bucket.try_consume(100, 0));
+    EXPECT_EQ(bucket.wait_ns(100) / kMs, 100);
+    EXPECT_FALSE(bucket.try_consume(100, 99 * kMs));
+    EXPECT_TRUE(bucket.try_consume(100, 100 * kMs));
+
+    // Refill is capped at the burst
+    EXPECT_TRUE(bucket.try_consume(300, 10000 * kMs));
+    EXPECT_FALSE(bucket.try_consume(1, 10000 * kMs));
+
+    // A frame above the burst passes when full and leaves the bucket in debt
+    EXPECT_TRUE(bucket.try_consume(800, 10300 * kMs));
+    EXPECT_FALSE(bucket.try_consume(100, 10700 * kMs));
+    EXPECT_TRUE(bucket.try_consume(100, 10900 * kMs));
+
+    // Sustained throughput matches the rate
+    sim_core::TokenBucket steady({5000, 0}, 0);
+    uint64_t sent = 0;
+    for (int64_t t = 0; t <= 10000 * kMs; t += kMs) {
+        while (steady.try_consume(100, t)) sent += 100;
+    }
+    EXPECT_NEAR(static_cast<double>(sent), 5000.0 + 50000.0, 200.0);
+
+    EXPECT_TRUE(sim_core::TokenBucket().try_consume(1 << 20, 0));
+
+    auto limit = sim_core::parse_bandwidth_limit("/ws/ticks?tier=normal&rate=4096", {100, 50});
+    EXPECT_EQ(limit.bytes_per_sec, 4096u);
+    EXPECT_EQ(limit.burst_bytes, 50u);
+    EXPECT_EQ(limit.burst(), 50u);
+    EXPECT_EQ((sim_core::BandwidthLimit{4096, 0}.burst()), 4096u);
+}
+
+// Test: Requested limits are clamped to the configured maximum and junk is refused
+TEST(TokenBucketTest, ParseClampsAndRejects) {
+    sim_core::BandwidthLimit max{1000, 500};
+    auto limit = sim_core::parse_bandwidth_limit("/ws?rate=999999&burst=999999", {}, max);
+    EXPECT_EQ(limit.bytes_per_sec, 1000u);
+    EXPECT_EQ(limit.burst_bytes, 500u);
+
+    // Unlimited is the max once one is set; one second of a lower rate fits
+    limit = sim_core::parse_bandwidth_limit("/ws?rate=0", {}, max);
+    EXPECT_EQ(limit.bytes_per_sec, 1000u);
+    EXPECT_EQ(limit.burst(), 500u);
+    limit = sim_core::parse_bandwidth_limit("/ws?rate=200", {}, max);
+    EXPECT_EQ(limit.burst(), 200u);
+    EXPECT_TRUE(sim_core::parse_bandwidth_limit("/ws?rate=0", {}).unlimited());
+
+    for (const char* target : {"/ws?rate=-1", "/ws?rate=abc", "/ws?rate=12k", "/ws?rate=",
+                               "/ws?burst=+5", "/ws?rate=99999999999999999999"}) {
+        EXPECT_THROW(sim_core::parse_bandwidth_limit(target, {}, max), std::invalid_argument) << target;
+    }
+}
+
+// Test: A throttled subscriber's queue is capped and stays out of the global backlog
+TEST(TokenBucketTest, ThrottledClientKeepsOwnBacklog) {
+    namespace asio = boost::asio;
+    namespace websocket = boost::beast::websocket;
+    using tcp = asio::ip::tcp;
+
+    asio::io_context ioc;
+    tcp::acceptor acceptor(ioc, tcp::endpoint(asio::ip::make_address("127.0.0.1"), 0));
+    websocket::stream<tcp::socket> client(ioc);
+    std::thread handshake([&] {
+        client.next_layer().connect(acceptor.local_endpoint());
+        client.handshake("127.0.0.1", "/ws/ticks");
+    });
+    auto server = std::make_shared<sim_core::WsHub::Stream>(acceptor.accept());
+    server->accept();
+    handshake.join();
+
+    sim_core::WsHub hub(sim_core::SendOrder::Rotate, std::mt19937_64(1), 64, 8);
+    auto id = hub.add(server, sim_core::Tier::Critical, {1, 1});
+    hub.activate(id);
+
+    uint64_t conflated = sim_core::get_metrics().ws_frames_conflated.load();
+    for (int i = 0; i < 1000; ++i) {
+        hub.broadcast("SYN" + std::to_string(i) + "/USD", std::string(32, 'x'));
+    }
+
+    // One frame went out on the full bucket, the rest wait in a capped queue
+    EXPECT_EQ(hub.backlog(), 0u);
+    EXPECT_FALSE(hub.drained());
+    EXPECT_NE(hub.to_prometheus().find("ws_send_backlog_throttled " +
+                                       std::to_string(sim_core::WsHub::kThrottledQueueFrames) + "\n"),
+              std::string::npos);
+    EXPECT_EQ(sim_core::get_metrics().ws_frames_conflated.load() - conflated,
+              999u - sim_core::WsHub::kThrottledQueueFrames);
+
+    // Frames for a queued pair conflate even on the critical tier
+    hub.broadcast("SYN998/USD", std::string(32, 'y'));
+    hub.broadcast("SYN999/USD", std::string(32, 'y'));
+    hub.broadcast("SYN998/USD", std::string(32, 'z'));
+    EXPECT_EQ(sim_core::get_metrics().ws_frames_conflated.load() - conflated,
+              1002u - sim_core::WsHub::kThrottledQueueFrames);
+
+    hub.remove(id);
+    ioc.poll();
+    EXPECT_NE(hub.to_prometheus().find("ws_send_backlog_throttled 0\n"), std::string::npos);
+}
+
+// Test: Gilbert-Elliott drops cluster into bursts with the configured mean length
+TEST(FaultPipelineTest, GilbertElliottBurstLoss) {
+    sim_core::GilbertElliottDrop drop{0.0, {0.05, 0.25, 1.0}};
+    std::mt19937_64 rng(11);
+
+    constexpr int kTicks = 200000;
+    int dropped = 0;
+    int bursts = 0;
+    bool prev = false;
+    for (int i = 0; i < kTicks; ++i) {
+        bool d = drop.sample(rng, 0);
+        dropped += d;
+        bursts += d && !prev;
+        prev = d;
+    }
+
+    // pi = 0.05 / 0.30, mean burst 1 / 0.25 ticks
+    EXPECT_NEAR(static_cast<double>(dropped) / kTicks, 0.05 / 0.30, 0.01);
+    EXPECT_NEAR(static_cast<double>(dropped) / bursts, 4.0, 0.2);
+
+    // Streams keep independent state
+    sim_core::GilbertElliottDrop stuck{0.0, {1.0, 0.0, 1.0}};
+    EXPECT_TRUE(stuck.sample(rng, 3));
+    EXPECT_TRUE(stuck.sample(rng, 3));
+    EXPECT_EQ(stuck.in_bad.size(), 4u);
+    EXPECT_EQ(stuck.in_bad[0], 0);
+
+    // Selected by config
+    sim_core::FaultConfig config{{0, 0}, {0, 0}, 0.01, 0.0, 0.0, 0, sim_core::BurstLossConfig{0.01, 0.25, 0.5}};
+    sim_core::dispatch_fault_pipeline(config, std::mt19937_64(1), [](auto faults) {
+        using Expected = sim_core::FaultPipeline<sim_core::NoDelay, sim_core::GilbertElliottDrop, sim_core::NoDup,
+            sim_core::NoReorder, sim_core::NoStaleness>;
+        EXPECT_TRUE((std::is_same_v<decltype(faults), Expected>));
+    });
+}
+
+// Test: Alias tables and tail latency models match their distributions
+TEST(LatencyModelTest, AliasTableAndTails) {
+    std::mt19937_64 rng(5);
+
+    sim_core::AliasTable table({1.0, 0.0, 3.0, 6.0});
+    std::array<int, 4> counts{};
+    constexpr int kDraws = 100000;
+    for (int i = 0; i < kDraws; ++i) counts[table.sample(rng)]++;
+    EXPECT_NEAR(counts[0] / double(kDraws), 0.1, 0.01);
+    EXPECT_EQ(counts[1], 0);
+    EXPECT_NEAR(counts[2] / double(kDraws), 0.3, 0.01);
+    EXPECT_NEAR(counts[3] / double(kDraws), 0.6, 0.01);
+    EXPECT_THROW(sim_core::AliasTable({0.0, 0.0}), std::runtime_error);
+
+    auto quantile = [&rng](const sim_core::LatencyDistribution& dist, double q) {
+        std::vector<uint32_t> samples(200000);
+        for (auto& x : samples) x = dist.sample(rng);
+        std::sort(samples.begin(), samples.end());
+        return static_cast<double>(samples[static_cast<size_t>(q * (samples.size() - 1))]);
+    };
+
+    sim_core::LatencyDistribution lognormal{sim_core::LogNormalLatency{20.0, 0.6}, 1e6};
+    EXPECT_NEAR(quantile(lognormal, 0.5), 20.0, 1.0);
+    EXPECT_NEAR(quantile(lognormal, 0.999), 20.0 * std::exp(3.09 * 0.6), 15.0);
+
+    sim_core::LatencyDistribution pareto{sim_core::ParetoLatency{10.0, 2.0}, 1e6};
+    EXPECT_NEAR(quantile(pareto, 0.999), 10.0 * std::sqrt(1000.0), 30.0);
+    sim_core::LatencyDistribution capped{sim_core::ParetoLatency{10.0, 0.5}, 250.0};
+    EXPECT_EQ(quantile(capped, 1.0), 250.0);
+
+    // Empirical histogram from a file
+    auto path = std::string(::testing::TempDir()) + "latency_hist.txt";
+    {
+        std::ofstream out(path);
+        out << "# upper weight\n10 1\n\n20 0 # empty bin\n100 1\n";
+    }
+    auto empirical = sim_core::load_latency_histogram(path);
+    EXPECT_EQ(empirical.bins(), 3u);
+    int low = 0;
+    for (int i = 0; i < 10000; ++i) {
+        double ms = empirical.sample(rng);
+        ASSERT_TRUE(ms <= 10.0 || (ms >= 20.0 && ms <= 100.0)) << ms;
+        low += ms <= 10.0;
+    }
+    EXPECT_NEAR(low / 10000.0, 0.5, 0.03);
+
+    sim_core::FaultConfig config{{8, 45}, {0, 0}, 0.0, 0.0, 0.0, 0};
+    config.latency_model = lognormal;
+    sim_core::dispatch_fault_pipeline(config, std::mt19937_64(1), [](auto faults) {
+        using Expected = sim_core::FaultPipeline<sim_core::ModeledDelay, sim_core::NoDrop, sim_core::NoDup,
+            sim_core::NoReorder, sim_core::NoStaleness>;
+        EXPECT_TRUE((std::is_same_v<decltype(faults), Expected>));
+    });
+}
+
+// Test: Fast clock tracks steady_clock and system_clock and never goes back
+TEST(ClockTest, TracksSystemClocks) {
+    auto& clock = sim_core::fast_clock();
+
+    auto steady = std::chrono::steady_clock::now();
+    auto fast = sim_core::steady_now();
+    EXPECT_LT(std::abs(std::chrono::duration<double, std::milli>(fast - steady).count()), 1.0);
+
+    auto wall_ms = static_cast<int64_t>(sim_core::current_time_ms());
+    auto system_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    EXPECT_LE(std::abs(wall_ms - system_ms), 2);
+
+    int64_t prev = clock.monotonic_ns();
+    for (int i = 0; i < 100000; ++i) {
+        int64_t now = clock.monotonic_ns();
+        ASSERT_GE(now, prev);
+        prev = now;
+    }
+
+    // Still aligned after a sleep
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    steady = std::chrono::steady_clock::now();
+    fast = sim_core::steady_now();
+    EXPECT_LT(std::abs(std::chrono::duration<double, std::milli>(fast - steady).count()), 1.0);
+}
+
+// Test: A TSC step is re-anchored at the next calibration instead of slewed
+TEST(ClockTest, ReanchorsAfterStep) {
+    sim_core::TscClock clock;
+    if (!clock.uses_tsc()) GTEST_SKIP() << "no invariant TSC";
+
+    auto error_ms = [&clock] {
+        int64_t fast = clock.monotonic_ns();
+        int64_t steady = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        return static_cast<double>(fast - steady) / 1e6;
+    };
+
+    for (int64_t step_ms : {250, -250}) {
+        clock.simulate_step(step_ms * 1'000'000);
+        EXPECT_NEAR(error_ms(), static_cast<double>(step_ms), 1.0);
+
+        // Slewing at 1000ppm would leave nearly all of it after one interval
+        std::this_thread::sleep_for(std::chrono::milliseconds(120));
+        clock.monotonic_ns();
+        EXPECT_LT(std::abs(error_ms()), 1.0) << step_ms;
+    }
+}
+
+// Test: Sobol points stratify every dimension and the first pair jointly
+TEST(PathGeneratorTest, SobolStratifies) {
+    EXPECT_NEAR(sim_core::inverse_normal_cdf(0.975), 1.959963984540054, 1e-12);
+    EXPECT_NEAR(sim_core::inverse_normal_cdf(1e-10), -6.361340902404056, 1e-9);
+    EXPECT_NEAR(sim_core::inverse_normal_cdf(0.5), 0.0, 1e-15);
+
+    std::mt19937_64 rng(3);
+    constexpr size_t kDims = 64;
+    sim_core::SobolSequence sobol(kDims, rng);
+    std::vector<std::vector<int>> bins(kDims, std::vector<int>(1024, 0));
+    std::vector<int> grid(32 * 32, 0);
+    std::vector<double> point(kDims);
+    for (int i = 0; i < 1024; ++i) {
+        sobol.next(point);
+        for (size_t d = 0; d < kDims; ++d) {
+            ASSERT_GT(point[d], 0.0);
+            ASSERT_LT(point[d], 1.0);
+            bins[d][static_cast<size_t>(point[d] * 1024)]++;
+        }
+        grid[static_cast<size_t>(point[0] * 32) * 32 + static_cast<size_t>(point[1] * 32)]++;
+    }
+    for (size_t d = 0; d < kDims; ++d) {
+        EXPECT_EQ(*std::min_element(bins[d].begin(), bins[d].end()), 1) << d;
+        EXPECT_EQ(*std::max_element(bins[d].begin(), bins[d].end()), 1) << d;
+    }
+    EXPECT_EQ(*std::max_element(grid.begin(), grid.end()), 1);
+
+    EXPECT_THROW(sim_core::SobolSequence(sim_core::SobolSequence::kMaxDims + 1, rng), std::runtime_error);
+}
+
+// Test: Sobol and antithetic sampling price a GBM call with less error
+TEST(PathGeneratorTest, VarianceReductionOnGbmCall) {
+    constexpr size_t kSteps = 32;
+    constexpr size_t kPaths = 4096;
+    constexpr double kSigma = 0.8;
+    constexpr double kStrike = 105.0;
+    const uint64_t tick_ms = 86400000;  // one day per step
+
+    // log S_T ~ N(log S0, sigma^2 T) for the engine's zero-drift step
+    double t = kSteps / 365.25;
+    double sd = kSigma * std::sqrt(t);
+    double d2 = std::log(100.0 / kStrike) / sd;
+    auto phi = [](double x) { return 0.5 * std::erfc(-x / std::sqrt(2.0)); };
+    double exact = 100.0 * std::exp(sd * sd / 2) * phi(d2 + sd) - kStrike * phi(d2);
+
+    auto rmse = [&](sim_core::PathSampling mode) {
+        double sq = 0.0;
+        for (uint64_t seed = 0; seed < 8; ++seed) {
+            sim_core::PathGenerator paths(kSteps, mode, std::mt19937_64(seed));
+            double sum = 0.0;
+            sim_core::simulate_paths(kPaths, paths,
+                [&](size_t) -> sim_core::EngineVariant {
+                    return sim_core::GbmPriceEngine("ETH/USD", 100.0, 0.0, kSigma, tick_ms, std::mt19937_64(0));
+                },
+                [&](size_t, std::span<const int64_t> prices) {
+                    sum += std::max(sim_core::Price{prices.back(), sim_core::kDefaultPriceDecimals}.to_double() - kStrike, 0.0);
+                });
+            double err = sum / kPaths - exact;
+            sq += err * err;
+        }
+        return std::sqrt(sq / 8);
+    };
+
+    double pseudo = rmse(sim_core::PathSampling::Pseudo);
+    double antithetic = rmse(sim_core::PathSampling::Antithetic);
+    double sobol = rmse(sim_core::PathSampling::Sobol);
+
+    EXPECT_LT(pseudo, 1.0);
+    EXPECT_LT(antithetic, pseudo);
+    EXPECT_LT(sobol * 10, pseudo);
+}
+
+TEST(ImportanceSamplingTest, CrashProbabilities) {
+    constexpr size_t kSteps = 60;
+    constexpr size_t kPaths = 4000;
+    const uint64_t tick_ms = 60000;  // one hour of minute ticks
+    auto phi = [](double x) { return 0.5 * std::erfc(-x / std::sqrt(2.0)); };
+    int64_t crash = sim_core::Price::from_double(70.0, sim_core::kDefaultPriceDecimals).raw;
+
+    auto estimate = [&](auto make) {
+        sim_core::PathGenerator paths(kSteps, sim_core::PathSampling::Pseudo, std::mt19937_64(3));
+        double sum = 0.0;
+        size_t hits = 0;
+        sim_core::simulate_paths(kPaths, paths, make,
+            [&](size_t, std::span<const int64_t> prices, double weight) {
+                if (prices.back() <= crash) {
+                    sum += weight;
+                    hits++;
+                }
+            });
+        EXPECT_GT(hits, kPaths / 10);
+        return sum / kPaths;
+    };
+
+    // Diffusion only: a 30% hourly drop is a 6.7 sigma event (~1e-11)
+    constexpr double kSigma = 5.0;
+    sim_core::CrashTilt tilt{0.3, 3'600'000, 1.0, 0.0};
+    double sd = kSigma * std::sqrt(1.0 / 8766.0);
+    double exact = phi(std::log(0.7) / sd);
+    double tilted = estimate([&](size_t p) -> sim_core::EngineVariant {
+        return sim_core::GbmPriceEngine("ETH/USD", 100.0, 0.0, kSigma, tick_ms, std::mt19937_64(p),
+                                        sim_core::kDefaultPriceDecimals, 0.0, 0.0, 0.0, tilt);
+    });
+    EXPECT_NEAR(tilted / exact, 1.0, 0.15);
+
+    // Jumps only: one -50% jump crashes the path, at 0.01 jumps per hour
+    sim_core::CrashTilt jump_tilt{0.0, 3'600'000, 50.0, 0.0};
+    double p_jump = 1.0 - std::exp(-0.01 / 60.0);
+    double exact_jump = 1.0 - std::pow(1.0 - p_jump, static_cast<double>(kSteps));
+    double tilted_jump = estimate([&](size_t p) -> sim_core::EngineVariant {
+        return sim_core::GbmPriceEngine("ETH/USD", 100.0, 0.0, 0.01, tick_ms, std::mt19937_64(p),
+                                        sim_core::kDefaultPriceDecimals, 0.01, -0.7, 0.01, jump_tilt);
+    });
+    EXPECT_NEAR(tilted_jump / exact_jump, 1.0, 0.1);
+
+    // Live ticks carry the running log weight only while tilted
+    sim_core::GbmPriceEngine plain("ETH/USD", 100.0, 0.0, kSigma, tick_ms, std::mt19937_64(1));
+    EXPECT_FALSE(plain.next_tick(0, 0, sim_core::SourceKind::Dex, 0, false).log_weight.has_value());
+    EXPECT_EQ(nlohmann::json(plain.next_tick(0, 1, sim_core::SourceKind::Dex, 0, false)).count("log_weight"), 0u);
+
+    sim_core::OuPriceEngine ou("USDC/USD", 1.0, 1.0, 8766.0, 0.05, 0.0, 0.0, 0.0, tick_ms,
+                               std::mt19937_64(1), sim_core::kDefaultPriceDecimals, tilt);
+    auto msg = ou.next_tick(0, 0, sim_core::SourceKind::Dex, 0, false);
+    ASSERT_TRUE(msg.log_weight.has_value());
+    EXPECT_NE(*msg.log_weight, 0.0);
+    auto parsed = nlohmann::json(msg).get<sim_core::PriceMsg>();
+    EXPECT_DOUBLE_EQ(*parsed.log_weight, *msg.log_weight);
+}
+
+TEST(ImportanceSamplingTest, LivePathsRestartAtHorizon) {
+    const uint64_t tick_ms = 60000;
+    sim_core::CrashTilt tilt{0.3, 3'600'000, 1.0, 0.0};
+    EXPECT_EQ(sim_core::live_path_steps(tilt, tick_ms), 60u);
+    EXPECT_EQ(sim_core::live_path_steps(sim_core::CrashTilt{}, tick_ms), 0u);
+
+    auto make = [&] {
+        return sim_core::GbmPriceEngine("ETH/USD", 100.0, 0.0, 5.0, tick_ms, std::mt19937_64(9),
+                                        sim_core::kDefaultPriceDecimals, 0.0, 0.0, 0.0, tilt);
+    };
+    auto endless = make();
+    auto live = make();
+    live.split_paths(60);
+
+    // The first path matches an unsplit engine and ends with its final weight
+    sim_core::PriceMsg msg{};
+    for (uint64_t i = 0; i < 60; ++i) {
+        auto expected = endless.next_tick(0, i, sim_core::SourceKind::Dex, 0, false);
+        msg = live.next_tick(0, i, sim_core::SourceKind::Dex, 0, false);
+        ASSERT_EQ(msg.price.raw, expected.price.raw);
+        EXPECT_EQ(msg.log_weight, expected.log_weight);
+        EXPECT_EQ(msg.path, 0u);
+        EXPECT_EQ(msg.path_end, i == 59);
+    }
+    EXPECT_GT(std::abs(*msg.log_weight), 5.0);
+    auto json = nlohmann::json(msg);
+    EXPECT_EQ(json["path"], 0u);
+    EXPECT_TRUE(json["path_end"].get<bool>());
+    auto parsed = json.get<sim_core::PriceMsg>();
+    EXPECT_EQ(parsed.path, 0u);
+    EXPECT_TRUE(parsed.path_end);
+
+    // Then it restarts from the initial price with a fresh weight, so a
+    // tilt of -30% per hour never drives the live price to the floor
+    msg = live.next_tick(0, 60, sim_core::SourceKind::Dex, 0, false);
+    EXPECT_EQ(msg.path, 1u);
+    EXPECT_FALSE(msg.path_end);
+    EXPECT_NEAR(msg.price.to_double(), 100.0, 10.0);
+    EXPECT_LT(std::abs(*msg.log_weight), 5.0);
+    double low = 100.0;
+    for (uint64_t i = 61; i < 6000; ++i) {
+        low = std::min(low, live.next_tick(0, i, sim_core::SourceKind::Dex, 0, false).price.to_double());
+    }
+    EXPECT_GT(low, 20.0);
+    EXPECT_EQ(live.path(), 99u);
+
+    // The oracle always publishes a path's last step
+    sim_core::OracleFeedSet feeds({1000, 1000}, 2000, sim_core::create_labeled_rng(42, "TEST"));
+    sim_core::EngineVariant engine = sim_core::OuPriceEngine(
+        "USDC/USD", 1.0, 1.0, 8766.0, 0.05, 0.0, 0.0, 0.0, 1000, std::mt19937_64(1),
+        sim_core::kDefaultPriceDecimals, tilt);
+    sim_core::split_paths(engine, 5);
+    feeds.add_feed("USDC/USD", std::move(engine), 1'000'000, 1'000'000, 0);
+    std::vector<uint64_t> ends;
+    for (uint64_t now = 1000; now <= 20000; now += 1000) {
+        for (const auto& publish : feeds.poll(now)) {
+            if (publish.path_end) ends.push_back(*publish.path);
+        }
+    }
+    EXPECT_EQ(ends, (std::vector<uint64_t>{0, 1, 2, 3}));
+}
+
+TEST(SeedSearchTest, WorkStealingCoversEveryItemOnce) {
+    constexpr uint64_t kItems = 5000;
+    sim_core::WorkStealingRange range(100, 100 + kItems, 4);
+    std::vector<std::atomic<int>> seen(kItems);
+
+    std::vector<std::thread> workers;
+    for (size_t w = 0; w < 4; ++w) {
+        workers.emplace_back([&, w] {
+            while (auto item = range.next(w)) {
+                seen[*item - 100]++;
+                // Worker 0 is slow, so the others must steal its share
+                if (w == 0) std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    for (const auto& count : seen) {
+        EXPECT_EQ(count.load(), 1);
+    }
+}
+
+TEST(SeedSearchTest, ResultsIndependentOfThreads) {
+    try {
+        auto dex = sim_core::load_dex_config("configs/dex.yaml");
+        auto oracle = sim_core::load_oracle_config("configs/oracle.yaml");
+
+        sim_core::SeedSearchOptions options;
+        options.seeds = 12;
+        options.duration_ms = 60000;
+        options.top = 4;
+        options.objective = sim_core::SearchObjective::Drawdown;
+
+        options.threads = 1;
+        auto serial = sim_core::search_seeds(dex, oracle, options);
+        options.threads = 3;
+        auto parallel = sim_core::search_seeds(dex, oracle, options);
+
+        ASSERT_EQ(serial.size(), 4u);
+        ASSERT_EQ(parallel.size(), 4u);
+        for (size_t i = 0; i < serial.size(); ++i) {
+            EXPECT_EQ(serial[i].seed, parallel[i].seed);
+            EXPECT_EQ(serial[i].max_drawdown_pct, parallel[i].max_drawdown_pct);
+            EXPECT_GT(serial[i].dex_ticks, 0u);
+            if (i > 0) {
+                EXPECT_GE(serial[i - 1].max_drawdown_pct, serial[i].max_drawdown_pct);
+            }
+        }
+
+        auto again = sim_core::score_seed(dex, oracle, serial[0].seed, options.duration_ms);
+        EXPECT_EQ(again.max_drawdown_pct, serial[0].max_drawdown_pct);
+        EXPECT_EQ(again.oracle_updates, serial[0].oracle_updates);
+    } catch (const std::runtime_error& e) {
+        GTEST_SKIP() << "Config file not found: " << e.what();
+    }
+}
+
+TEST(TriggerSweepTest, MatchesShouldPublishPerParameterSet) {
+    sim_core::SweepPath path;
+    path.end_ms = 600000.0;
+    sim_core::GbmPriceEngine engine("ETH/USD", 3500.0, 0.0, 2.0, 250, std::mt19937_64(5));
+    for (double t = 0.0; t <= path.end_ms; t += 250.0) {
+        path.tick_ms.push_back(t);
+        path.price.push_back(t == 0.0 ? engine.current_price().raw : engine.step());
+    }
+    for (uint64_t t = 700; t <= 600000; t += 700) {
+        path.poll_ms.push_back(static_cast<double>(t));
+    }
+
+    auto grid = sim_core::trigger_grid({5, 25, 100}, {10000, 60000});
+    sim_core::TriggerSweep sweep(grid);
+    sweep.run(path);
+    auto stats = sweep.stats(sim_core::GasModel{50000, 10.0});
+    ASSERT_EQ(stats.size(), 6u);
+
+    for (size_t k = 0; k < grid.size(); ++k) {
+        std::optional<sim_core::Price> last;
+        uint64_t last_ms = 700;
+        uint64_t updates = 0;
+        double max_gap = 0.0;
+        size_t tick = 0;
+        auto gap = [&](int64_t dex) {
+            double g = std::abs(static_cast<double>(dex - last->raw)) * 10000.0 / static_cast<double>(dex);
+            max_gap = std::max(max_gap, g);
+        };
+
+        for (double poll_ms : path.poll_ms) {
+            auto now = static_cast<uint64_t>(poll_ms);
+            while (tick + 1 < path.price.size() && path.tick_ms[tick + 1] <= poll_ms) {
+                tick++;
+                if (last.has_value()) gap(path.price[tick]);
+            }
+            sim_core::Price current{path.price[tick], sim_core::kDefaultPriceDecimals};
+            if (sim_core::should_publish(current, last, grid[k].deviation_bps, now - last_ms,
+                                         grid[k].heartbeat_ms) != sim_core::PublishTrigger::None) {
+                last = current;
+                last_ms = now;
+                updates++;
+            }
+            gap(path.price[tick]);
+        }
+
+        EXPECT_EQ(stats[k].updates, updates) << k;
+        EXPECT_NEAR(stats[k].max_staleness_bps, max_gap, 1e-9) << k;
+        EXPECT_DOUBLE_EQ(stats[k].gas_eth, static_cast<double>(updates) * 50000 * 10.0 * 1e-9);
+        EXPECT_GT(stats[k].mean_staleness_bps, 0.0);
+        EXPECT_LE(stats[k].mean_staleness_bps, stats[k].max_staleness_bps);
+    }
+
+    // Tighter bands cost more updates and stay closer to the DEX
+    EXPECT_GT(stats[0].updates, stats[4].updates);
+    EXPECT_LT(stats[0].max_staleness_bps, stats[4].max_staleness_bps);
+}
+
+// Test: Deterministic math
+TEST(DetMathTest, MatchesLibm) {
+    auto ulps = [](double a, double b) {
+        auto ia = std::bit_cast<int64_t>(a);
+        auto ib = std::bit_cast<int64_t>(b);
+        return ia > ib ? ia - ib : ib - ia;
+    };
+    auto rng = sim_core::create_labeled_rng(7, "TEST");
+    for (int i = 0; i < 10000; ++i) {
+        double x = sim_core::sample_range_f64(rng, -700.0, 700.0);
+        EXPECT_LE(ulps(sim_core::det_exp(x), std::exp(x)), 1) << x;
+        double y = sim_core::det_exp(sim_core::sample_range_f64(rng, -700.0, 700.0));
+        EXPECT_LE(ulps(sim_core::det_log(y), std::log(y)), 1) << y;
+    }
+    EXPECT_EQ(sim_core::det_exp(0.0), 1.0);
+    EXPECT_EQ(sim_core::det_log(1.0), 0.0);
+    EXPECT_EQ(sim_core::det_exp(-1e6), 0.0);
+    EXPECT_TRUE(std::isinf(sim_core::det_exp(1e6)));
+    EXPECT_TRUE(std::isnan(sim_core::det_log(-1.0)));
+    EXPECT_DOUBLE_EQ(sim_core::det_log1p(1e-12), std::log1p(1e-12));
+
+    EXPECT_DOUBLE_EQ(sim_core::inverse_normal_cdf(0.975), 1.959963984540054);
+    EXPECT_EQ(sim_core::inverse_normal_cdf(0.5), 0.0);
+    for (double p : {0x1p-40, 0x1p-20, 0.0078125, 0.125, 0.4375}) {
+        EXPECT_EQ(sim_core::inverse_normal_cdf(p), -sim_core::inverse_normal_cdf(1.0 - p)) << p;
+    }
+}
+
+// Golden paths: these constants must not change between compilers, libms or
+// architectures. If a change to an engine moves them on purpose, regenerate
+// them; if they differ on one platform only, something is not deterministic.
+TEST(DetMathTest, GoldenPaths) {
+    auto path_hash = [](auto& engine) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (int i = 0; i < 1000; ++i) {
+            auto tick = engine.next_tick(i * 1000, i, sim_core::SourceKind::Dex, 0, false);
+            hash = (hash ^ static_cast<uint64_t>(tick.price.raw)) * 0x100000001b3ULL;
+        }
+        return hash;
+    };
+
+    EXPECT_EQ(sim_core::fnv1a64("DEX", 3), 0xe036701991be7b0eULL);
+    EXPECT_EQ(sim_core::create_labeled_rng(42, "TEST")(), 9101082171131615569ULL);
+
+    sim_core::GbmPriceEngine gbm("ETH/USD", 3500.0, 0.0, 2.0, 1000,
+                                 sim_core::create_labeled_rng(42, "TEST"));
+    EXPECT_EQ(path_hash(gbm), 0x8be002e903ecd930ULL);
+
+    sim_core::GbmPriceEngine jump("ETH/USD", 3500.0, 0.0, 2.0, 1000,
+                                  sim_core::create_labeled_rng(42, "TEST"), 8, 20.0, -0.05, 0.03);
+    EXPECT_EQ(path_hash(jump), 0x209cb65e013e9995ULL);
+
+    sim_core::OuPriceEngine ou("USDC/USD", 1.0, 1.0, 8766.0, 0.05, 10.0, -0.05, 0.02,
+                               1000, sim_core::create_labeled_rng(42, "TEST"));
+    EXPECT_EQ(path_hash(ou), 0xd088409ce71b6524ULL);
+}
+
+// Test: Run history and export
+TEST(HistoryTest, RingKeepsNewestRows) {
+    sim_core::HistoryLog<uint64_t> log(4);
+    for (uint64_t i = 0; i < 10; ++i) log.append(i);
+    EXPECT_EQ(log.begin(), 6u);
+    EXPECT_EQ(log.end(), 10u);
+
+    std::vector<uint64_t> rows;
+    EXPECT_EQ(log.read(0, 3, rows), 9u);  // starts at the oldest row held
+    EXPECT_EQ(rows, (std::vector<uint64_t>{6, 7, 8}));
+    EXPECT_EQ(log.read(9, 3, rows), 10u);
+    EXPECT_EQ(rows, (std::vector<uint64_t>{9}));
+
+    sim_core::HistoryLog<uint64_t> off(0);
+    off.append(1);
+    EXPECT_EQ(off.end(), 0u);
+}
+
+// Test: Feed counts beyond the record's 16-bit feed index are refused
+TEST(HistoryTest, FeedIndexFitsRecord) {
+    sim_core::OracleConfig oc;
+    oc.server.pairs = {"BTC/USD"};
+
+    YAML::Node config;
+    config["oracle_synthetic_feeds"] = sim_core::PriceRecord::kMaxFeeds - 1;
+    EXPECT_EQ(sim_core::load_oracle_feeds(config, oc).size(), sim_core::PriceRecord::kMaxFeeds);
+    config["oracle_synthetic_feeds"] = sim_core::PriceRecord::kMaxFeeds;
+    EXPECT_THROW(sim_core::load_oracle_feeds(config, oc), std::runtime_error);
+
+    std::vector<std::string> names(sim_core::PriceRecord::kMaxFeeds + 1, "X/USD");
+    EXPECT_THROW(sim_core::RunHistory(names, 16), std::invalid_argument);
+    EXPECT_THROW(sim_core::StreamDigest(names, 0), std::invalid_argument);
+}
+
+TEST(HistoryTest, FaultPipelineRecordsFaults) {
+    sim_core::get_metrics().reset();
+    sim_core::RunHistory history({"ETH/USD"}, 100000);
+    sim_core::FaultConfig chaos{{0, 0}, {0, 0}, 0.1, 0.1, 0.1, 0};
+
+    sim_core::dispatch_fault_pipeline(chaos, sim_core::create_labeled_rng(42, "TEST"), [&](auto faults) {
+        faults.set_history(&history);
+        for (uint64_t i = 0; i < 1000; ++i) {
+            faults.process(make_tick(i), i * 10, [&](const sim_core::PriceMsg& m) { history.record_tick(m, 0); });
+        }
+    });
+
+    std::vector<sim_core::FaultEvent> events;
+    history.faults.read(0, 100000, events);
+    std::array<uint64_t, 3> counts{};
+    for (const auto& event : events) counts[static_cast<size_t>(event.kind)]++;
+
+    auto& metrics = sim_core::get_metrics();
+    EXPECT_EQ(counts[0], metrics.ws_frames_dropped.load());
+    EXPECT_EQ(counts[1], metrics.ws_frames_duplicated.load());
+    EXPECT_EQ(counts[2], metrics.ws_frames_reordered.load());
+    EXPECT_EQ(history.ticks.end(), metrics.ws_frames_sent.load() + metrics.ws_frames_duplicated.load());
+    metrics.reset();
+}
+
+TEST(ExportTest, ArrowAndParquetFraming) {
+    sim_core::RunHistory history({"ETH/USD"}, 1000);
+    for (uint64_t i = 0; i < 250; ++i) {
+        history.record_tick(make_tick(i), 0);
+    }
+
+    auto u32 = [](const std::string& s, size_t at) {
+        uint32_t v = 0;
+        for (size_t i = 0; i < 4; ++i) v |= static_cast<uint32_t>(static_cast<uint8_t>(s[at + i])) << (8 * i);
+        return v;
+    };
+
+    // Arrow: continuation-framed messages with 8-byte aligned metadata (a
+    // schema, then batches of 100, 100 and 50 rows), then end-of-stream.
+    // Each column's buffers are padded to 8 bytes in the body.
+    std::ostringstream arrow;
+    EXPECT_EQ(sim_core::export_history(history, sim_core::HistoryTable::Ticks,
+                                       sim_core::ExportFormat::Arrow, arrow, 100), 250u);
+    std::string a = arrow.str();
+
+    auto pad = [](size_t n) { return (n + 7) / 8 * 8; };
+    auto body = [&pad](size_t rows) {
+        return pad(rows * 8)                                  // ts
+             + pad((rows + 1) * 4) + pad(rows * 7)            // pair "ETH/USD"
+             + pad((rows + 1) * 4) + pad(rows * 3)            // source "dex"
+             + 3 * pad(rows * 8)                              // src_seq, price, price_raw
+             + pad(rows) + pad(rows * 4) + pad((rows + 7) / 8);  // decimals, delay_ms, stale
+    };
+    std::vector<size_t> bodies{0, body(100), body(100), body(50)};
+
+    size_t at = 0;
+    for (size_t body_size : bodies) {
+        ASSERT_LE(at + 8, a.size());
+        EXPECT_EQ(u32(a, at), 0xffffffffu);
+        uint32_t metadata = u32(a, at + 4);
+        ASSERT_GT(metadata, 0u);
+        EXPECT_EQ(metadata % 8, 0u);
+        at += 8 + metadata + body_size;
+    }
+    ASSERT_EQ(at + 8, a.size());
+    EXPECT_EQ(u32(a, at), 0xffffffffu);
+    EXPECT_EQ(u32(a, at + 4), 0u);
+
+    std::ostringstream parquet;
+    sim_core::export_history(history, sim_core::HistoryTable::Ticks, sim_core::ExportFormat::Parquet, parquet, 100);
+    std::string p = parquet.str();
+    ASSERT_GT(p.size(), 12u);
+    EXPECT_EQ(p.substr(0, 4), "PAR1");
+    EXPECT_EQ(p.substr(p.size() - 4), "PAR1");
+    EXPECT_LT(u32(p, p.size() - 8), p.size());
+
+    auto request = sim_core::parse_export_target("/export/rounds.parquet");
+    ASSERT_TRUE(request.has_value());
+    EXPECT_EQ(request->table, sim_core::HistoryTable::Rounds);
+    EXPECT_EQ(request->format, sim_core::ExportFormat::Parquet);
+    EXPECT_FALSE(sim_core::parse_export_target("/export/ticks.csv").has_value());
+}
+
+TEST(HistoryStreamTest, RowsAndCandlesInBoundedChunks) {
+    sim_core::RunHistory history({"ETH/USD", "BTC/USD"}, 100000);
+    for (uint64_t i = 0; i < 20000; ++i) {
+        auto tick = make_tick(i);
+        tick.ts = 1000 * i;  // one tick a second
+        tick.price = sim_core::Price::from_double(3500.0 + static_cast<double>(i % 60));
+        history.record_tick(tick, static_cast<uint32_t>(i % 2));
+        if (i == 5) history.record_tick(tick, 1);  // a duplicated frame
+    }
+
+    auto drain = [](sim_core::ChunkSource& source, size_t& max_chunk) {
+        std::string chunk;
+        std::string all;
+        max_chunk = 0;
+        while (source.next(chunk)) {
+            max_chunk = std::max(max_chunk, chunk.size());
+            all += chunk;
+        }
+        return all;
+    };
+    size_t max_chunk = 0;
+
+    auto ticks = sim_core::open_history_stream("/history/ticks?pair=BTC/USD&from_ms=1000&to_ms=9000", history);
+    ASSERT_TRUE(ticks);
+    std::istringstream lines(drain(*ticks, max_chunk));
+    std::string line;
+    std::vector<uint64_t> seqs;
+    while (std::getline(lines, line)) {
+        auto j = nlohmann::json::parse(line);
+        EXPECT_EQ(j["pair"], "BTC/USD");
+        seqs.push_back(j["src_seq"].get<uint64_t>());
+    }
+    EXPECT_EQ(seqs, (std::vector<uint64_t>{1, 3, 5, 5, 7}));
+
+    // Clients usually escape the slash in a pair
+    auto encoded = sim_core::open_history_stream("/history/ticks?pair=BTC%2FUSD&from_ms=1000&to_ms=9000", history);
+    ASSERT_TRUE(encoded);
+    std::string encoded_rows = drain(*encoded, max_chunk);
+    EXPECT_EQ(std::count(encoded_rows.begin(), encoded_rows.end(), '\n'), 5);
+
+    auto binary = sim_core::open_history_stream("/history/ticks?format=binary", history);
+    std::string bytes = drain(*binary, max_chunk);
+    ASSERT_EQ(bytes.size(), 20001 * sim_core::PriceRecord::kEncodedSize);
+    EXPECT_LE(max_chunk, 300u * 1024);
+    EXPECT_EQ(sim_core::decode_record(reinterpret_cast<const uint8_t*>(bytes.data()) + 32).src_seq, 1u);
+
+    // 60 ticks per minute split across two pairs; the duplicate counts once
+    auto candles = sim_core::open_history_stream("/candles?interval_ms=60000&format=csv&pair=ETH/USD", history);
+    std::istringstream rows(drain(*candles, max_chunk));
+    std::getline(rows, line);
+    EXPECT_EQ(line, "start_ms,pair,open,high,low,close,ticks");
+    std::getline(rows, line);
+    EXPECT_EQ(line, "0,ETH/USD,3500,3558,3500,3558,30");
+    size_t count = 1;
+    while (std::getline(rows, line)) count++;
+    EXPECT_EQ(count, 334u);  // 20000 s in whole and partial minutes
+
+    auto export_stream = sim_core::open_history_stream("/export/ticks.parquet", history);
+    std::ostringstream whole;
+    sim_core::export_history(history, sim_core::HistoryTable::Ticks, sim_core::ExportFormat::Parquet, whole, 16384);
+    EXPECT_EQ(drain(*export_stream, max_chunk), whole.str());
+
+    EXPECT_EQ(sim_core::open_history_stream("/prices/snapshot", history), nullptr);
+    EXPECT_THROW(sim_core::open_history_stream("/history/ticks?format=xml", history), std::invalid_argument);
+    EXPECT_THROW(sim_core::open_history_stream("/history/rounds?format=binary", history), std::invalid_argument);
+    EXPECT_THROW(sim_core::open_history_stream("/candles?pair=DOGE/USD", history), std::invalid_argument);
+}
+
+// Test: Stream digest
+TEST(DigestTest, Xxh64MatchesReference) {
+    auto hash = [](const std::string& s) { return sim_core::Xxh64::hash(s.data(), s.size()); };
+    EXPECT_EQ(hash(""), 0xef46db3751d8e999ULL);
+    EXPECT_EQ(hash("a"), 0xd24ec4f1a98c6e5bULL);
+    EXPECT_EQ(hash("abc"), 0x44bc2cf5ad770999ULL);
+    EXPECT_EQ(hash("Nobody inspects the spammish repetition"), 0xfbcea83c8a378bf1ULL);
+    EXPECT_EQ(sim_core::digest_hex(0xfbcea83c8a378bf1ULL), "fbcea83c8a378bf1");
+
+    // Streaming in uneven pieces gives the one-shot digest
+    std::string data;
+    for (int i = 0; i < 1000; ++i) data.push_back(static_cast<char>(i * 7));
+    sim_core::Xxh64 streamed;
+    for (size_t at = 0, piece = 1; at < data.size(); at += piece, piece = piece * 3 % 41 + 1) {
+        streamed.update(data.data() + at, std::min(piece, data.size() - at));
+    }
+    EXPECT_EQ(streamed.digest(), hash(data));
+}
+
+TEST(DigestTest, FeedDigestCoversTickContent) {
+    sim_core::StreamDigest a({"ETH/USD", "BTC/USD"}, 100, 5);
+    sim_core::StreamDigest b({"ETH/USD", "BTC/USD"}, 100, 5);
+
+    // Same as XXH64 over the binary tick records with ts zeroed
+    std::string bytes;
+    for (uint64_t i = 0; i < 1000; ++i) {
+        auto tick = make_tick(i);
+        tick.price = sim_core::Price::from_double(3500.0 + static_cast<double>(i % 17));
+        a.record(tick, 0);
+        tick.ts += 12345;  // wall clock differs between runs
+        b.record(tick, 0);
+
+        auto record = sim_core::to_record(tick, 0);
+        record.ts = 0;
+        uint8_t encoded[sim_core::PriceRecord::kEncodedSize];
+        sim_core::encode_record(record, encoded);
+        bytes.append(reinterpret_cast<const char*>(encoded), sizeof encoded);
+    }
+
+    auto value = a.value(0);
+    EXPECT_EQ(value.ticks, 1000u);
+    EXPECT_EQ(value.last_seq, 999u);
+    EXPECT_EQ(value.digest, sim_core::Xxh64::hash(bytes.data(), bytes.size()));
+    EXPECT_EQ(b.value(0).digest, value.digest);
+    EXPECT_EQ(a.value(1).ticks, 0u);
+    EXPECT_EQ(a.value(1).digest, sim_core::Xxh64::hash(nullptr, 0));
+
+    auto checkpoints = a.checkpoints(0);
+    ASSERT_EQ(checkpoints.size(), 5u);  // newest 5 of 10
+    EXPECT_EQ(checkpoints.front().ticks, 600u);
+    EXPECT_EQ(checkpoints.front().seq, 599u);
+    EXPECT_EQ(checkpoints.front().digest, sim_core::Xxh64::hash(bytes.data(), 600 * sim_core::PriceRecord::kEncodedSize));
+    EXPECT_EQ(checkpoints.back().digest, value.digest);
+
+    auto other = make_tick(1000);
+    other.stale = true;
+    b.record(other, 0);
+    a.record(make_tick(1000), 0);
+    EXPECT_NE(a.value(0).digest, b.value(0).digest);
+
+    // A restored digest continues where the saved one left off
+    sim_core::StreamDigest resumed({"ETH/USD", "BTC/USD"}, 100, 5);
+    resumed.restore(a.save());
+    a.record(make_tick(1001), 0);
+    resumed.record(make_tick(1001), 0);
+    EXPECT_EQ(resumed.value(0).digest, a.value(0).digest);
+    EXPECT_EQ(resumed.value(0).ticks, 1002u);
+    EXPECT_THROW(a.record(make_tick(0), 2), std::runtime_error);
+}
+
+TEST(DigestTest, ReadersSeeConsistentState) {
+    constexpr uint64_t kTicks = 200000;
+    std::vector<uint64_t> expected;
+    sim_core::RecordDigest running;
+    expected.push_back(running.value());
+    for (uint64_t i = 0; i < kTicks; ++i) {
+        running.add(sim_core::digest_record(make_tick(i), 0));
+        expected.push_back(running.value());
+    }
+
+    sim_core::StreamDigest digest({"ETH/USD"}, 0);
+    std::atomic<bool> done{false};
+    uint64_t mismatches = 0;
+    std::thread reader([&] {
+        while (!done) {
+            auto value = digest.value(0);
+            if (value.digest != expected[value.ticks]) mismatches++;
+        }
+    });
+    for (uint64_t i = 0; i < kTicks; ++i) digest.record(make_tick(i), 0);
+    done = true;
+    reader.join();
+
+    EXPECT_EQ(mismatches, 0u);
+    EXPECT_EQ(digest.value(0).digest, expected.back());
+    EXPECT_TRUE(digest.checkpoints(0).empty());
+}
+
 // Test: Metrics
 TEST(MetricsTest, Counters) {
     auto& metrics = sim_core::get_metrics();
@@ -246,6 +2263,19 @@ TEST(UtilsTest, ParseBindAddressInvalid) {
     EXPECT_THROW(sim_core::parse_bind_address("127.0.0.1"), std::runtime_error);
 }
 
+TEST(UtilsTest, QueryParam) {
+    EXPECT_EQ(sim_core::query_param("/ws/ticks?tier=critical", "tier"), "critical");
+    EXPECT_EQ(sim_core::query_param("/ws/ticks?a=1&tier=dashboard", "tier"), "dashboard");
+    EXPECT_EQ(sim_core::query_param("/ws/ticks", "tier"), std::nullopt);
+
+    // Values and keys are percent-decoded
+    EXPECT_EQ(sim_core::query_param("/history/ticks?pair=ETH%2FUSD", "pair"), "ETH/USD");
+    EXPECT_EQ(sim_core::query_param("/x?note=a+b%20c%2b", "note"), "a b c+");
+    EXPECT_EQ(sim_core::query_param("/x?%74ier=normal", "tier"), "normal");
+    EXPECT_THROW(sim_core::query_param("/x?pair=ETH%2", "pair"), std::invalid_argument);
+    EXPECT_THROW(sim_core::query_param("/x?pair=ETH%zzUSD", "pair"), std::invalid_argument);
+}
+
 // Test: Config loading
 TEST(ConfigTest, LoadDexConfig) {
     // This test requires configs/dex.yaml to exist
@@ -274,6 +2304,7 @@ TEST(ConfigTest, LoadOracleConfig) {
         EXPECT_GE(config.oracle_tick_ms.max, config.oracle_tick_ms.min);
         EXPECT_GT(config.oracle_deviation_bps, 0);
         EXPECT_GT(config.oracle_heartbeat_ms, 0);
+        EXPECT_GE(config.feeds.size(), config.server.pairs.size());
     } catch (const std::exception& e) {
         GTEST_SKIP() << "Config file not found: " << e.what();
     }